@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "campus-address-plan.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+const uint32_t CampusAddressPlan::NO_NODE;
+
+CampusAddressPlan::CampusAddressPlan ()
+  : m_network (0)
+  , m_mask (0xffffff00)
+  , m_nextHost (1)
+{
+}
+
+uint32_t
+CampusAddressPlan::MakeSubnet (uint32_t a, uint32_t b, uint32_t c)
+{
+  NS_ASSERT (a < 256 && b < 256 && c < 256);
+  return (a << 24) | (b << 16) | (c << 8);
+}
+
+void
+CampusAddressPlan::Reset (uint32_t nNodes)
+{
+  m_network = 0;
+  m_mask = 0xffffff00;
+  m_nextHost = 1;
+
+  m_node.clear ();
+  m_address.clear ();
+  m_linkMask.clear ();
+  m_interface.clear ();
+  m_lookup.clear ();
+  // Interface 0 is the loopback
+  m_nextIf.assign (nNodes, 1);
+  m_nodeAddress.assign (nNodes, 0);
+}
+
+void
+CampusAddressPlan::SetBase (uint32_t network, uint32_t mask)
+{
+  m_network = network & mask;
+  m_mask = mask;
+  m_nextHost = 1;
+}
+
+uint32_t
+CampusAddressPlan::AddLink (uint32_t from, uint32_t to)
+{
+  // Same limit as Ipv4AddressHelper: all-ones host part is the broadcast.
+  // With a /32 mask the limit wraps and host numbers are or-ed into the
+  // network, as the original Net3 LANs have always done.
+  const uint32_t maxHost = ~m_mask - 1;
+  NS_ABORT_MSG_IF (m_nextHost + 1 > maxHost,
+                   "Subnet " << Ipv4Address (m_network) << " is out of addresses");
+
+  uint32_t fromAddress = m_network | m_nextHost;
+  uint32_t toAddress = m_network | (m_nextHost + 1);
+  m_nextHost += 2;
+  return AddLink (from, to, fromAddress, toAddress, m_mask);
+}
+
+uint32_t
+CampusAddressPlan::AddLink (uint32_t from, uint32_t to, uint32_t fromAddress, uint32_t toAddress, uint32_t mask)
+{
+  NS_ASSERT (from < m_nextIf.size () && to < m_nextIf.size ());
+
+  if (m_nextIf[from] == 1)
+    {
+      m_nodeAddress[from] = fromAddress;
+    }
+  if (m_nextIf[to] == 1)
+    {
+      m_nodeAddress[to] = toAddress;
+    }
+
+  m_node.push_back (from);
+  m_node.push_back (to);
+  m_address.push_back (fromAddress);
+  m_address.push_back (toAddress);
+  m_linkMask.push_back (mask);
+  m_interface.push_back (m_nextIf[from]++);
+  m_interface.push_back (m_nextIf[to]++);
+  return m_linkMask.size () - 1;
+}
+
+void
+CampusAddressPlan::Finalize ()
+{
+  m_lookup.resize (m_address.size ());
+  for (uint32_t i = 0; i < m_address.size (); ++i)
+    {
+      m_lookup[i] = std::make_pair (m_address[i], m_node[i]);
+    }
+  std::sort (m_lookup.begin (), m_lookup.end ());
+}
+
+uint32_t
+CampusAddressPlan::GetNNodes () const
+{
+  return m_nextIf.size ();
+}
+
+uint32_t
+CampusAddressPlan::GetNLinks () const
+{
+  return m_linkMask.size ();
+}
+
+Ipv4Address
+CampusAddressPlan::GetAddress (uint32_t link, uint32_t side) const
+{
+  NS_ASSERT (side < 2);
+  return Ipv4Address (m_address[2 * link + side]);
+}
+
+Ipv4Mask
+CampusAddressPlan::GetMask (uint32_t link) const
+{
+  return Ipv4Mask (m_linkMask[link]);
+}
+
+uint32_t
+CampusAddressPlan::GetInterface (uint32_t link, uint32_t side) const
+{
+  NS_ASSERT (side < 2);
+  return m_interface[2 * link + side];
+}
+
+uint32_t
+CampusAddressPlan::GetNInterfaces (uint32_t node) const
+{
+  return m_nextIf[node];
+}
+
+Ipv4Address
+CampusAddressPlan::GetNodeAddress (uint32_t node) const
+{
+  return Ipv4Address (m_nodeAddress[node]);
+}
+
+uint32_t
+CampusAddressPlan::FindNode (Ipv4Address address) const
+{
+  NS_ASSERT_MSG (m_lookup.size () == m_address.size (), "CampusAddressPlan::Finalize () has not been called");
+  std::vector<std::pair<uint32_t, uint32_t> >::const_iterator i =
+    std::lower_bound (m_lookup.begin (), m_lookup.end (), std::make_pair (address.Get (), 0u));
+  if (i == m_lookup.end () || i->first != address.Get ())
+    {
+      return NO_NODE;
+    }
+  return i->second;
+}
+
+} // namespace ns3
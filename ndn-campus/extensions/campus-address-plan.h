@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CAMPUS_ADDRESS_PLAN_H
+#define CAMPUS_ADDRESS_PLAN_H
+
+#include <utility>
+#include <vector>
+
+#include <ns3-dev/ns3/core-module.h>
+#include <ns3-dev/ns3/ipv4-address.h>
+
+namespace ns3 {
+
+/**
+ * @brief IPv4 address plan of a ring of NMS campuses
+ *
+ * Addresses are plain integers computed as links are declared: every
+ * subnet is set with SetBase () and the links that follow draw consecutive
+ * host numbers from it, exactly like Ipv4AddressHelper would.  Interface
+ * indexes are counted per node at the same time, so the plan is complete
+ * before any IPv4 object is touched and can be installed in one pass.
+ *
+ * Runs that do not install IPv4 can still use the addresses as unique
+ * node and interface identifiers.  After Finalize () the plan also answers
+ * address-to-node lookups, for tracers and client/server placement.
+ */
+class CampusAddressPlan
+{
+public:
+  /// @brief Returned by FindNode () for unknown addresses
+  static const uint32_t NO_NODE = 0xffffffff;
+
+  CampusAddressPlan ();
+
+  /// @brief Network a.b.c.0 as an integer
+  static uint32_t
+  MakeSubnet (uint32_t a, uint32_t b, uint32_t c);
+
+  /// @brief Drop every link and prepare for @p nNodes nodes
+  void
+  Reset (uint32_t nNodes);
+
+  /// @brief Start a new subnet, the following links get its addresses from host 1 on
+  void
+  SetBase (uint32_t network, uint32_t mask = 0xffffff00);
+
+  /// @brief Give the next two addresses of the current subnet to a link, returns the link number
+  uint32_t
+  AddLink (uint32_t from, uint32_t to);
+
+  /// @brief Record a link with explicit addresses (snapshots), returns the link number
+  uint32_t
+  AddLink (uint32_t from, uint32_t to, uint32_t fromAddress, uint32_t toAddress, uint32_t mask);
+
+  /// @brief Sort the lookup table, must be called after the last AddLink ()
+  void
+  Finalize ();
+
+  uint32_t
+  GetNNodes () const;
+
+  uint32_t
+  GetNLinks () const;
+
+  /// @brief Address of side @p side (0 = from, 1 = to) of @p link
+  Ipv4Address
+  GetAddress (uint32_t link, uint32_t side) const;
+
+  Ipv4Mask
+  GetMask (uint32_t link) const;
+
+  /// @brief IPv4 interface index of side @p side of @p link on its node
+  uint32_t
+  GetInterface (uint32_t link, uint32_t side) const;
+
+  /// @brief Number of interfaces of @p node, loopback included
+  uint32_t
+  GetNInterfaces (uint32_t node) const;
+
+  /// @brief Address of the first interface of @p node, unique per node
+  Ipv4Address
+  GetNodeAddress (uint32_t node) const;
+
+  /// @brief Node that owns @p address or NO_NODE
+  uint32_t
+  FindNode (Ipv4Address address) const;
+
+private:
+  uint32_t m_network;
+  uint32_t m_mask;
+  uint32_t m_nextHost;
+
+  std::vector<uint32_t> m_node;      ///< two per link, from then to
+  std::vector<uint32_t> m_address;   ///< two per link, from then to
+  std::vector<uint32_t> m_linkMask;  ///< one per link
+  std::vector<uint32_t> m_interface; ///< two per link, from then to
+  std::vector<uint32_t> m_nextIf;    ///< one per node
+  std::vector<uint32_t> m_nodeAddress;
+  std::vector<std::pair<uint32_t, uint32_t> > m_lookup; ///< (address, node), sorted
+};
+
+} // namespace ns3
+
+#endif // CAMPUS_ADDRESS_PLAN_H
@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "campus-consumer-cbr.h"
+
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE ("CampusConsumerCbr");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (CampusConsumerCbr);
+
+TypeId
+CampusConsumerCbr::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::CampusConsumerCbr")
+    .SetParent<ndn::ConsumerCbr> ()
+    .AddConstructor<CampusConsumerCbr> ()
+    ;
+  return tid;
+}
+
+CampusConsumerCbr::CampusConsumerCbr ()
+  : m_gapRandom (CreateObject<UniformRandomVariable> ())
+{
+}
+
+int64_t
+CampusConsumerCbr::AssignStreams (int64_t stream)
+{
+  m_gapRandom->SetStream (stream);
+  return 1;
+}
+
+double
+CampusConsumerCbr::NextGap ()
+{
+  double mean = 1.0 / m_frequency;
+  if (m_randomType == "uniform")
+    {
+      return m_gapRandom->GetValue (0, 2 * mean);
+    }
+  if (m_randomType == "exponential")
+    {
+      // As ExponentialVariable (mean, 50 * mean): draws above the bound are
+      // drawn again
+      double gap;
+      do
+        {
+          gap = -mean * std::log (1 - m_gapRandom->GetValue ());
+        }
+      while (gap > 50 * mean);
+      return gap;
+    }
+  return mean;
+}
+
+void
+CampusConsumerCbr::ScheduleNextPacket ()
+{
+  // As ndn::ConsumerCbr::ScheduleNextPacket (), with the gap of NextGap ()
+  if (m_firstTime)
+    {
+      m_sendEvent = Simulator::Schedule (Seconds (0.0), &ndn::Consumer::SendPacket, this);
+      m_firstTime = false;
+    }
+  else if (!m_sendEvent.IsRunning ())
+    {
+      m_sendEvent = Simulator::Schedule (Seconds (NextGap ()), &ndn::Consumer::SendPacket, this);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,67 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CAMPUS_CONSUMER_CBR_H
+#define CAMPUS_CONSUMER_CBR_H
+
+#include <ns3-dev/ns3/core-module.h>
+#include <ns3-dev/ns3/ndnSIM-module.h>
+#include <ns3-dev/ns3/ndnSIM/apps/ndn-consumer-cbr.h>
+
+namespace ns3 {
+
+/**
+ * @brief ndn::ConsumerCbr drawing its Interest gaps from its own stream
+ *
+ * ndn::ConsumerCbr draws the gaps between Interests ("Randomize") from a
+ * random variable of the old API, which takes the next free stream at its
+ * first draw: the stream of a consumer depends on the order in which all
+ * the old-API variables first draw, so on the other applications and on
+ * the order the simulator runs them.  This consumer draws the same gaps,
+ * uniform over [0, 2 / Frequency) or exponential of mean 1 / Frequency
+ * bounded at 50 / Frequency, from a variable of the new API on the stream
+ * set by AssignStreams () or an automatic one.
+ *
+ * The nonces of the Interests still come from ndn::Consumer.
+ */
+class CampusConsumerCbr : public ndn::ConsumerCbr
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  CampusConsumerCbr ();
+
+  /// @brief Use streams from @p stream on, returns the number of streams used
+  virtual int64_t
+  AssignStreams (int64_t stream);
+
+protected:
+  /// @brief Schedule the next Interest after a gap of the own stream
+  virtual void
+  ScheduleNextPacket ();
+
+private:
+  /// @brief Gap before the next Interest, in seconds
+  double
+  NextGap ();
+
+  Ptr<UniformRandomVariable> m_gapRandom;
+};
+
+} // namespace ns3
+
+#endif // CAMPUS_CONSUMER_CBR_H
@@ -0,0 +1,795 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "campus-parallel-simulator-impl.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <queue>
+#include <thread>
+
+#include <ns3-dev/ns3/map-scheduler.h>
+#include <ns3-dev/ns3/network-module.h>
+
+NS_LOG_COMPONENT_DEFINE ("CampusParallelSimulatorImpl");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (CampusParallelSimulatorImpl);
+
+static const uint32_t NO_CONTEXT = 0xffffffff;
+static const uint64_t NO_EVENT = std::numeric_limits<uint64_t>::max ();
+
+/// @brief Event queue and clock of one partition
+struct CampusParallelSimulatorImpl::Partition
+{
+  /// @brief Event run in the current window, and its first Schedule () call
+  struct Executed
+  {
+    uint64_t ts;
+    uint32_t uid;
+    uint32_t firstCall;
+  };
+
+  Ptr<Scheduler> events;
+  uint32_t index;
+  uint64_t currentTs;
+  uint32_t currentUid;
+  uint32_t currentContext;
+  bool stop;
+  std::vector<Ptr<EventImpl> > runNow; ///< events already run at currentTs
+  std::vector<Executed> executed;      ///< events run in the window
+  uint32_t nCalls;                     ///< Schedule () calls of the window
+  std::vector<uint32_t> uids;          ///< final uid of every call of the last window
+  uint64_t nextMail;                   ///< earliest event mailed to a partition in the window
+
+  uint64_t
+  NextTs () const
+  {
+    return events->IsEmpty () ? NO_EVENT : events->PeekNext ().key.m_ts;
+  }
+};
+
+/// @brief Events from one partition to another, for the next window
+struct CampusParallelSimulatorImpl::Mailbox
+{
+  struct Mail
+  {
+    uint64_t ts;
+    uint32_t context;
+    uint32_t call; ///< rank of the call among those of the sender in the window
+    EventImpl *impl;
+  };
+
+  std::vector<Mail> mail;
+};
+
+/// @brief Threads 1 to n - 1 and the barrier that frames every window
+struct CampusParallelSimulatorImpl::Workers
+{
+  explicit Workers (uint32_t n)
+    : count (n)
+    , waiting (0)
+    , generation (0)
+    , quit (false)
+  {
+  }
+
+  void
+  Wait ()
+  {
+    const uint32_t current = generation.load (std::memory_order_acquire);
+    if (waiting.fetch_add (1, std::memory_order_acq_rel) + 1 == count)
+      {
+        waiting.store (0, std::memory_order_relaxed);
+        generation.store (current + 1, std::memory_order_release);
+        return;
+      }
+    // Windows are short, the serial part between them too
+    for (uint32_t spins = 0; generation.load (std::memory_order_acquire) == current; ++spins)
+      {
+        if (spins >= 1000)
+          {
+            std::this_thread::yield ();
+          }
+      }
+  }
+
+  const uint32_t count;
+  std::atomic<uint32_t> waiting;
+  std::atomic<uint32_t> generation;
+  bool quit; ///< written before a barrier, read after it
+  std::vector<std::thread> threads;
+};
+
+__thread CampusParallelSimulatorImpl::Partition *CampusParallelSimulatorImpl::s_current = 0;
+
+TypeId
+CampusParallelSimulatorImpl::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::CampusParallelSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .AddConstructor<CampusParallelSimulatorImpl> ()
+    .AddAttribute ("Threads", "Number of threads running the partitions of a window, "
+                   "more than 1 only with an ns-3 whose packets are thread-safe",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&CampusParallelSimulatorImpl::m_nThreads),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Lookahead", "Smallest delay of a link between nodes of two partitions",
+                   TimeValue (MilliSeconds (200)),
+                   MakeTimeAccessor (&CampusParallelSimulatorImpl::m_lookahead),
+                   MakeTimeChecker ())
+    ;
+  return tid;
+}
+
+CampusParallelSimulatorImpl::CampusParallelSimulatorImpl ()
+  : m_nThreads (1)
+  , m_lookahead (MilliSeconds (200))
+  , m_uid (4)
+  , m_parity (0)
+  , m_running (false)
+  , m_stop (false)
+  , m_windowEnd (0)
+  , m_windowEndUid (0)
+  , m_windowStart (4)
+  , m_nWindows (0)
+  , m_workers (0)
+{
+  m_schedulerFactory.SetTypeId (MapScheduler::GetTypeId ());
+  m_global = CreatePartition (0);
+}
+
+CampusParallelSimulatorImpl::~CampusParallelSimulatorImpl ()
+{
+}
+
+void
+CampusParallelSimulatorImpl::DoDispose (void)
+{
+  m_partitions.push_back (m_global);
+  for (std::vector<Partition *>::iterator p = m_partitions.begin (); p != m_partitions.end (); ++p)
+    {
+      while (!(*p)->events->IsEmpty ())
+        {
+          Scheduler::Event next = (*p)->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      delete *p;
+    }
+  for (uint32_t parity = 0; parity < 2; ++parity)
+    {
+      for (std::vector<Mailbox *>::iterator box = m_mail[parity].begin (); box != m_mail[parity].end (); ++box)
+        {
+          for (std::vector<Mailbox::Mail>::iterator i = (*box)->mail.begin (); i != (*box)->mail.end (); ++i)
+            {
+              i->impl->Unref ();
+            }
+          delete *box;
+        }
+      m_mail[parity].clear ();
+    }
+  m_partitions.clear ();
+  m_partitionOf.clear ();
+  m_global = 0;
+  SimulatorImpl::DoDispose ();
+}
+
+void
+CampusParallelSimulatorImpl::Destroy ()
+{
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+CampusParallelSimulatorImpl::Partition *
+CampusParallelSimulatorImpl::CreatePartition (uint32_t index) const
+{
+  Partition *partition = new Partition;
+  partition->events = m_schedulerFactory.Create<Scheduler> ();
+  partition->index = index;
+  partition->currentTs = 0;
+  partition->currentUid = 0;
+  partition->currentContext = NO_CONTEXT;
+  partition->stop = false;
+  partition->nCalls = 0;
+  partition->nextMail = NO_EVENT;
+  return partition;
+}
+
+void
+CampusParallelSimulatorImpl::UpdatePartitions () const
+{
+  NS_ABORT_MSG_IF (m_running, "Nodes cannot be created while CampusParallelSimulatorImpl runs");
+  for (uint32_t i = m_partitionOf.size (); i < NodeList::GetNNodes (); ++i)
+    {
+      const uint32_t systemId = NodeList::GetNode (i)->GetSystemId ();
+      while (m_partitions.size () <= systemId)
+        {
+          m_partitions.push_back (CreatePartition (m_partitions.size ()));
+        }
+      m_partitionOf.push_back (systemId);
+    }
+}
+
+CampusParallelSimulatorImpl::Partition *
+CampusParallelSimulatorImpl::GetPartition (uint32_t context) const
+{
+  if (context == NO_CONTEXT)
+    {
+      return m_global;
+    }
+  if (context >= m_partitionOf.size ())
+    {
+      UpdatePartitions ();
+      NS_ABORT_MSG_IF (context >= m_partitionOf.size (), "Context " << context << " is not a node");
+    }
+  return m_partitions[m_partitionOf[context]];
+}
+
+CampusParallelSimulatorImpl::Partition *
+CampusParallelSimulatorImpl::GetCurrent () const
+{
+  return s_current != 0 ? s_current : m_global;
+}
+
+CampusParallelSimulatorImpl::Mailbox &
+CampusParallelSimulatorImpl::GetMailbox (uint32_t parity, uint32_t from, uint32_t to)
+{
+  return *m_mail[parity][from * (m_partitions.size () + 1) + to];
+}
+
+EventId
+CampusParallelSimulatorImpl::Insert (Partition *partition, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  // Calls of a window follow the uids of the calls before it, in the
+  // order of their partition until Merge () sorts them out
+  ev.key.m_uid = s_current == 0 ? m_uid++ : m_windowStart + s_current->nCalls++;
+  partition->events->Insert (ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+EventId
+CampusParallelSimulatorImpl::Post (uint32_t to, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  Partition *current = s_current;
+  Mailbox::Mail mail = { ts, context, current->nCalls++, event };
+  GetMailbox (m_parity, current->index, to).mail.push_back (mail);
+  if (to < m_partitions.size ())
+    {
+      current->nextMail = std::min (current->nextMail, ts);
+    }
+  // The event is queued with its final uid, which only Remove () would need
+  return EventId (event, ts, context, m_windowStart + mail.call);
+}
+
+void
+CampusParallelSimulatorImpl::Collect (Partition *partition, uint32_t to, uint32_t parity)
+{
+  for (uint32_t from = 0; from < m_partitions.size (); ++from)
+    {
+      std::vector<Mailbox::Mail> &mail = GetMailbox (parity, from, to).mail;
+      const std::vector<uint32_t> &uids = m_partitions[from]->uids;
+      for (std::vector<Mailbox::Mail>::const_iterator i = mail.begin (); i != mail.end (); ++i)
+        {
+          Scheduler::Event ev;
+          ev.impl = i->impl;
+          ev.key.m_ts = i->ts;
+          ev.key.m_context = i->context;
+          ev.key.m_uid = uids[i->call];
+          partition->events->Insert (ev);
+        }
+      mail.clear ();
+    }
+}
+
+bool
+CampusParallelSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  for (std::vector<Partition *>::const_iterator p = m_partitions.begin (); p != m_partitions.end (); ++p)
+    {
+      if (!(*p)->events->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return m_global->events->IsEmpty ();
+}
+
+void
+CampusParallelSimulatorImpl::Stop (void)
+{
+  // Other partitions finish the current window
+  GetCurrent ()->stop = true;
+}
+
+void
+CampusParallelSimulatorImpl::Stop (Time const &time)
+{
+  Simulator::Schedule (time, &Simulator::Stop);
+}
+
+EventId
+CampusParallelSimulatorImpl::Schedule (Time const &time, EventImpl *event)
+{
+  NS_ASSERT_MSG (time.GetTimeStep () >= 0, "Event scheduled in the past");
+  Partition *current = GetCurrent ();
+  const uint64_t ts = current->currentTs + time.GetTimeStep ();
+  if (s_current != 0 && ts >= m_windowEnd)
+    {
+      return Post (current->index, ts, current->currentContext, event);
+    }
+  return Insert (current, ts, current->currentContext, event);
+}
+
+void
+CampusParallelSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event)
+{
+  NS_ASSERT_MSG (time.GetTimeStep () >= 0, "Event scheduled in the past");
+  Partition *current = GetCurrent ();
+  const uint64_t ts = current->currentTs + time.GetTimeStep ();
+  Partition *target = GetPartition (context);
+
+  // Outside windows every partition is stopped and can take the event now
+  if (s_current == 0 || (target == current && ts < m_windowEnd))
+    {
+      Insert (target, ts, context, event);
+      return;
+    }
+
+  NS_ABORT_MSG_IF (ts < m_windowEnd, "Event for context " << context << " scheduled " << time
+                   << " ahead, less than the lookahead of " << m_lookahead);
+  Post (target == m_global ? m_partitions.size () : target->index, ts, context, event);
+}
+
+EventId
+CampusParallelSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return Schedule (TimeStep (0), event);
+}
+
+EventId
+CampusParallelSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_ASSERT_MSG (s_current == 0, "Destroy events must be scheduled outside of the partitions");
+  EventId id (Ptr<EventImpl> (event, false), m_global->currentTs, NO_CONTEXT, 2);
+  m_destroyEvents.push_back (id);
+  // Takes a uid in DefaultSimulatorImpl too
+  m_uid++;
+  return id;
+}
+
+void
+CampusParallelSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events
+      for (std::list<EventId>::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); ++i)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  // The uid of an EventId is not the queue key of the events held for a
+  // later window, so cancelled events leave the queue when they are due
+  Cancel (id);
+}
+
+void
+CampusParallelSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+CampusParallelSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0 || id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      for (std::list<EventId>::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); ++i)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+
+  if (id.PeekEventImpl () == 0 || id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  const Partition *partition = GetPartition (id.GetContext ());
+  if (id.GetTs () != partition->currentTs)
+    {
+      return id.GetTs () < partition->currentTs;
+    }
+  // Usually the event being run, the last one
+  for (std::vector<Ptr<EventImpl> >::const_reverse_iterator i = partition->runNow.rbegin ();
+       i != partition->runNow.rend (); ++i)
+    {
+      if (PeekPointer (*i) == id.PeekEventImpl ())
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+CampusParallelSimulatorImpl::RunPartition (Partition *partition)
+{
+  s_current = partition;
+  partition->executed.clear ();
+  partition->nCalls = 0;
+  partition->nextMail = NO_EVENT;
+  Collect (partition, partition->index, 1 - m_parity);
+
+  while (!partition->stop && !partition->events->IsEmpty ())
+    {
+      Scheduler::Event next = partition->events->PeekNext ();
+      if (next.key.m_ts > m_windowEnd || (next.key.m_ts == m_windowEnd && next.key.m_uid >= m_windowEndUid))
+        {
+          break;
+        }
+      partition->events->RemoveNext ();
+
+      NS_ASSERT (next.key.m_ts >= partition->currentTs);
+      if (next.key.m_ts != partition->currentTs)
+        {
+          partition->runNow.clear ();
+        }
+      partition->currentTs = next.key.m_ts;
+      partition->currentContext = next.key.m_context;
+      partition->currentUid = next.key.m_uid;
+      partition->runNow.push_back (next.impl);
+      Partition::Executed executed = { next.key.m_ts, next.key.m_uid, partition->nCalls };
+      partition->executed.push_back (executed);
+      next.impl->Invoke ();
+      next.impl->Unref ();
+    }
+  s_current = 0;
+}
+
+void
+CampusParallelSimulatorImpl::RunGlobal ()
+{
+  // With every partition stopped, as the main thread
+  Scheduler::Event next = m_global->events->RemoveNext ();
+  if (next.key.m_ts != m_global->currentTs)
+    {
+      m_global->runNow.clear ();
+    }
+  m_global->currentTs = next.key.m_ts;
+  m_global->currentContext = next.key.m_context;
+  m_global->currentUid = next.key.m_uid;
+  m_global->runNow.push_back (next.impl);
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+CampusParallelSimulatorImpl::RunWindow (uint32_t worker)
+{
+  const uint32_t stride = m_workers != 0 ? m_workers->count : 1;
+  for (uint32_t i = worker; i < m_partitions.size (); i += stride)
+    {
+      RunPartition (m_partitions[i]);
+    }
+}
+
+void
+CampusParallelSimulatorImpl::Merge ()
+{
+  // The sequential run would have run the events of the window in (time,
+  // uid) order and numbered their calls in that order.  Each partition ran
+  // its own events in that order, so a k-way merge on the final uids, known
+  // for an event before its turn comes, replays it.
+  struct Head
+  {
+    uint64_t ts;
+    uint32_t uid;
+    uint32_t partition;
+    uint32_t position;
+
+    bool
+    operator < (const Head &o) const
+    {
+      // Reversed for the max-heap of std::priority_queue
+      return ts != o.ts ? ts > o.ts : uid > o.uid;
+    }
+  };
+
+  std::priority_queue<Head> heads;
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      Partition *p = m_partitions[i];
+      p->uids.resize (p->nCalls);
+      if (!p->executed.empty ())
+        {
+          // Queued before the window, the uid is final
+          Head head = { p->executed[0].ts, p->executed[0].uid, i, 0 };
+          heads.push (head);
+        }
+    }
+
+  uint32_t uid = m_windowStart;
+  while (!heads.empty ())
+    {
+      Head head = heads.top ();
+      heads.pop ();
+      Partition *p = m_partitions[head.partition];
+      const uint32_t next = head.position + 1;
+      const uint32_t end = next < p->executed.size () ? p->executed[next].firstCall : p->nCalls;
+      for (uint32_t call = p->executed[head.position].firstCall; call < end; ++call)
+        {
+          p->uids[call] = uid++;
+        }
+      if (next < p->executed.size ())
+        {
+          const Partition::Executed &e = p->executed[next];
+          Head following = { e.ts, e.uid >= m_windowStart ? p->uids[e.uid - m_windowStart] : e.uid,
+                             head.partition, next };
+          heads.push (following);
+        }
+    }
+  m_uid = uid;
+}
+
+void
+CampusParallelSimulatorImpl::Worker (uint32_t worker)
+{
+  for (;;)
+    {
+      m_workers->Wait ();
+      if (m_workers->quit)
+        {
+          return;
+        }
+      RunWindow (worker);
+      m_workers->Wait ();
+    }
+}
+
+void
+CampusParallelSimulatorImpl::Run (void)
+{
+  NS_ABORT_MSG_IF (m_lookahead.GetTimeStep () <= 0, "CampusParallelSimulatorImpl needs a positive lookahead");
+  UpdatePartitions ();
+  m_running = true;
+  m_stop = false;
+  m_nWindows = 0;
+  for (std::vector<Partition *>::iterator p = m_partitions.begin (); p != m_partitions.end (); ++p)
+    {
+      (*p)->stop = false;
+    }
+  m_global->stop = false;
+
+  const uint32_t nBoxes = m_partitions.size () * (m_partitions.size () + 1);
+  for (uint32_t parity = 0; parity < 2; ++parity)
+    {
+      while (m_mail[parity].size () < nBoxes)
+        {
+          m_mail[parity].push_back (new Mailbox);
+        }
+    }
+
+#ifndef CAMPUS_THREAD_SAFE_NS3
+  // The free lists of Buffer, PacketMetadata and ByteTagList and the packet
+  // uid counter are unsynchronized statics in every ns-3 build
+  if (m_nThreads > 1)
+    {
+      NS_FATAL_ERROR ("ns3::CampusParallelSimulatorImpl::Threads=" << m_nThreads
+                      << ": ns-3 packets are not thread-safe, use one thread");
+    }
+#endif
+  uint32_t nThreads = std::min<uint32_t> (m_nThreads, m_partitions.size ());
+  if (nThreads > 1)
+    {
+      m_workers = new Workers (nThreads);
+      for (uint32_t w = 1; w < nThreads; ++w)
+        {
+          m_workers->threads.push_back (std::thread (&CampusParallelSimulatorImpl::Worker, this, w));
+        }
+    }
+
+  while (!m_stop)
+    {
+      // Earliest partition event, queued or mailed by the last window
+      uint64_t next = NO_EVENT;
+      uint32_t nextUid = 0;
+      for (std::vector<Partition *>::const_iterator p = m_partitions.begin (); p != m_partitions.end (); ++p)
+        {
+          if (!(*p)->events->IsEmpty ())
+            {
+              const EventKey &key = (*p)->events->PeekNext ().key;
+              if (key.m_ts < next || (key.m_ts == next && key.m_uid < nextUid))
+                {
+                  next = key.m_ts;
+                  nextUid = key.m_uid;
+                }
+            }
+          // Mail got its uids from the last window, all above those before it
+          if ((*p)->nextMail < next || ((*p)->nextMail == next && m_windowStart < nextUid))
+            {
+              next = (*p)->nextMail;
+              nextUid = m_windowStart;
+            }
+        }
+      const bool global = !m_global->events->IsEmpty ();
+      if (next == NO_EVENT && !global)
+        {
+          break;
+        }
+
+      if (global)
+        {
+          const EventKey &key = m_global->events->PeekNext ().key;
+          if (key.m_ts < next || (key.m_ts == next && key.m_uid < nextUid))
+            {
+              RunGlobal ();
+              m_stop = m_global->stop;
+              continue;
+            }
+        }
+
+      // The window ends with the lookahead or at the next global event
+      m_windowEnd = next + m_lookahead.GetTimeStep ();
+      m_windowEndUid = 0;
+      if (global && m_global->events->PeekNext ().key.m_ts < m_windowEnd)
+        {
+          m_windowEnd = m_global->events->PeekNext ().key.m_ts;
+          m_windowEndUid = m_global->events->PeekNext ().key.m_uid;
+        }
+      m_windowStart = m_uid;
+      ++m_nWindows;
+      if (m_workers != 0)
+        {
+          m_workers->Wait ();
+          RunWindow (0);
+          m_workers->Wait ();
+        }
+      else
+        {
+          RunWindow (0);
+        }
+      Merge ();
+      Collect (m_global, m_partitions.size (), m_parity);
+      m_parity = 1 - m_parity;
+      for (std::vector<Partition *>::const_iterator p = m_partitions.begin (); p != m_partitions.end (); ++p)
+        {
+          m_stop = m_stop || (*p)->stop;
+        }
+    }
+
+  if (m_workers != 0)
+    {
+      m_workers->quit = true;
+      m_workers->Wait ();
+      for (std::vector<std::thread>::iterator t = m_workers->threads.begin (); t != m_workers->threads.end (); ++t)
+        {
+          t->join ();
+        }
+      delete m_workers;
+      m_workers = 0;
+    }
+
+  // Mail of the last window, for a later Run ()
+  for (std::vector<Partition *>::iterator p = m_partitions.begin (); p != m_partitions.end (); ++p)
+    {
+      Collect (*p, (*p)->index, 1 - m_parity);
+      (*p)->nextMail = NO_EVENT;
+    }
+
+  // Simulator::Now () from the main thread is the time of the last event
+  for (std::vector<Partition *>::const_iterator p = m_partitions.begin (); p != m_partitions.end (); ++p)
+    {
+      m_global->currentTs = std::max (m_global->currentTs, (*p)->currentTs);
+    }
+  m_running = false;
+  NS_LOG_INFO (m_partitions.size () << " partitions, " << nThreads << " threads, " << m_nWindows << " windows");
+}
+
+Time
+CampusParallelSimulatorImpl::Now (void) const
+{
+  return TimeStep (GetCurrent ()->currentTs);
+}
+
+Time
+CampusParallelSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  return TimeStep (id.GetTs () - GetCurrent ()->currentTs);
+}
+
+Time
+CampusParallelSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+void
+CampusParallelSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  m_schedulerFactory = schedulerFactory;
+
+  // Move the events already scheduled to the new queues
+  m_partitions.push_back (m_global);
+  for (std::vector<Partition *>::iterator p = m_partitions.begin (); p != m_partitions.end (); ++p)
+    {
+      Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+      while (!(*p)->events->IsEmpty ())
+        {
+          scheduler->Insert ((*p)->events->RemoveNext ());
+        }
+      (*p)->events = scheduler;
+    }
+  m_partitions.pop_back ();
+}
+
+uint32_t
+CampusParallelSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+uint32_t
+CampusParallelSimulatorImpl::GetContext (void) const
+{
+  return GetCurrent ()->currentContext;
+}
+
+uint64_t
+CampusParallelSimulatorImpl::GetNWindows () const
+{
+  return m_nWindows;
+}
+
+} // namespace ns3
@@ -0,0 +1,231 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CAMPUS_PARALLEL_SIMULATOR_IMPL_H
+#define CAMPUS_PARALLEL_SIMULATOR_IMPL_H
+
+#include <list>
+#include <vector>
+
+#include <ns3-dev/ns3/core-module.h>
+#include <ns3-dev/ns3/scheduler.h>
+#include <ns3-dev/ns3/simulator-impl.h>
+
+namespace ns3 {
+
+/**
+ * @brief Conservative parallel simulator with one logical process per campus
+ *
+ * Every node belongs to the partition given by its system id (see
+ * CampusTopologyBuilder::SetSystemCount ()) and every partition has its own
+ * event queue.  Time advances in windows no longer than the "Lookahead"
+ * attribute, the smallest delay of a link between partitions (200ms on the
+ * NMS backbone): within a window no partition can affect another one, so
+ * the partitions of a window run independently, on "Threads" threads.
+ *
+ * Events run in the order of ns3::DefaultSimulatorImpl, by time and then by
+ * the rank of the Schedule () call that created them.  Inside a window each
+ * partition numbers its calls from the first free rank; at the end of the
+ * window a merge of the events run by all partitions, in that order, gives
+ * every call its rank in the sequential run.  The events of the window only
+ * compare with events of their own partition, with provisional numbers that
+ * keep the same order; the events for later windows are held until the
+ * merge and take their final number.  Events without a node context (tracer
+ * printers, Simulator::Stop ()) run alone, between windows, at their place
+ * in that order.  By design, results do not depend on the number of
+ * threads and match the sequential simulator, except for packet uids and
+ * for Simulator::Stop () called by a node, which ends the run at the end of
+ * its window.  Remove () only cancels the event.  This equivalence was only
+ * checked against a sequential reference with stand-ins for the ns-3
+ * classes, never with ns-3 and ndnSIM themselves: ParallelBenchmark in
+ * run.py compares the traces of both runs and is the check to make.
+ *
+ * Events for another partition go to a mailbox per sender and receiver,
+ * written by the sender in one window and read by the receiver in the
+ * next, so the threads only meet at the barrier that ends every window.
+ * Packets must not cross partitions: links between them use
+ * CampusPointToPointChannel, which hands a serialized copy of each packet
+ * to the receiving node, as over MPI.
+ *
+ * Several threads are not safe with ns-3 as it is: the free lists of
+ * Buffer, PacketMetadata and ByteTagList and Packet::m_globalUid are
+ * static and unsynchronized, and every partition creates packets.
+ * "Threads" is 1, and Run () rejects more unless the extensions are built
+ * with CAMPUS_THREAD_SAFE_NS3 against an ns-3 that synchronizes them.
+ *
+ * @code
+ *   ./build/disaster-ccn-scenario1v1 --networks=8 --partitions=8 \
+ *     --SimulatorImplementationType=ns3::CampusParallelSimulatorImpl
+ * @endcode
+ */
+class CampusParallelSimulatorImpl : public SimulatorImpl
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  CampusParallelSimulatorImpl ();
+  virtual ~CampusParallelSimulatorImpl ();
+
+  virtual void
+  Destroy ();
+
+  virtual bool
+  IsFinished (void) const;
+
+  virtual void
+  Stop (void);
+
+  virtual void
+  Stop (Time const &time);
+
+  virtual EventId
+  Schedule (Time const &time, EventImpl *event);
+
+  virtual void
+  ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event);
+
+  virtual EventId
+  ScheduleNow (EventImpl *event);
+
+  virtual EventId
+  ScheduleDestroy (EventImpl *event);
+
+  virtual void
+  Remove (const EventId &id);
+
+  virtual void
+  Cancel (const EventId &id);
+
+  virtual bool
+  IsExpired (const EventId &id) const;
+
+  virtual void
+  Run (void);
+
+  virtual Time
+  Now (void) const;
+
+  virtual Time
+  GetDelayLeft (const EventId &id) const;
+
+  virtual Time
+  GetMaximumSimulationTime (void) const;
+
+  virtual void
+  SetScheduler (ObjectFactory schedulerFactory);
+
+  virtual uint32_t
+  GetSystemId (void) const;
+
+  virtual uint32_t
+  GetContext (void) const;
+
+  /// @brief Number of windows of the last Run ()
+  uint64_t
+  GetNWindows () const;
+
+private:
+  virtual void
+  DoDispose (void);
+
+  struct Partition;
+  struct Mailbox;
+  struct Workers;
+
+  Partition *
+  CreatePartition (uint32_t index) const;
+
+  /// @brief Partition that runs the events of @p context
+  Partition *
+  GetPartition (uint32_t context) const;
+
+  /// @brief Partition of the calling thread (the global one outside windows)
+  Partition *
+  GetCurrent () const;
+
+  /// @brief Bring the node to partition table up to date with NodeList
+  void
+  UpdatePartitions () const;
+
+  /// @brief Schedule @p event in @p partition, the current one inside windows
+  EventId
+  Insert (Partition *partition, uint64_t ts, uint32_t context, EventImpl *event);
+
+  /// @brief Hold @p event of a later window for partition @p to
+  EventId
+  Post (uint32_t to, uint64_t ts, uint32_t context, EventImpl *event);
+
+  /// @brief Mailbox of the window of parity @p parity from partition @p from to @p to
+  ///
+  /// @p to is the number of partitions for the global one
+  Mailbox &
+  GetMailbox (uint32_t parity, uint32_t from, uint32_t to);
+
+  /// @brief Queue the mail of parity @p parity for @p partition, with its final uids
+  void
+  Collect (Partition *partition, uint32_t to, uint32_t parity);
+
+  /// @brief Run the events of the partitions of @p worker until the end of the window
+  void
+  RunWindow (uint32_t worker);
+
+  void
+  RunPartition (Partition *partition);
+
+  /// @brief Run the first global event
+  void
+  RunGlobal ();
+
+  /// @brief Give every call of the window its uid in the sequential order
+  void
+  Merge ();
+
+  /// @brief Worker thread body, for workers 1 to Threads - 1
+  void
+  Worker (uint32_t worker);
+
+  uint32_t m_nThreads;
+  Time m_lookahead;
+  ObjectFactory m_schedulerFactory;
+
+  mutable std::vector<Partition *> m_partitions;
+  mutable std::vector<uint32_t> m_partitionOf; ///< node id to partition
+  Partition *m_global;                          ///< events without node context
+
+  /// @brief Next uid, 0 to 3 are reserved as in DefaultSimulatorImpl
+  uint32_t m_uid;
+  /// @brief Mailboxes of both window parities, (partitions + 1) per partition
+  std::vector<Mailbox *> m_mail[2];
+  uint32_t m_parity;    ///< parity of the next window
+
+  bool m_running;
+  bool m_stop;
+  uint64_t m_windowEnd; ///< events of the window come before (m_windowEnd, m_windowEndUid)
+  uint32_t m_windowEndUid;
+  uint32_t m_windowStart; ///< first uid of the calls of the window
+  uint64_t m_nWindows;
+  Workers *m_workers;
+
+  std::list<EventId> m_destroyEvents;
+
+  /// @brief Partition run by the current thread, 0 outside windows
+  static __thread Partition *s_current;
+};
+
+} // namespace ns3
+
+#endif // CAMPUS_PARALLEL_SIMULATOR_IMPL_H
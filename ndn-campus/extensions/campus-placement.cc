@@ -0,0 +1,254 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "campus-placement.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <boost/unordered_map.hpp>
+
+NS_LOG_COMPONENT_DEFINE ("CampusPlacement");
+
+namespace ns3 {
+
+static bool
+LargerRemainder (const std::pair<uint64_t, uint32_t> &a, const std::pair<uint64_t, uint32_t> &b)
+{
+  return a.first > b.first;
+}
+
+void
+CampusPlacement::Stratum::Add (uint32_t start, uint32_t count)
+{
+  if (count == 0)
+    {
+      return;
+    }
+  Range range;
+  range.start = start;
+  range.count = count;
+  ranges.push_back (range);
+  ends.push_back (GetN () + count);
+}
+
+uint32_t
+CampusPlacement::Stratum::GetN () const
+{
+  return ends.empty () ? 0 : ends.back ();
+}
+
+uint32_t
+CampusPlacement::Stratum::GetNode (uint32_t position) const
+{
+  NS_ASSERT (position < GetN ());
+  uint32_t i = std::upper_bound (ends.begin (), ends.end (), position) - ends.begin ();
+  return ranges[i].start + position - (i > 0 ? ends[i - 1] : 0);
+}
+
+CampusPlacement::CampusPlacement (const CampusTopologyIndex &index)
+  : m_index (index)
+  , m_strata (STRATA_NONE)
+{
+}
+
+bool
+CampusPlacement::LookupStrata (const std::string &name, Strata *strata)
+{
+  static const char *names[] = { "none", "campus", "lan" };
+  for (size_t i = 0; i < sizeof (names) / sizeof (names[0]); i++)
+    {
+      if (name == names[i])
+        {
+          *strata = static_cast<Strata> (i);
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+CampusPlacement::ReadNodeIds (const std::string &file, std::vector<uint32_t> *ids)
+{
+  std::ifstream is (file.c_str ());
+  if (!is)
+    {
+      return false;
+    }
+  ids->clear ();
+  std::string line;
+  while (std::getline (is, line))
+    {
+      std::istringstream fields (line);
+      uint32_t id;
+      std::string rest;
+      if (line.find_first_not_of (" \t\r") == std::string::npos)
+        {
+          continue;
+        }
+      if (!(fields >> id) || (fields >> rest))
+        {
+          NS_LOG_ERROR (file << ": not a node ID: " << line);
+          return false;
+        }
+      ids->push_back (id);
+    }
+  return true;
+}
+
+void
+CampusPlacement::SetStrata (Strata strata)
+{
+  m_strata = strata;
+}
+
+std::vector<CampusPlacement::Stratum>
+CampusPlacement::GetStrata (Role role) const
+{
+  static const CampusTopologyIndex::Tier lanTiers[] = { CampusTopologyIndex::NET2_LAN,
+                                                        CampusTopologyIndex::NET3_LAN };
+  std::vector<Stratum> strata (m_strata == STRATA_NONE ? 1 : 0);
+  for (uint32_t z = 0; z < m_index.GetNCampus (); z++)
+    {
+      if (m_strata == STRATA_CAMPUS || (m_strata == STRATA_LAN && role == NET1_ROUTER))
+        {
+          strata.push_back (Stratum ());
+        }
+      if (role == NET1_ROUTER)
+        {
+          strata.back ().Add (m_index.GetTierStart (z, CampusTopologyIndex::NET1),
+                              m_index.GetTierSize (z, CampusTopologyIndex::NET1));
+          continue;
+        }
+      for (uint32_t t = 0; t < sizeof (lanTiers) / sizeof (lanTiers[0]); t++)
+        {
+          uint32_t start = m_index.GetTierStart (z, lanTiers[t]);
+          uint32_t size = m_index.GetTierSize (z, lanTiers[t]);
+          if (m_strata != STRATA_LAN)
+            {
+              strata.back ().Add (start, size);
+              continue;
+            }
+          // The LANs of a tier follow each other, some may be empty
+          for (uint32_t lan = 0, offset = 0; offset < size; lan++)
+            {
+              uint32_t n = m_index.GetLanNodes (z, lanTiers[t], lan);
+              strata.push_back (Stratum ());
+              strata.back ().Add (start + offset, n);
+              offset += n;
+            }
+        }
+    }
+  return strata;
+}
+
+uint32_t
+CampusPlacement::GetNEligible (Role role) const
+{
+  std::vector<Stratum> strata = GetStrata (role);
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < strata.size (); i++)
+    {
+      n += strata[i].GetN ();
+    }
+  return n;
+}
+
+bool
+CampusPlacement::IsEligible (Role role, uint32_t index) const
+{
+  if (index >= m_index.GetNNodes ())
+    {
+      return false;
+    }
+  CampusTopologyIndex::Tier tier = m_index.GetTier (index);
+  if (role == NET1_ROUTER)
+    {
+      return tier == CampusTopologyIndex::NET1;
+    }
+  return tier == CampusTopologyIndex::NET2_LAN || tier == CampusTopologyIndex::NET3_LAN;
+}
+
+void
+CampusPlacement::SampleStratum (const Stratum &stratum, uint32_t k, Ptr<UniformRandomVariable> random,
+                                std::vector<uint32_t> &sample)
+{
+  // Fisher-Yates over the positions of the stratum: positions that were
+  // never swapped hold themselves, the others are in the map
+  boost::unordered_map<uint32_t, uint32_t> swapped;
+  swapped.rehash (2 * k);
+  uint32_t n = stratum.GetN ();
+  for (uint32_t i = 0; i < k; i++)
+    {
+      uint32_t j = random->GetInteger (i, n - 1);
+      boost::unordered_map<uint32_t, uint32_t>::iterator at = swapped.find (j);
+      uint32_t chosen = at == swapped.end () ? j : at->second;
+      boost::unordered_map<uint32_t, uint32_t>::iterator first = swapped.find (i);
+      swapped[j] = first == swapped.end () ? i : first->second;
+      sample.push_back (stratum.GetNode (chosen));
+    }
+}
+
+std::vector<uint32_t>
+CampusPlacement::Sample (Role role, uint32_t k, Ptr<UniformRandomVariable> random) const
+{
+  std::vector<Stratum> strata = GetStrata (role);
+  uint32_t n = 0;
+  for (uint32_t s = 0; s < strata.size (); s++)
+    {
+      n += strata[s].GetN ();
+    }
+  NS_ABORT_MSG_IF (k > n, "Cannot place " << k << " nodes on " << n << " eligible nodes");
+
+  std::vector<uint32_t> sample;
+  sample.reserve (k);
+  if (strata.size () == 1)
+    {
+      SampleStratum (strata[0], k, random, sample);
+      return sample;
+    }
+
+  // Proportional allocation, the nodes left over go to the strata with
+  // the largest remainders
+  std::vector<uint32_t> quota (strata.size ());
+  std::vector<std::pair<uint64_t, uint32_t> > remainders;
+  uint32_t allocated = 0;
+  for (uint32_t s = 0; s < strata.size (); s++)
+    {
+      uint64_t share = (uint64_t) k * strata[s].GetN ();
+      quota[s] = share / n;
+      allocated += quota[s];
+      remainders.push_back (std::make_pair (share % n, s));
+    }
+  std::stable_sort (remainders.begin (), remainders.end (), LargerRemainder);
+  for (uint32_t i = 0; allocated < k; i++, allocated++)
+    {
+      quota[remainders[i].second]++;
+    }
+
+  for (uint32_t s = 0; s < strata.size (); s++)
+    {
+      SampleStratum (strata[s], quota[s], random, sample);
+    }
+  // Callers give the first nodes of the sample other jobs than the last ones
+  for (uint32_t i = sample.size (); i > 1; i--)
+    {
+      std::swap (sample[i - 1], sample[random->GetInteger (0, i - 1)]);
+    }
+  return sample;
+}
+
+} // namespace ns3
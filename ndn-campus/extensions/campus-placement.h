@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CAMPUS_PLACEMENT_H
+#define CAMPUS_PLACEMENT_H
+
+#include <string>
+#include <vector>
+
+#include <ns3-dev/ns3/core-module.h>
+
+#include "campus-topology-index.h"
+
+namespace ns3 {
+
+/**
+ * @brief Draws the clients and servers of a scenario among eligible nodes
+ *
+ * Clients are drawn among the LAN hosts and servers among the Net1
+ * routers, never among the other routers.  The eligible nodes are read
+ * from the tier and LAN offset tables of a CampusTopologyIndex as ranges
+ * of dense indexes, so no node list is copied.  A sample of k nodes is
+ * drawn without replacement by a Fisher-Yates shuffle that only stores
+ * the positions it swapped: O(k) time and memory, plus a binary search
+ * over the ranges per node, whatever the size of the topology.
+ *
+ * With STRATA_CAMPUS or STRATA_LAN the sample is split among the campuses
+ * or the LANs in proportion to their number of eligible nodes (largest
+ * remainder), each stratum is sampled on its own, and the sample is
+ * shuffled so that its order does not follow the strata.
+ *
+ * ReadNodeIds () reads back a placement written by an earlier run.
+ *
+ * @code
+ *   CampusPlacement placement (topology.GetIndex ());
+ *   placement.SetStrata (CampusPlacement::STRATA_CAMPUS);
+ *   std::vector<uint32_t> clients =
+ *     placement.Sample (CampusPlacement::LAN_HOST, 300, rng.Get (ScenarioRandom::PLACEMENT));
+ *   Ptr<Node> first = topology.GetNode (clients[0]);
+ * @endcode
+ */
+class CampusPlacement
+{
+public:
+  /// @brief Nodes a role can be placed on
+  enum Role
+    {
+      LAN_HOST = 0,   ///< hosts of the Net2 and Net3 LANs
+      NET1_ROUTER     ///< Net1 routers, where the campus servers sit
+    };
+
+  /// @brief How a sample is spread over the topology
+  enum Strata
+    {
+      STRATA_NONE = 0,  ///< uniform over every eligible node
+      STRATA_CAMPUS,    ///< proportional to the eligible nodes of each campus
+      STRATA_LAN        ///< proportional to the hosts of each LAN, by campus for routers
+    };
+
+  CampusPlacement (const CampusTopologyIndex &index);
+
+  /**
+   * @brief Read back the node IDs a scenario wrote to @p file, one per line
+   *
+   * The *-clients-*.txt and *-servers-*.txt files of a run, so that
+   * another run, for instance of the other protocol, can reuse its
+   * placement.  Returns false if the file cannot be read or holds anything
+   * but node IDs.
+   */
+  static bool
+  ReadNodeIds (const std::string &file, std::vector<uint32_t> *ids);
+
+  /// @brief Look up the strata called @p name (none|campus|lan), return false if unknown
+  static bool
+  LookupStrata (const std::string &name, Strata *strata);
+
+  void
+  SetStrata (Strata strata);
+
+  /// @brief Number of nodes eligible for @p role
+  uint32_t
+  GetNEligible (Role role) const;
+
+  /// @brief Whether the node with dense index @p index is eligible for @p role
+  bool
+  IsEligible (Role role, uint32_t index) const;
+
+  /**
+   * @brief Draw @p k distinct nodes eligible for @p role
+   *
+   * Returns dense indexes of the index (see CampusTopologyBuilder::GetNode ()).
+   * Aborts if fewer than @p k nodes are eligible.
+   */
+  std::vector<uint32_t>
+  Sample (Role role, uint32_t k, Ptr<UniformRandomVariable> random) const;
+
+private:
+  /// @brief Consecutive dense indexes [start, start + count)
+  struct Range
+  {
+    uint32_t start;
+    uint32_t count;
+  };
+
+  /// @brief Eligible nodes of a stratum, as ranges and their running total
+  struct Stratum
+  {
+    std::vector<Range> ranges;
+    std::vector<uint32_t> ends;   ///< ends[i]: nodes in ranges [0, i]
+
+    void
+    Add (uint32_t start, uint32_t count);
+
+    uint32_t
+    GetN () const;
+
+    /// @brief Dense index of the @p position-th node of the stratum
+    uint32_t
+    GetNode (uint32_t position) const;
+  };
+
+  /// @brief Strata of the nodes eligible for @p role
+  std::vector<Stratum>
+  GetStrata (Role role) const;
+
+  /// @brief Append @p k nodes drawn without replacement from @p stratum to @p sample
+  static void
+  SampleStratum (const Stratum &stratum, uint32_t k, Ptr<UniformRandomVariable> random,
+                 std::vector<uint32_t> &sample);
+
+  const CampusTopologyIndex &m_index;
+  Strata m_strata;
+};
+
+} // namespace ns3
+
+#endif // CAMPUS_PLACEMENT_H
@@ -0,0 +1,128 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "campus-point-to-point-channel.h"
+
+#include <vector>
+
+NS_LOG_COMPONENT_DEFINE ("CampusPointToPointChannel");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (CampusPointToPointChannel);
+
+/// @brief Serialized packet and the packet tags to put back on it
+struct CampusPointToPointChannel::Image : public SimpleRefCount<Image>
+{
+  ~Image ()
+  {
+    for (std::vector<Tag *>::iterator i = tags.begin (); i != tags.end (); ++i)
+      {
+        delete *i;
+      }
+  }
+
+  std::vector<uint8_t> bytes;
+  std::vector<Tag *> tags;
+};
+
+TypeId
+CampusPointToPointChannel::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::CampusPointToPointChannel")
+    .SetParent<PointToPointChannel> ()
+    .AddConstructor<CampusPointToPointChannel> ()
+    ;
+  return tid;
+}
+
+CampusPointToPointChannel::CampusPointToPointChannel ()
+{
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      m_device[i] = 0;
+      m_node[i] = 0;
+    }
+}
+
+NetDeviceContainer
+CampusPointToPointChannel::Install (Ptr<Node> a, Ptr<Node> b, const DataRate &rate, const Time &delay)
+{
+  // Same order of creation as PointToPointHelper::Install (), for the same
+  // MAC addresses and channel ids
+  Ptr<Node> nodes[2] = { a, b };
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      Ptr<PointToPointNetDevice> device = CreateObject<PointToPointNetDevice> ();
+      device->SetAttribute ("DataRate", DataRateValue (rate));
+      device->SetAddress (Mac48Address::Allocate ());
+      nodes[i]->AddDevice (device);
+      device->SetQueue (CreateObject<DropTailQueue> ());
+      devices.Add (device);
+    }
+
+  Ptr<CampusPointToPointChannel> channel = CreateObject<CampusPointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (delay));
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      Ptr<PointToPointNetDevice> device = DynamicCast<PointToPointNetDevice> (devices.Get (i));
+      device->Attach (channel);
+      channel->m_device[i] = PeekPointer (device);
+      channel->m_node[i] = nodes[i]->GetId ();
+    }
+  return devices;
+}
+
+bool
+CampusPointToPointChannel::TransmitStart (Ptr<Packet> p, Ptr<PointToPointNetDevice> src, Time txTime)
+{
+  NS_LOG_FUNCTION (this << p << src);
+  NS_ASSERT_MSG (m_device[1] != 0, "CampusPointToPointChannel not set up by Install ()");
+
+  const uint32_t wire = PeekPointer (src) == m_device[0] ? 0 : 1;
+
+  Ptr<Image> image = Create<Image> ();
+  image->bytes.resize (p->GetSerializedSize ());
+  p->Serialize (&image->bytes[0], image->bytes.size ());
+  PacketTagIterator i = p->GetPacketTagIterator ();
+  while (i.HasNext ())
+    {
+      PacketTagIterator::Item item = i.Next ();
+      Callback<ObjectBase *> constructor = item.GetTypeId ().GetConstructor ();
+      Tag *tag = dynamic_cast<Tag *> (constructor ());
+      NS_ASSERT_MSG (tag != 0, "Packet tag " << item.GetTypeId ().GetName () << " cannot be created");
+      item.GetTag (*tag);
+      image->tags.push_back (tag);
+    }
+
+  Simulator::ScheduleWithContext (m_node[1 - wire], txTime + GetDelay (),
+                                  &CampusPointToPointChannel::Deliver, m_device[1 - wire], image);
+  return true;
+}
+
+void
+CampusPointToPointChannel::Deliver (PointToPointNetDevice *dst, Ptr<Image> image)
+{
+  Ptr<Packet> p = Create<Packet> (&image->bytes[0], image->bytes.size (), true);
+  for (std::vector<Tag *>::const_iterator i = image->tags.begin (); i != image->tags.end (); ++i)
+    {
+      p->AddPacketTag (**i);
+    }
+  dst->Receive (p);
+}
+
+} // namespace ns3
@@ -0,0 +1,69 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CAMPUS_POINT_TO_POINT_CHANNEL_H
+#define CAMPUS_POINT_TO_POINT_CHANNEL_H
+
+#include <ns3-dev/ns3/core-module.h>
+#include <ns3-dev/ns3/network-module.h>
+#include <ns3-dev/ns3/point-to-point-module.h>
+
+namespace ns3 {
+
+/**
+ * @brief Point-to-point channel between two partitions of CampusParallelSimulatorImpl
+ *
+ * The partitions run on different threads, which must not share a packet:
+ * ns-3 packets share their buffers and tags between copies, with reference
+ * counts that are not atomic.  TransmitStart () serializes the packet and
+ * its packet tags, as PointToPointRemoteChannel does over MPI, and the
+ * receiving node builds its own packet from them.  Byte tags are dropped,
+ * as over MPI, and the TxRxPointToPoint trace source is not fired, since
+ * its sink would get the devices of both partitions.
+ *
+ * The channel only keeps plain pointers to its devices and the ids of their
+ * nodes, so that the sending thread never changes the reference count of
+ * an object of the receiving partition.
+ */
+class CampusPointToPointChannel : public PointToPointChannel
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  CampusPointToPointChannel ();
+
+  /// @brief Link @p a and @p b as PointToPointHelper::Install () does, over a CampusPointToPointChannel
+  static NetDeviceContainer
+  Install (Ptr<Node> a, Ptr<Node> b, const DataRate &rate, const Time &delay);
+
+  virtual bool
+  TransmitStart (Ptr<Packet> p, Ptr<PointToPointNetDevice> src, Time txTime);
+
+private:
+  struct Image;
+
+  /// @brief Rebuild the packet of @p image and hand it to @p dst, in the receiving partition
+  static void
+  Deliver (PointToPointNetDevice *dst, Ptr<Image> image);
+
+  PointToPointNetDevice *m_device[2]; ///< wire 0 goes from device 0 to device 1
+  uint32_t m_node[2];                 ///< node ids of the devices
+};
+
+} // namespace ns3
+
+#endif // CAMPUS_POINT_TO_POINT_CHANNEL_H
@@ -0,0 +1,1242 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "campus-topology-builder.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include <boost/foreach.hpp>
+
+#include <ns3-dev/ns3/ipv4-list-routing-helper.h>
+#include <ns3-dev/ns3/ipv4-nix-vector-helper.h>
+#include <ns3-dev/ns3/ipv4-static-routing-helper.h>
+#include <ns3-dev/ns3/ndnSIM-module.h>
+
+#include "campus-point-to-point-channel.h"
+
+NS_LOG_COMPONENT_DEFINE ("CampusTopologyBuilder");
+
+namespace ns3 {
+
+const uint32_t CampusNetwork::NET0_ROUTERS;
+const uint32_t CampusNetwork::NET1_ROUTERS;
+const uint32_t CampusNetwork::NET2_ROUTERS;
+const uint32_t CampusNetwork::NET3_ROUTERS;
+const uint32_t CampusNetwork::LONE_ROUTERS;
+const uint32_t CampusNetwork::NET2_LANS;
+const uint32_t CampusNetwork::NET3_LANS;
+
+static inline double
+WallClock ()
+{
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  return (double)tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+CampusNetwork::CampusNetwork (const CampusTopologyBuilder *builder, uint32_t id)
+  : m_builder (builder)
+  , m_id (id)
+{
+}
+
+uint32_t
+CampusNetwork::GetId () const
+{
+  return m_id;
+}
+
+uint32_t
+CampusNetwork::GetLanSize () const
+{
+  return m_builder->GetIndex ().GetLanSize ();
+}
+
+NodeContainer
+CampusNetwork::GetNodes () const
+{
+  const CampusTopologyIndex &index = m_builder->GetIndex ();
+  const uint32_t first = index.GetCampusStart (m_id);
+
+  NodeContainer nodes;
+  for (uint32_t i = 0; i < index.GetCampusSize (m_id); ++i)
+    {
+      nodes.Add (m_builder->GetNode (first + i));
+    }
+  return nodes;
+}
+
+uint32_t
+CampusNetwork::GetNNodes (uint32_t lanSize)
+{
+  return NET0_ROUTERS + NET1_ROUTERS + NET2_ROUTERS + NET3_ROUTERS + LONE_ROUTERS
+    + (NET2_LANS + NET3_LANS) * lanSize;
+}
+
+uint32_t
+CampusNetwork::GetIndex (CampusTopologyIndex::Tier tier, uint32_t subnet, uint32_t host) const
+{
+  if (tier == CampusTopologyIndex::NET2_LAN || tier == CampusTopologyIndex::NET3_LAN)
+    {
+      return m_builder->GetLanHostIndex (m_id, tier, subnet, host);
+    }
+  return m_builder->GetIndex ().GetIndex (m_id, tier, subnet, host);
+}
+
+Ptr<Node>
+CampusNetwork::GetNode (CampusTopologyIndex::Tier tier, uint32_t subnet, uint32_t host) const
+{
+  return m_builder->GetNode (GetIndex (tier, subnet, host));
+}
+
+Ipv4InterfaceContainer
+CampusNetwork::GetInterfaces (CampusTopologyIndex::Tier tier, uint32_t subnet, uint32_t host) const
+{
+  return m_builder->GetInterfaces (m_builder->GetIndex ().GetPrimaryLink (GetIndex (tier, subnet, host)));
+}
+
+Ptr<Node>
+CampusNetwork::Net0 (uint32_t i) const
+{
+  return GetNode (CampusTopologyIndex::NET0, i);
+}
+
+Ptr<Node>
+CampusNetwork::Net1 (uint32_t i) const
+{
+  return GetNode (CampusTopologyIndex::NET1, i);
+}
+
+Ptr<Node>
+CampusNetwork::Net2 (uint32_t i) const
+{
+  return GetNode (CampusTopologyIndex::NET2, i);
+}
+
+Ptr<Node>
+CampusNetwork::Net3 (uint32_t i) const
+{
+  return GetNode (CampusTopologyIndex::NET3, i);
+}
+
+Ptr<Node>
+CampusNetwork::LoneRouter (uint32_t i) const
+{
+  return GetNode (CampusTopologyIndex::LONE_ROUTER, i);
+}
+
+Ptr<Node>
+CampusNetwork::Net2Lan (uint32_t lan, uint32_t host) const
+{
+  return GetNode (CampusTopologyIndex::NET2_LAN, lan, host);
+}
+
+Ptr<Node>
+CampusNetwork::Net3Lan (uint32_t lan, uint32_t host) const
+{
+  return GetNode (CampusTopologyIndex::NET3_LAN, lan, host);
+}
+
+Ipv4InterfaceContainer
+CampusNetwork::Net0Interfaces (uint32_t i) const
+{
+  return GetInterfaces (CampusTopologyIndex::NET0, i);
+}
+
+Ipv4InterfaceContainer
+CampusNetwork::Net1Interfaces (uint32_t i) const
+{
+  return GetInterfaces (CampusTopologyIndex::NET1, i);
+}
+
+Ipv4InterfaceContainer
+CampusNetwork::Net2Interfaces (uint32_t i) const
+{
+  return GetInterfaces (CampusTopologyIndex::NET2, i);
+}
+
+Ipv4InterfaceContainer
+CampusNetwork::Net3Interfaces (uint32_t i) const
+{
+  return GetInterfaces (CampusTopologyIndex::NET3, i);
+}
+
+Ipv4InterfaceContainer
+CampusNetwork::Net2LanInterfaces (uint32_t lan, uint32_t host) const
+{
+  return GetInterfaces (CampusTopologyIndex::NET2_LAN, lan, host);
+}
+
+Ipv4InterfaceContainer
+CampusNetwork::Net3LanInterfaces (uint32_t lan, uint32_t host) const
+{
+  return GetInterfaces (CampusTopologyIndex::NET3_LAN, lan, host);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+CampusTopologyBuilder::CampusTopologyBuilder ()
+  : m_lanSize (42)
+  , m_nix (true)
+  , m_internetStack (true)
+  , m_correctedUplinks (false)
+  , m_lanMode (LAN_FULL)
+  , m_backbone (BACKBONE_RING)
+  , m_systemCount (1)
+  , m_buildTime (0.0)
+  , m_campusDataRate ("1Gbps")
+  , m_campusDelay (MilliSeconds (5))
+  , m_lanDataRate ("100Mbps")
+  , m_lanDelay (MilliSeconds (1))
+  , m_ringDataRate ("2Gbps")
+  , m_ringDelay (MilliSeconds (200))
+  , m_snapshot (0)
+  , m_snapshotSize (0)
+{
+  m_p2p1gb5ms.SetDeviceAttribute ("DataRate", DataRateValue (m_campusDataRate));
+  m_p2p1gb5ms.SetChannelAttribute ("Delay", TimeValue (m_campusDelay));
+  m_p2p2gb200ms.SetDeviceAttribute ("DataRate", DataRateValue (m_ringDataRate));
+  m_p2p2gb200ms.SetChannelAttribute ("Delay", TimeValue (m_ringDelay));
+  m_p2p100mb1ms.SetDeviceAttribute ("DataRate", DataRateValue (m_lanDataRate));
+  m_p2p100mb1ms.SetChannelAttribute ("Delay", TimeValue (m_lanDelay));
+}
+
+CampusTopologyBuilder::~CampusTopologyBuilder ()
+{
+  UnmapSnapshot ();
+}
+
+void
+CampusTopologyBuilder::SetLanSize (uint32_t lanSize)
+{
+  m_lanSize = lanSize;
+}
+
+void
+CampusTopologyBuilder::SetNixVectorRouting (bool enable)
+{
+  m_nix = enable;
+}
+
+void
+CampusTopologyBuilder::SetInternetStack (bool enable)
+{
+  m_internetStack = enable;
+}
+
+void
+CampusTopologyBuilder::SetCorrectedUplinks (bool enable)
+{
+  m_correctedUplinks = enable;
+}
+
+void
+CampusTopologyBuilder::SetLanMode (LanMode mode)
+{
+  m_lanMode = mode;
+}
+
+void
+CampusTopologyBuilder::SetBackbone (Backbone backbone)
+{
+  m_backbone = backbone;
+}
+
+// (campus, LAN number) in the high word, so sorted keys group hosts by LAN
+static inline uint64_t
+SelectionKey (uint32_t campus, uint32_t lanNumber, uint32_t host)
+{
+  return (static_cast<uint64_t> (campus * CampusTopologyIndex::N_LANS + lanNumber) << 32) | host;
+}
+
+void
+CampusTopologyBuilder::SetSystemCount (uint32_t count)
+{
+  NS_ASSERT (count > 0);
+  m_systemCount = count;
+}
+
+uint32_t
+CampusTopologyBuilder::GetSystemId (uint32_t campus) const
+{
+  return campus % m_systemCount;
+}
+
+void
+CampusTopologyBuilder::SelectLanHost (uint32_t campus, CampusTopologyIndex::Tier tier, uint32_t lan, uint32_t host)
+{
+  m_selected.push_back (SelectionKey (campus, CampusTopologyIndex::GetLanNumber (tier, lan), host));
+}
+
+uint32_t
+CampusTopologyBuilder::GetNSelected (uint32_t z, uint32_t lanNumber) const
+{
+  return std::lower_bound (m_selected.begin (), m_selected.end (), SelectionKey (z, lanNumber + 1, 0))
+    - std::lower_bound (m_selected.begin (), m_selected.end (), SelectionKey (z, lanNumber, 0));
+}
+
+uint32_t
+CampusTopologyBuilder::GetNCampus () const
+{
+  return m_index.GetNCampus ();
+}
+
+CampusNetwork
+CampusTopologyBuilder::GetCampus (uint32_t z) const
+{
+  NS_ASSERT (z < m_index.GetNCampus ());
+  return CampusNetwork (this, z);
+}
+
+const NodeContainer &
+CampusTopologyBuilder::GetNodes () const
+{
+  return m_nodes;
+}
+
+const CampusTopologyIndex &
+CampusTopologyBuilder::GetIndex () const
+{
+  return m_index;
+}
+
+const CampusAddressPlan &
+CampusTopologyBuilder::GetAddressPlan () const
+{
+  return m_plan;
+}
+
+Ptr<Node>
+CampusTopologyBuilder::GetNode (uint32_t index) const
+{
+  return m_nodes.Get (index);
+}
+
+Ipv4InterfaceContainer
+CampusTopologyBuilder::GetInterfaces (uint32_t link) const
+{
+  NS_ASSERT_MSG (m_internetStack, "Interfaces need the Internet stack, see SetInternetStack ()");
+  Ipv4InterfaceContainer ifs;
+  if (link != CampusTopologyIndex::NO_LINK)
+    {
+      const CampusTopologyIndex::Link &l = m_index.GetLink (link);
+      ifs.Add (m_nodes.Get (l.from)->GetObject<Ipv4> (), l.fromIf);
+      ifs.Add (m_nodes.Get (l.to)->GetObject<Ipv4> (), l.toIf);
+    }
+  return ifs;
+}
+
+uint32_t
+CampusTopologyBuilder::GetLanHostIndex (uint32_t campus, CampusTopologyIndex::Tier tier, uint32_t lan,
+                                        uint32_t host) const
+{
+  NS_ASSERT (host < m_lanSize);
+  if (m_lanMode == LAN_FULL)
+    {
+      return m_index.GetIndex (campus, tier, lan, host);
+    }
+
+  // Selected hosts come first on the LAN, in host order
+  const uint32_t n = CampusTopologyIndex::GetLanNumber (tier, lan);
+  std::vector<uint64_t>::const_iterator first =
+    std::lower_bound (m_selected.begin (), m_selected.end (), SelectionKey (campus, n, 0));
+  std::vector<uint64_t>::const_iterator i =
+    std::lower_bound (first, m_selected.end (), SelectionKey (campus, n, host));
+  if (i != m_selected.end () && *i == SelectionKey (campus, n, host))
+    {
+      return m_index.GetIndex (campus, tier, lan, i - first);
+    }
+
+  NS_ABORT_MSG_UNLESS (m_lanMode == LAN_AGGREGATED,
+                       "LAN host " << host << " of LAN " << n << " in campus " << campus << " was not selected");
+  // The aggregate host is the last node of the LAN
+  return m_index.GetIndex (campus, tier, lan, m_index.GetLanNodes (campus, tier, lan) - 1);
+}
+
+NodeContainer
+CampusTopologyBuilder::GetLanHosts () const
+{
+  // Each LAN tier is one contiguous range of the campus
+  static const CampusTopologyIndex::Tier lanTiers[] = { CampusTopologyIndex::NET2_LAN,
+                                                        CampusTopologyIndex::NET3_LAN };
+  NodeContainer hosts;
+  for (uint32_t z = 0; z < m_index.GetNCampus (); ++z)
+    {
+      for (uint32_t t = 0; t < 2; ++t)
+        {
+          const uint32_t first = m_index.GetTierStart (z, lanTiers[t]);
+          for (uint32_t i = 0; i < m_index.GetTierSize (z, lanTiers[t]); ++i)
+            {
+              hosts.Add (m_nodes.Get (first + i));
+            }
+        }
+    }
+  return hosts;
+}
+
+NodeContainer
+CampusTopologyBuilder::GetRouters () const
+{
+  NodeContainer routers;
+  for (uint32_t i = 0; i < m_nodes.GetN (); ++i)
+    {
+      CampusTopologyIndex::Tier tier = m_index.GetTier (i);
+      if (tier != CampusTopologyIndex::NET2_LAN && tier != CampusTopologyIndex::NET3_LAN)
+        {
+          routers.Add (m_nodes.Get (i));
+        }
+    }
+  return routers;
+}
+
+double
+CampusTopologyBuilder::GetBuildTime () const
+{
+  return m_buildTime;
+}
+
+PointToPointHelper &
+CampusTopologyBuilder::GetCampusLinkHelper ()
+{
+  return m_p2p1gb5ms;
+}
+
+PointToPointHelper &
+CampusTopologyBuilder::GetLanLinkHelper ()
+{
+  return m_p2p100mb1ms;
+}
+
+PointToPointHelper &
+CampusTopologyBuilder::GetRingLinkHelper ()
+{
+  return m_p2p2gb200ms;
+}
+
+// PointToPointHelper makes the links between MPI ranks remote channels
+static bool
+IsDistributed ()
+{
+  StringValue impl;
+  GlobalValue::GetValueByName ("SimulatorImplementationType", impl);
+  return impl.Get () == "ns3::DistributedSimulatorImpl";
+}
+
+uint32_t
+CampusTopologyBuilder::Install (const DataRate &rate, const Time &delay, uint32_t from, uint32_t to)
+{
+  Ptr<Node> a = m_nodes.Get (from);
+  Ptr<Node> b = m_nodes.Get (to);
+  if (a->GetSystemId () != b->GetSystemId () && !IsDistributed ())
+    {
+      // Partitions of CampusParallelSimulatorImpl must not share packets
+      m_devices.push_back (CampusPointToPointChannel::Install (a, b, rate, delay));
+    }
+  else
+    {
+      m_p2p.SetDeviceAttribute ("DataRate", DataRateValue (rate));
+      m_p2p.SetChannelAttribute ("Delay", TimeValue (delay));
+      m_devices.push_back (m_p2p.Install (a, b));
+    }
+
+  InstalledLink installed;
+  installed.from = from;
+  installed.to = to;
+  installed.bitRate = rate.GetBitRate ();
+  installed.delay = delay.GetNanoSeconds ();
+  m_installed.push_back (installed);
+  return m_installed.size () - 1;
+}
+
+uint32_t
+CampusTopologyBuilder::Assign (uint32_t installed)
+{
+  const InstalledLink &l = m_installed[installed];
+  uint32_t link = m_plan.AddLink (l.from, l.to);
+
+  m_linkInstall.push_back (installed);
+  return m_index.AddLink (l.from, l.to, m_plan.GetInterface (link, 0), m_plan.GetInterface (link, 1));
+}
+
+uint32_t
+CampusTopologyBuilder::AssignSubnet (uint32_t installed, uint32_t network, uint32_t mask)
+{
+  m_plan.SetBase (network, mask);
+  return Assign (installed);
+}
+
+void
+CampusTopologyBuilder::AssignOwnedSubnet (uint32_t installed, uint32_t network, uint32_t mask)
+{
+  uint32_t link = AssignSubnet (installed, network, mask);
+  m_index.SetPrimaryLink (m_index.GetLink (link).from, link);
+}
+
+void
+CampusTopologyBuilder::InstallStack ()
+{
+  if (m_internetStack && m_nix)
+    {
+      // Setup NixVector Routing, has effect on the next Install ()
+      Ipv4NixVectorHelper nixRouting;
+      Ipv4StaticRoutingHelper staticRouting;
+
+      Ipv4ListRoutingHelper list;
+      list.Add (staticRouting, 0);
+      list.Add (nixRouting, 10);
+
+      m_stack.SetRoutingHelper (list);
+    }
+
+  // One allocation per campus, on the rank of the campus, and one stack
+  // installation for every campus
+  m_nodes = NodeContainer ();
+  for (uint32_t z = 0; z < m_index.GetNCampus (); ++z)
+    {
+      m_nodes.Create (m_index.GetCampusSize (z), GetSystemId (z));
+    }
+  if (m_internetStack)
+    {
+      m_stack.Install (m_nodes);
+    }
+
+  m_devices.clear ();
+  m_installed.clear ();
+  m_linkInstall.clear ();
+  m_plan.Reset (m_index.GetNNodes ());
+}
+
+void
+CampusTopologyBuilder::AssignAddresses ()
+{
+  // Without the Internet stack the plan only serves as identifiers
+  if (m_internetStack)
+    {
+      // Same steps as Ipv4AddressHelper::Assign (), without its per-address
+      // bookkeeping and in a single pass over the links
+      for (uint32_t l = 0; l < m_plan.GetNLinks (); ++l)
+        {
+          const NetDeviceContainer &devices = m_devices[m_linkInstall[l]];
+          for (uint32_t k = 0; k < 2; ++k)
+            {
+              Ptr<NetDevice> device = devices.Get (k);
+              Ptr<Ipv4> ipv4 = device->GetNode ()->GetObject<Ipv4> ();
+              NS_ASSERT_MSG (ipv4 != 0, "No Internet stack on node " << device->GetNode ()->GetId ());
+              uint32_t i = ipv4->AddInterface (device);
+              NS_ABORT_MSG_IF (i != m_plan.GetInterface (l, k), "Interface " << i << " of node "
+                               << device->GetNode ()->GetId () << " does not follow the address plan");
+              ipv4->AddAddress (i, Ipv4InterfaceAddress (m_plan.GetAddress (l, k), m_plan.GetMask (l)));
+              ipv4->SetMetric (i, 1);
+              ipv4->SetUp (i);
+            }
+        }
+    }
+  m_plan.Finalize ();
+}
+
+void
+CampusTopologyBuilder::Build (uint32_t nCampus)
+{
+  double start = WallClock ();
+
+  // Work out how many nodes every LAN gets in the selected mode
+  std::vector<uint32_t> lanNodes = GetLanNodes (nCampus);
+  m_index.Reset (m_lanSize, lanNodes);
+  InstallStack ();
+
+  for (uint32_t z = 0; z < nCampus; ++z)
+    {
+      BuildCampus (z);
+    }
+
+  BuildBackbone ();
+  AssignAddresses ();
+  m_index.Finalize ();
+
+  m_buildTime = WallClock () - start;
+  std::cout << "Topology setup took " << m_buildTime << " s ("
+            << m_index.GetNNodes () << " nodes, " << m_index.GetNLinks () << " links"
+            << (m_internetStack ? "" : ", no IPv4") << ")" << std::endl;
+}
+
+std::vector<uint32_t>
+CampusTopologyBuilder::GetLanNodes (uint32_t nCampus)
+{
+  std::sort (m_selected.begin (), m_selected.end ());
+  m_selected.erase (std::unique (m_selected.begin (), m_selected.end ()), m_selected.end ());
+
+  std::vector<uint32_t> lanNodes (nCampus * CampusTopologyIndex::N_LANS, m_lanSize);
+  if (m_lanMode == LAN_FULL)
+    {
+      return lanNodes;
+    }
+
+  for (std::vector<uint64_t>::const_iterator i = m_selected.begin (); i != m_selected.end (); ++i)
+    {
+      NS_ABORT_MSG_IF ((*i >> 32) >= lanNodes.size () || (*i & 0xffffffff) >= m_lanSize,
+                       "Selected LAN host " << (*i & 0xffffffff) << " is outside of the topology");
+    }
+  for (uint32_t n = 0; n < lanNodes.size (); ++n)
+    {
+      uint32_t selected = GetNSelected (n / CampusTopologyIndex::N_LANS, n % CampusTopologyIndex::N_LANS);
+      lanNodes[n] = selected + (m_lanMode == LAN_AGGREGATED && selected < m_lanSize ? 1 : 0);
+    }
+  return lanNodes;
+}
+
+void
+CampusTopologyBuilder::BuildCampus (uint32_t z)
+{
+  typedef CampusTopologyIndex I;
+  const I &x = m_index;
+  const uint32_t a = 10 + z;
+
+  std::cout << "Creating Campus Network " << z << ":" << std::endl;
+
+  // Create Net0
+  std::cout << "  SubNet [ 0";
+  uint32_t ndc0[CampusNetwork::NET0_ROUTERS];
+  for (uint32_t i = 0; i < CampusNetwork::NET0_ROUTERS; ++i)
+    {
+      ndc0[i] = Install (m_campusDataRate, m_campusDelay, x.GetIndex (z, I::NET0, i),
+                         x.GetIndex (z, I::NET0, (i + 1) % CampusNetwork::NET0_ROUTERS));
+    }
+
+  // Create Net1, router 1 has no link of its own
+  std::cout << " 1";
+  static const uint32_t net1Peer[CampusNetwork::NET1_ROUTERS] = { 1, 0, 0, 0, 1, 1 };
+  uint32_t ndc1[CampusNetwork::NET1_ROUTERS];
+  for (uint32_t i = 0; i < CampusNetwork::NET1_ROUTERS; ++i)
+    {
+      if (i == 1)
+        {
+          continue;
+        }
+      ndc1[i] = Install (m_campusDataRate, m_campusDelay, x.GetIndex (z, I::NET1, i),
+                         x.GetIndex (z, I::NET1, net1Peer[i]));
+    }
+
+  // Connect Net0 <-> Net1
+  AssignSubnet (Install (m_campusDataRate, m_campusDelay, x.GetIndex (z, I::NET0, m_correctedUplinks ? 1 : 2),
+                         x.GetIndex (z, I::NET1, 0)), CampusAddressPlan::MakeSubnet (a, 1, 252));
+
+  // Create Net2
+  std::cout << " 2";
+  static const uint32_t net2Peer[CampusNetwork::NET2_ROUTERS] = { 1, 0, 3, 2, 2, 3, 5, 2, 3, 4, 5, 6, 6, 6 };
+  uint32_t ndc2[CampusNetwork::NET2_ROUTERS];
+  for (uint32_t i = 0; i < CampusNetwork::NET2_ROUTERS; ++i)
+    {
+      ndc2[i] = Install (m_campusDataRate, m_campusDelay, x.GetIndex (z, I::NET2, i),
+                         x.GetIndex (z, I::NET2, net2Peer[i]));
+    }
+
+  for (uint32_t i = 0; i < CampusNetwork::NET2_LANS; ++i)
+    {
+      m_plan.SetBase (CampusAddressPlan::MakeSubnet (a, 4, 15 + i));
+      BuildLan (z, I::NET2_LAN, i, x.GetIndex (z, I::NET2, i + 7));
+    }
+
+  // Create Net3
+  std::cout << " 3 ]" << std::endl;
+  static const uint32_t net3Peer[CampusNetwork::NET3_ROUTERS] = { 1, 2, 3, 1, 0, 0, 2, 3, 3 };
+  uint32_t ndc3[CampusNetwork::NET3_ROUTERS];
+  for (uint32_t i = 0; i < CampusNetwork::NET3_ROUTERS; ++i)
+    {
+      ndc3[i] = Install (m_campusDataRate, m_campusDelay, x.GetIndex (z, I::NET3, i),
+                         x.GetIndex (z, I::NET3, net3Peer[i]));
+    }
+
+  for (uint32_t i = 0; i < CampusNetwork::NET3_LANS; ++i)
+    {
+      // The Net3 LANs have always used a /32 mask, keep it so addresses
+      // and routing stay identical to the original model
+      m_plan.SetBase (CampusAddressPlan::MakeSubnet (a, 5, 10 + i), 0xffffffff);
+      BuildLan (z, I::NET3_LAN, i, x.GetIndex (z, I::NET3, i + 4));
+    }
+
+  std::cout << "  Connecting Subnets..." << std::endl;
+  // Lone Routers (Node 4 & 5) connect Net2/Net3 to Net0
+  uint32_t ndcLR = Install (m_campusDataRate, m_campusDelay, x.GetIndex (z, I::LONE_ROUTER, 0),
+                            x.GetIndex (z, I::LONE_ROUTER, 1));
+
+  struct
+  {
+    uint32_t lr;
+    I::Tier tier;
+    uint32_t peer;
+    uint32_t b;
+    uint32_t c;
+  } uplinks[] = {
+    { 0, I::NET0, 0, 1, 253 },
+    { 1, I::NET0, m_correctedUplinks ? 2u : 1u, 1, 254 },
+    { 0, I::NET2, 0, 4, 253 },
+    { m_correctedUplinks ? 0u : 1u, I::NET2, 1, 4, 254 },
+    { 1, I::NET3, 0, 5, 253 },
+    { 1, I::NET3, 1, 5, 254 },
+  };
+  for (size_t i = 0; i < sizeof (uplinks) / sizeof (uplinks[0]); ++i)
+    {
+      AssignSubnet (Install (m_campusDataRate, m_campusDelay, x.GetIndex (z, I::LONE_ROUTER, uplinks[i].lr),
+                             x.GetIndex (z, uplinks[i].tier, uplinks[i].peer)),
+                    CampusAddressPlan::MakeSubnet (a, uplinks[i].b, uplinks[i].c));
+    }
+
+  // Assign IP addresses
+  std::cout << "  Assigning IP addresses..." << std::endl;
+  for (uint32_t i = 0; i < CampusNetwork::NET0_ROUTERS; ++i)
+    {
+      AssignOwnedSubnet (ndc0[i], CampusAddressPlan::MakeSubnet (a, 1, 1 + i));
+    }
+
+  for (uint32_t i = 0; i < CampusNetwork::NET1_ROUTERS; ++i)
+    {
+      if (i == 1)
+        {
+          continue;
+        }
+      AssignOwnedSubnet (ndc1[i], CampusAddressPlan::MakeSubnet (a, 2, 1 + i));
+    }
+
+  AssignSubnet (ndcLR, CampusAddressPlan::MakeSubnet (a, 3, 1));
+
+  for (uint32_t i = 0; i < CampusNetwork::NET2_ROUTERS; ++i)
+    {
+      AssignOwnedSubnet (ndc2[i], CampusAddressPlan::MakeSubnet (a, 4, 1 + i));
+    }
+
+  for (uint32_t i = 0; i < CampusNetwork::NET3_ROUTERS; ++i)
+    {
+      AssignOwnedSubnet (ndc3[i], CampusAddressPlan::MakeSubnet (a, 5, 1 + i));
+    }
+}
+
+void
+CampusTopologyBuilder::BuildLan (uint32_t z, CampusTopologyIndex::Tier tier, uint32_t lan, uint32_t router)
+{
+  const uint32_t nNodes = m_index.GetLanNodes (z, tier, lan);
+  const uint32_t nSelected = m_lanMode == LAN_FULL ? m_lanSize
+    : GetNSelected (z, CampusTopologyIndex::GetLanNumber (tier, lan));
+
+  for (uint32_t j = 0; j < nSelected; ++j)
+    {
+      uint32_t host = m_index.GetIndex (z, tier, lan, j);
+      m_index.SetPrimaryLink (host, Assign (Install (m_lanDataRate, m_lanDelay, host, router)));
+    }
+
+  if (nNodes > nSelected)
+    {
+      // Aggregate host: one link with the capacity of all the hosts it stands for
+      DataRate rate (m_lanDataRate.GetBitRate () * (m_lanSize - nSelected));
+      uint32_t host = m_index.GetIndex (z, tier, lan, nSelected);
+      m_index.SetPrimaryLink (host, Assign (Install (rate, m_lanDelay, host, router)));
+    }
+}
+
+std::vector<std::pair<uint32_t, uint32_t> >
+CampusTopologyBuilder::GetBackboneLinks (uint32_t nCampus) const
+{
+  std::vector<std::pair<uint32_t, uint32_t> > links;
+  if (nCampus < 2)
+    {
+      return links;
+    }
+
+  switch (m_backbone)
+    {
+    case BACKBONE_RING:
+      // Two campuses keep their two parallel links, as they always had
+      for (uint32_t z = 0; z < nCampus; ++z)
+        {
+          links.push_back (std::make_pair (z, (z + 1) % nCampus));
+        }
+      break;
+    case BACKBONE_MESH:
+      for (uint32_t z = 0; z < nCampus; ++z)
+        {
+          for (uint32_t y = z + 1; y < nCampus; ++y)
+            {
+              links.push_back (std::make_pair (z, y));
+            }
+        }
+      break;
+    case BACKBONE_STAR:
+      for (uint32_t z = 1; z < nCampus; ++z)
+        {
+          links.push_back (std::make_pair (0u, z));
+        }
+      break;
+    case BACKBONE_TREE:
+      for (uint32_t z = 1; z < nCampus; ++z)
+        {
+          links.push_back (std::make_pair ((z - 1) / 2, z));
+        }
+      break;
+    case BACKBONE_TORUS:
+      {
+        uint32_t rows = 1;
+        for (uint32_t r = 1; r * r <= nCampus; ++r)
+          {
+            if (nCampus % r == 0)
+              {
+                rows = r;
+              }
+          }
+        const uint32_t cols = nCampus / rows;
+        for (uint32_t i = 0; i < rows; ++i)
+          {
+            for (uint32_t j = 0; j < cols; ++j)
+              {
+                // With two rows (columns) the wrap-around link would
+                // duplicate the direct one
+                if (cols > 2 || (cols == 2 && j == 0))
+                  {
+                    links.push_back (std::make_pair (i * cols + j, i * cols + (j + 1) % cols));
+                  }
+                if (rows > 2 || (rows == 2 && i == 0))
+                  {
+                    links.push_back (std::make_pair (i * cols + j, ((i + 1) % rows) * cols + j));
+                  }
+              }
+          }
+      }
+      break;
+    }
+  return links;
+}
+
+void
+CampusTopologyBuilder::BuildBackbone ()
+{
+  std::vector<std::pair<uint32_t, uint32_t> > links = GetBackboneLinks (m_index.GetNCampus ());
+  if (links.empty ())
+    {
+      return;
+    }
+
+  std::cout << "Forming Backbone Topology (" << links.size () << " links)..." << std::endl;
+  for (uint32_t k = 0; k < links.size (); ++k)
+    {
+      uint32_t installed = Install (m_ringDataRate, m_ringDelay,
+                                    m_index.GetIndex (links[k].first, CampusTopologyIndex::NET0, 0),
+                                    m_index.GetIndex (links[k].second, CampusTopologyIndex::NET0, 0));
+      // 254.1.1.0 onwards, the ring keeps its historical subnets
+      AssignSubnet (installed, CampusAddressPlan::MakeSubnet (254, 1 + (k + 1) / 256, (k + 1) % 256));
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Snapshots
+//
+// A snapshot is a header followed by the sections below, each padded to
+// 8 bytes so that the mapped file can be read in place:
+//
+//   uint32_t      lanNodes[nCampus * N_LANS]
+//   uint32_t      primaryLink[nNodes]
+//   InstalledLink installed[nInstalled]  (installation order)
+//   SnapshotLink  links[nLinks]          (index order)
+//   SnapshotRoute routes[nRoutes]
+//   char          strings[stringsSize]   (NUL-terminated prefixes)
+//////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = { 'C', 'A', 'M', 'P', 'T', 'O', 'P', 'O' };
+const uint32_t SNAPSHOT_VERSION = 1;
+
+struct SnapshotHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t nCampus;
+  uint64_t config;
+  uint32_t lanSize;
+  uint32_t nNodes;
+  uint32_t nInstalled;
+  uint32_t nLinks;
+  uint32_t nRoutes;
+  uint32_t stringsSize;
+};
+
+struct SnapshotLink
+{
+  uint32_t installed;
+  uint32_t fromIf;
+  uint32_t toIf;
+  uint32_t fromAddress;
+  uint32_t toAddress;
+  uint32_t mask;
+};
+
+struct SnapshotRoute
+{
+  uint32_t node;
+  uint32_t link;
+  uint32_t prefix; ///< offset in the string section
+  int32_t metric;
+};
+
+inline size_t
+Padded (size_t size)
+{
+  return (size + 7) & ~static_cast<size_t> (7);
+}
+
+template<class T>
+void
+WriteSection (std::ostream &os, const std::vector<T> &v)
+{
+  static const char zero[8] = { 0 };
+  size_t size = v.size () * sizeof (T);
+  if (size > 0)
+    {
+      os.write (reinterpret_cast<const char *> (&v[0]), size);
+    }
+  os.write (zero, Padded (size) - size);
+}
+
+// FNV-1a
+inline void
+HashBytes (uint64_t &hash, const void *data, size_t size)
+{
+  const unsigned char *p = static_cast<const unsigned char *> (data);
+  for (size_t i = 0; i < size; ++i)
+    {
+      hash = (hash ^ p[i]) * 1099511628211ULL;
+    }
+}
+
+template<class T>
+inline void
+Hash (uint64_t &hash, T value)
+{
+  HashBytes (hash, &value, sizeof (value));
+}
+
+} // anonymous namespace
+
+uint64_t
+CampusTopologyBuilder::GetConfigHash (uint32_t nCampus) const
+{
+  uint64_t hash = 14695981039346656037ULL;
+  Hash (hash, nCampus);
+  Hash (hash, m_lanSize);
+  Hash (hash, m_nix);
+  Hash (hash, m_correctedUplinks);
+  Hash (hash, static_cast<uint32_t> (m_lanMode));
+  Hash (hash, static_cast<uint32_t> (m_backbone));
+  Hash (hash, m_campusDataRate.GetBitRate ());
+  Hash (hash, m_campusDelay.GetNanoSeconds ());
+  Hash (hash, m_lanDataRate.GetBitRate ());
+  Hash (hash, m_lanDelay.GetNanoSeconds ());
+  Hash (hash, m_ringDataRate.GetBitRate ());
+  Hash (hash, m_ringDelay.GetNanoSeconds ());
+  if (m_lanMode != LAN_FULL)
+    {
+      for (std::vector<uint64_t>::const_iterator i = m_selected.begin (); i != m_selected.end (); ++i)
+        {
+          Hash (hash, *i);
+        }
+    }
+  return hash;
+}
+
+void
+CampusTopologyBuilder::SaveSnapshot (const std::string &file) const
+{
+  double start = WallClock ();
+
+  const uint32_t nNodes = m_index.GetNNodes ();
+  const uint32_t nLinks = m_index.GetNLinks ();
+
+  std::vector<uint32_t> lanNodes;
+  for (uint32_t z = 0; z < m_index.GetNCampus (); ++z)
+    {
+      for (uint32_t n = 0; n < CampusTopologyIndex::N_LANS; ++n)
+        {
+          CampusTopologyIndex::Tier tier = n < CampusNetwork::NET2_LANS ? CampusTopologyIndex::NET2_LAN
+            : CampusTopologyIndex::NET3_LAN;
+          lanNodes.push_back (m_index.GetLanNodes (z, tier, n < CampusNetwork::NET2_LANS ? n
+                                                   : n - CampusNetwork::NET2_LANS));
+        }
+    }
+
+  std::vector<uint32_t> primaryLink (nNodes);
+  for (uint32_t n = 0; n < nNodes; ++n)
+    {
+      primaryLink[n] = m_index.GetPrimaryLink (n);
+    }
+
+  std::vector<SnapshotLink> links (nLinks);
+  std::map<Ptr<NetDevice>, uint32_t> deviceLink;
+  for (uint32_t l = 0; l < nLinks; ++l)
+    {
+      const CampusTopologyIndex::Link &link = m_index.GetLink (l);
+      links[l].installed = m_linkInstall[l];
+      links[l].fromIf = link.fromIf;
+      links[l].toIf = link.toIf;
+      links[l].fromAddress = m_plan.GetAddress (l, 0).Get ();
+      links[l].toAddress = m_plan.GetAddress (l, 1).Get ();
+      links[l].mask = m_plan.GetMask (l).Get ();
+
+      deviceLink[m_devices[m_linkInstall[l]].Get (0)] = l;
+      deviceLink[m_devices[m_linkInstall[l]].Get (1)] = l;
+    }
+
+  // Only faces on the point-to-point links are saved, application faces are
+  // created again when applications start
+  std::vector<SnapshotRoute> routes;
+  std::vector<char> strings;
+  std::map<std::string, uint32_t> prefixes;
+  for (uint32_t n = 0; n < nNodes; ++n)
+    {
+      Ptr<ndn::Fib> fib = m_nodes.Get (n)->GetObject<ndn::Fib> ();
+      if (fib == 0)
+        {
+          continue;
+        }
+      for (Ptr<const ndn::fib::Entry> entry = fib->Begin (); entry != fib->End (); entry = fib->Next (entry))
+        {
+          std::ostringstream prefix;
+          prefix << entry->GetPrefix ();
+          // str () returns a new string each time
+          std::string name = prefix.str ();
+          std::map<std::string, uint32_t>::iterator p = prefixes.find (name);
+          if (p == prefixes.end ())
+            {
+              p = prefixes.insert (std::make_pair (name, static_cast<uint32_t> (strings.size ()))).first;
+              strings.insert (strings.end (), name.begin (), name.end ());
+              strings.push_back ('\0');
+            }
+
+          BOOST_FOREACH (const ndn::fib::FaceMetric &metric, entry->m_faces)
+            {
+              Ptr<ndn::NetDeviceFace> face = DynamicCast<ndn::NetDeviceFace> (metric.GetFace ());
+              if (face == 0)
+                {
+                  continue;
+                }
+              std::map<Ptr<NetDevice>, uint32_t>::const_iterator l = deviceLink.find (face->GetNetDevice ());
+              if (l == deviceLink.end ())
+                {
+                  continue;
+                }
+
+              SnapshotRoute route;
+              route.node = n;
+              route.link = l->second;
+              route.prefix = p->second;
+              route.metric = metric.GetRoutingCost ();
+              routes.push_back (route);
+            }
+        }
+    }
+
+  SnapshotHeader header;
+  std::memset (&header, 0, sizeof (header));
+  std::memcpy (header.magic, SNAPSHOT_MAGIC, sizeof (header.magic));
+  header.version = SNAPSHOT_VERSION;
+  header.nCampus = m_index.GetNCampus ();
+  header.config = GetConfigHash (m_index.GetNCampus ());
+  header.lanSize = m_lanSize;
+  header.nNodes = nNodes;
+  header.nInstalled = m_installed.size ();
+  header.nLinks = nLinks;
+  header.nRoutes = routes.size ();
+  header.stringsSize = strings.size ();
+
+  // Write next to the target and rename, so concurrent runs never map a
+  // half-written file
+  std::ostringstream tmp;
+  tmp << file << "." << getpid ();
+  std::ofstream os (tmp.str ().c_str (), std::ios::binary | std::ios::trunc);
+  os.write (reinterpret_cast<const char *> (&header), sizeof (header));
+  WriteSection (os, lanNodes);
+  WriteSection (os, primaryLink);
+  WriteSection (os, m_installed);
+  WriteSection (os, links);
+  WriteSection (os, routes);
+  WriteSection (os, strings);
+  os.close ();
+
+  if (!os || std::rename (tmp.str ().c_str (), file.c_str ()) != 0)
+    {
+      std::remove (tmp.str ().c_str ());
+      NS_LOG_WARN ("Cannot write topology snapshot " << file);
+      return;
+    }
+
+  std::cout << "Topology snapshot " << file << " written in " << WallClock () - start << " s ("
+            << routes.size () << " routes)" << std::endl;
+}
+
+bool
+CampusTopologyBuilder::LoadSnapshot (const std::string &file, uint32_t nCampus)
+{
+  double start = WallClock ();
+  UnmapSnapshot ();
+
+  int fd = open (file.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      NS_LOG_INFO ("No topology snapshot " << file << ": " << std::strerror (errno));
+      return false;
+    }
+  struct stat st;
+  if (fstat (fd, &st) == 0 && static_cast<size_t> (st.st_size) >= sizeof (SnapshotHeader))
+    {
+      void *p = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED)
+        {
+          m_snapshot = static_cast<const char *> (p);
+          m_snapshotSize = st.st_size;
+        }
+    }
+  close (fd);
+  if (m_snapshot == 0)
+    {
+      return false;
+    }
+
+  // Selection keys are part of the configuration hash, sort them first
+  std::vector<uint32_t> expectedLanNodes = GetLanNodes (nCampus);
+
+  const SnapshotHeader &h = *reinterpret_cast<const SnapshotHeader *> (m_snapshot);
+  const size_t lanSection = Padded (h.nCampus * CampusTopologyIndex::N_LANS * sizeof (uint32_t));
+  const size_t primarySection = Padded (h.nNodes * sizeof (uint32_t));
+  const size_t installedSection = Padded (h.nInstalled * sizeof (InstalledLink));
+  const size_t linkSection = Padded (h.nLinks * sizeof (SnapshotLink));
+  const size_t routeSection = Padded (h.nRoutes * sizeof (SnapshotRoute));
+  if (std::memcmp (h.magic, SNAPSHOT_MAGIC, sizeof (h.magic)) != 0
+      || h.version != SNAPSHOT_VERSION
+      || h.nCampus != nCampus
+      || h.config != GetConfigHash (nCampus)
+      || m_snapshotSize < sizeof (h) + lanSection + primarySection + installedSection
+                          + linkSection + routeSection + h.stringsSize)
+    {
+      std::cout << "Topology snapshot " << file << " does not match this configuration" << std::endl;
+      UnmapSnapshot ();
+      return false;
+    }
+
+  const char *p = m_snapshot + sizeof (h);
+  const uint32_t *lanNodes = reinterpret_cast<const uint32_t *> (p);
+  p += lanSection;
+  const uint32_t *primaryLink = reinterpret_cast<const uint32_t *> (p);
+  p += primarySection;
+  const InstalledLink *installed = reinterpret_cast<const InstalledLink *> (p);
+  p += installedSection;
+  const SnapshotLink *links = reinterpret_cast<const SnapshotLink *> (p);
+
+  NS_ABORT_MSG_IF (!std::equal (expectedLanNodes.begin (), expectedLanNodes.end (), lanNodes),
+                   "Topology snapshot " << file << " is corrupted");
+  m_index.Reset (h.lanSize, expectedLanNodes);
+  NS_ABORT_MSG_IF (m_index.GetNNodes () != h.nNodes, "Topology snapshot " << file << " is corrupted");
+  InstallStack ();
+
+  // Devices are created in the recorded order, so node and interface
+  // numbering are the same as in the run that wrote the snapshot
+  for (uint32_t i = 0; i < h.nInstalled; ++i)
+    {
+      Install (DataRate (installed[i].bitRate), NanoSeconds (installed[i].delay),
+               installed[i].from, installed[i].to);
+    }
+
+  for (uint32_t l = 0; l < h.nLinks; ++l)
+    {
+      const InstalledLink &i = installed[links[l].installed];
+      uint32_t link = m_plan.AddLink (i.from, i.to, links[l].fromAddress, links[l].toAddress, links[l].mask);
+      NS_ABORT_MSG_IF (m_plan.GetInterface (link, 0) != links[l].fromIf || m_plan.GetInterface (link, 1) != links[l].toIf,
+                       "Topology snapshot " << file << " is corrupted");
+
+      m_linkInstall.push_back (links[l].installed);
+      m_index.AddLink (i.from, i.to, links[l].fromIf, links[l].toIf);
+    }
+  AssignAddresses ();
+
+  for (uint32_t n = 0; n < h.nNodes; ++n)
+    {
+      if (primaryLink[n] != CampusTopologyIndex::NO_LINK)
+        {
+          m_index.SetPrimaryLink (n, primaryLink[n]);
+        }
+    }
+  m_index.Finalize ();
+
+  m_buildTime = WallClock () - start;
+  std::cout << "Topology loaded from snapshot " << file << " in " << m_buildTime << " s ("
+            << m_index.GetNNodes () << " nodes, " << m_index.GetNLinks () << " links)" << std::endl;
+  return true;
+}
+
+bool
+CampusTopologyBuilder::LoadRoutes ()
+{
+  if (m_snapshot == 0)
+    {
+      return false;
+    }
+  double start = WallClock ();
+
+  const SnapshotHeader &h = *reinterpret_cast<const SnapshotHeader *> (m_snapshot);
+  const SnapshotRoute *routes = reinterpret_cast<const SnapshotRoute *> (
+    m_snapshot + sizeof (h)
+    + Padded (h.nCampus * CampusTopologyIndex::N_LANS * sizeof (uint32_t))
+    + Padded (h.nNodes * sizeof (uint32_t))
+    + Padded (h.nInstalled * sizeof (InstalledLink))
+    + Padded (h.nLinks * sizeof (SnapshotLink)));
+  const char *strings = reinterpret_cast<const char *> (routes) + Padded (h.nRoutes * sizeof (SnapshotRoute));
+
+  for (uint32_t r = 0; r < h.nRoutes; ++r)
+    {
+      Ptr<Node> node = m_nodes.Get (routes[r].node);
+      const CampusTopologyIndex::Link &link = m_index.GetLink (routes[r].link);
+      Ptr<NetDevice> device = m_devices[m_linkInstall[routes[r].link]].Get (link.from == routes[r].node ? 0 : 1);
+
+      Ptr<ndn::L3Protocol> ndn = node->GetObject<ndn::L3Protocol> ();
+      NS_ABORT_MSG_IF (ndn == 0, "NDN stack is not installed on node " << routes[r].node);
+      ndn::StackHelper::AddRoute (node, strings + routes[r].prefix, ndn->GetFaceByNetDevice (device),
+                                  routes[r].metric);
+    }
+
+  std::cout << "Routes loaded from snapshot in " << WallClock () - start << " s ("
+            << h.nRoutes << " routes)" << std::endl;
+  UnmapSnapshot ();
+  return true;
+}
+
+void
+CampusTopologyBuilder::UnmapSnapshot ()
+{
+  if (m_snapshot != 0)
+    {
+      munmap (const_cast<char *> (m_snapshot), m_snapshotSize);
+      m_snapshot = 0;
+      m_snapshotSize = 0;
+    }
+}
+
+} // namespace ns3
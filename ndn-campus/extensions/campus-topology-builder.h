@@ -0,0 +1,467 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * DARPA NMS Campus Network Model, shared by all the campus scenarios
+ *
+ * Builds the Net0/Net1/Net2/Net3/Lone-Router campus described in
+ * http://www.nsnam.org/~jpelkey3/nms.png and connects an arbitrary number
+ * of campuses over the Net0 routers (in a ring unless another backbone is
+ * selected).
+ */
+
+#ifndef CAMPUS_TOPOLOGY_BUILDER_H
+#define CAMPUS_TOPOLOGY_BUILDER_H
+
+#include <ns3-dev/ns3/core-module.h>
+#include <ns3-dev/ns3/internet-module.h>
+#include <ns3-dev/ns3/network-module.h>
+#include <ns3-dev/ns3/point-to-point-module.h>
+
+#include "campus-address-plan.h"
+#include "campus-topology-index.h"
+
+namespace ns3 {
+
+class CampusTopologyBuilder;
+
+/**
+ * @brief Typed handle on one campus created by CampusTopologyBuilder
+ *
+ * A CampusNetwork is a lightweight view (builder pointer and campus index)
+ * that resolves its accessors through the builder's CampusTopologyIndex.
+ * It can be freely copied and must not outlive the builder.
+ */
+class CampusNetwork
+{
+public:
+  /// Number of routers in each tier of a campus
+  static const uint32_t NET0_ROUTERS = 3;
+  static const uint32_t NET1_ROUTERS = 6;
+  static const uint32_t NET2_ROUTERS = 14;
+  static const uint32_t NET3_ROUTERS = 9;
+  static const uint32_t LONE_ROUTERS = 2;
+  /// Number of host LANs hanging off Net2 and Net3
+  static const uint32_t NET2_LANS = 7;
+  static const uint32_t NET3_LANS = 5;
+
+  CampusNetwork (const CampusTopologyBuilder *builder, uint32_t id);
+
+  /// @brief Campus index in the ring
+  uint32_t
+  GetId () const;
+
+  /// @brief Number of hosts on each LAN
+  uint32_t
+  GetLanSize () const;
+
+  /// @brief Every node of the campus, in creation order
+  NodeContainer
+  GetNodes () const;
+
+  Ptr<Node>
+  Net0 (uint32_t i) const;
+
+  Ptr<Node>
+  Net1 (uint32_t i) const;
+
+  Ptr<Node>
+  Net2 (uint32_t i) const;
+
+  Ptr<Node>
+  Net3 (uint32_t i) const;
+
+  Ptr<Node>
+  LoneRouter (uint32_t i) const;
+
+  /**
+   * @brief Host @p host of Net2 LAN @p lan (LAN router is Net2 (lan + 7))
+   *
+   * @p host is the host number on the full LAN, whatever the LAN mode.  In
+   * LAN_AGGREGATED mode hosts that were not selected resolve to the LAN's
+   * aggregate host.
+   */
+  Ptr<Node>
+  Net2Lan (uint32_t lan, uint32_t host) const;
+
+  /// @brief Host @p host of Net3 LAN @p lan (LAN router is Net3 (lan + 4)), see Net2Lan ()
+  Ptr<Node>
+  Net3Lan (uint32_t lan, uint32_t host) const;
+
+  /// @brief Interfaces of the Net0 link starting at router @p i
+  Ipv4InterfaceContainer
+  Net0Interfaces (uint32_t i) const;
+
+  /// @brief Interfaces of the Net1 link starting at router @p i (empty for i == 1)
+  Ipv4InterfaceContainer
+  Net1Interfaces (uint32_t i) const;
+
+  Ipv4InterfaceContainer
+  Net2Interfaces (uint32_t i) const;
+
+  Ipv4InterfaceContainer
+  Net3Interfaces (uint32_t i) const;
+
+  /// @brief Interfaces of the host <-> LAN router link, host address is index 0
+  Ipv4InterfaceContainer
+  Net2LanInterfaces (uint32_t lan, uint32_t host) const;
+
+  Ipv4InterfaceContainer
+  Net3LanInterfaces (uint32_t lan, uint32_t host) const;
+
+  /// @brief Total number of nodes in a full campus with @p lanSize hosts per LAN
+  static uint32_t
+  GetNNodes (uint32_t lanSize);
+
+private:
+  Ptr<Node>
+  GetNode (CampusTopologyIndex::Tier tier, uint32_t subnet, uint32_t host = 0) const;
+
+  Ipv4InterfaceContainer
+  GetInterfaces (CampusTopologyIndex::Tier tier, uint32_t subnet, uint32_t host = 0) const;
+
+  uint32_t
+  GetIndex (CampusTopologyIndex::Tier tier, uint32_t subnet, uint32_t host) const;
+
+private:
+  const CampusTopologyBuilder *m_builder;
+  uint32_t m_id;
+};
+
+/**
+ * @brief Builds the ring (or other backbone) of NMS campuses used by every scenario
+ *
+ * Usage:
+ * @code
+ *   CampusTopologyBuilder builder;
+ *   builder.SetLanSize (nLANClients);
+ *   builder.SetNixVectorRouting (nix);
+ *   builder.Build (networks);
+ *   Ptr<Node> server = builder.GetCampus (0).Net1 (5);
+ * @endcode
+ *
+ * All nodes are allocated with one NodeContainer::Create call, in the order
+ * the scenarios always created them (campus by campus: Net0, Net1, Net2,
+ * Net2 LANs, Net3, Net3 LANs, Lone Routers), so node IDs are the same as
+ * with the old per-node construction loops.  The Internet stack is
+ * installed with one InternetStackHelper::Install call and every link is
+ * recorded in a CampusTopologyIndex.  The time spent in Build () is printed
+ * and available from GetBuildTime ().
+ *
+ * Parameter sweeps that rebuild the same topology many times can save it,
+ * together with the computed NDN routes, with SaveSnapshot () and reload it
+ * with LoadSnapshot () and LoadRoutes ().
+ */
+class CampusTopologyBuilder
+{
+public:
+  /// @brief How the hosts of the Net2/Net3 LANs are modelled
+  enum LanMode
+    {
+      LAN_FULL,       ///< every host gets its own node and link (default)
+      LAN_SELECTED,   ///< only the hosts passed to SelectLanHost () are created
+      LAN_AGGREGATED  ///< selected hosts, plus one aggregate host per LAN standing for the others
+    };
+
+  /// @brief How campuses are connected, always between Net0 routers 0
+  enum Backbone
+    {
+      BACKBONE_RING,  ///< campus z to z + 1 (default)
+      BACKBONE_MESH,  ///< every pair of campuses
+      BACKBONE_STAR,  ///< campus 0 to every other campus
+      BACKBONE_TREE,  ///< binary tree rooted at campus 0, campus z to (z - 1) / 2
+      BACKBONE_TORUS  ///< 2D torus over the most square rows x columns grid
+    };
+
+  CampusTopologyBuilder ();
+
+  ~CampusTopologyBuilder ();
+
+  /// @brief Number of hosts per Net2/Net3 LAN [42]
+  void
+  SetLanSize (uint32_t lanSize);
+
+  /// @brief Use static + Nix-vector list routing on the Internet stack [true]
+  void
+  SetNixVectorRouting (bool enable);
+
+  /**
+   * @brief Install the IPv4 Internet stack and configure the address plan on it [true]
+   *
+   * CCN-only scenarios never use IPv4 and can skip it: nodes then only get
+   * their point-to-point devices, and the address plan (GetAddressPlan ())
+   * is still computed as a source of unique node and interface identifiers.
+   * The *Interfaces () accessors need the Internet stack.
+   */
+  void
+  SetInternetStack (bool enable);
+
+  /**
+   * @brief Use the corrected Net0 uplinks of the TCP scenarios [false]
+   *
+   * The TCP scenarios attach Net1 to Net0 router 1 (instead of 2), Lone
+   * Router 1 to Net0 router 2 (instead of 1) and Net2 router 1 to Lone
+   * Router 0 (instead of 1).  The CCN scenarios keep the original layout.
+   */
+  void
+  SetCorrectedUplinks (bool enable);
+
+  /**
+   * @brief Select how LAN hosts are modelled [LAN_FULL]
+   *
+   * In LAN_AGGREGATED mode the hosts of a LAN that were not selected are
+   * replaced by a single node, attached to the LAN router by one link whose
+   * data rate is the sum of the links it replaces.  Applications meant for
+   * any of those hosts end up on the aggregate node.
+   */
+  void
+  SetLanMode (LanMode mode);
+
+  /**
+   * @brief Keep host @p host of LAN @p lan of @p tier in @p campus as a node of its own
+   *
+   * Only used in LAN_SELECTED and LAN_AGGREGATED modes, must be called before Build ().
+   */
+  void
+  SelectLanHost (uint32_t campus, CampusTopologyIndex::Tier tier, uint32_t lan, uint32_t host);
+
+  /**
+   * @brief Select the shape of the inter-campus backbone [BACKBONE_RING]
+   *
+   * Every backbone link uses the 2Gbps/200ms ring parameters, so shapes
+   * only differ in the number of links and hops between campuses.  A
+   * torus over a prime number of campuses degenerates into the ring.
+   */
+  void
+  SetBackbone (Backbone backbone);
+
+  /**
+   * @brief Spread the campuses over @p count MPI ranks [1]
+   *
+   * Campus z is created with system id z % count, so that with the
+   * distributed simulator every rank runs whole campuses and only backbone
+   * links (200ms, the lookahead) cross ranks.  Every rank still builds the
+   * whole topology; scenarios install applications and tracers on the
+   * nodes of their own rank only.  Must be called before Build ().
+   *
+   * Without MPI the system ids are the partitions of
+   * CampusParallelSimulatorImpl, and the links between them use
+   * CampusPointToPointChannel.
+   */
+  void
+  SetSystemCount (uint32_t count);
+
+  /// @brief MPI rank that runs campus @p campus
+  uint32_t
+  GetSystemId (uint32_t campus) const;
+
+  /// @brief Create @p nCampus campuses and connect them over the selected backbone
+  void
+  Build (uint32_t nCampus);
+
+  /**
+   * @brief Write the topology and the NDN FIB of every node to @p file
+   *
+   * Meant to be called once routes are computed (after
+   * ndn::GlobalRoutingHelper::CalculateRoutes ()), so that later runs with
+   * the same configuration can skip both the construction of the address
+   * plan and the route computation.
+   */
+  void
+  SaveSnapshot (const std::string &file) const;
+
+  /**
+   * @brief Rebuild the topology from a snapshot written by SaveSnapshot ()
+   *
+   * The file is memory-mapped and the nodes, links and IPv4 interfaces are
+   * recreated exactly as recorded.  Returns false, leaving the builder
+   * untouched, when the file is missing or was written for another
+   * configuration (number of campuses, LAN size and mode, ...); Build ()
+   * must be called in that case.
+   */
+  bool
+  LoadSnapshot (const std::string &file, uint32_t nCampus);
+
+  /**
+   * @brief Install the FIB entries of the loaded snapshot
+   *
+   * Replaces ndn::GlobalRoutingHelper::CalculateRoutes (), must be called
+   * after the NDN stack is installed.  Returns false if no snapshot was
+   * loaded.
+   */
+  bool
+  LoadRoutes ();
+
+  uint32_t
+  GetNCampus () const;
+
+  CampusNetwork
+  GetCampus (uint32_t z) const;
+
+  /// @brief Every node of every campus, indexed like GetIndex ()
+  const NodeContainer &
+  GetNodes () const;
+
+  /// @brief Flat node/link index of the last Build ()
+  const CampusTopologyIndex &
+  GetIndex () const;
+
+  /// @brief IPv4 address plan of the last Build (), indexed like GetIndex ()
+  const CampusAddressPlan &
+  GetAddressPlan () const;
+
+  /// @brief Node with dense index @p index
+  Ptr<Node>
+  GetNode (uint32_t index) const;
+
+  /**
+   * @brief Dense index of host @p host of LAN @p lan of @p tier in @p campus
+   *
+   * @p host is the host number on the full LAN, the LAN mode decides which
+   * node it maps to (see CampusNetwork::Net2Lan ()).
+   */
+  uint32_t
+  GetLanHostIndex (uint32_t campus, CampusTopologyIndex::Tier tier, uint32_t lan, uint32_t host) const;
+
+  /// @brief Both IPv4 interfaces of @p link (empty for CampusTopologyIndex::NO_LINK)
+  Ipv4InterfaceContainer
+  GetInterfaces (uint32_t link) const;
+
+  /// @brief Every Net2 and Net3 LAN host node of every campus, campus by campus
+  NodeContainer
+  GetLanHosts () const;
+
+  /// @brief Every router (Net0 to Net3 and lone routers) of every campus, campus by campus
+  NodeContainer
+  GetRouters () const;
+
+  /// @brief Wall-clock seconds spent in the last Build () or LoadSnapshot ()
+  double
+  GetBuildTime () const;
+
+  /// @brief 1Gbps/5ms helper used for links inside a campus
+  PointToPointHelper &
+  GetCampusLinkHelper ();
+
+  /// @brief 100Mbps/1ms helper used for LAN host links
+  PointToPointHelper &
+  GetLanLinkHelper ();
+
+  /// @brief 2Gbps/200ms helper used for the backbone between campuses
+  PointToPointHelper &
+  GetRingLinkHelper ();
+
+private:
+  void
+  BuildCampus (uint32_t z);
+
+  void
+  BuildBackbone ();
+
+  /// @brief Pairs of campuses connected by the selected backbone
+  std::vector<std::pair<uint32_t, uint32_t> >
+  GetBackboneLinks (uint32_t nCampus) const;
+
+  /// @brief Create the host links of LAN @p lan of @p tier, on the current address base
+  void
+  BuildLan (uint32_t z, CampusTopologyIndex::Tier tier, uint32_t lan, uint32_t router);
+
+  /// @brief Number of selected hosts on LAN @p lanNumber (see CampusTopologyIndex::GetLanNumber ())
+  uint32_t
+  GetNSelected (uint32_t z, uint32_t lanNumber) const;
+
+  /// @brief Number of nodes on every LAN of @p nCampus campuses in the current LAN mode
+  std::vector<uint32_t>
+  GetLanNodes (uint32_t nCampus);
+
+  /// @brief Create the nodes described by the index and install the Internet stack if enabled
+  void
+  InstallStack ();
+
+  /// @brief Install a link between two indexed nodes, returns its installation number
+  uint32_t
+  Install (const DataRate &rate, const Time &delay, uint32_t from, uint32_t to);
+
+  /// @brief Plan the next addresses of the current subnet for installed link @p installed
+  uint32_t
+  Assign (uint32_t installed);
+
+  /// @brief Plan addresses from a new subnet for installed link @p installed
+  uint32_t
+  AssignSubnet (uint32_t installed, uint32_t network, uint32_t mask = 0xffffff00);
+
+  /// @brief Same as AssignSubnet (), and make the link the one owned by its first node
+  void
+  AssignOwnedSubnet (uint32_t installed, uint32_t network, uint32_t mask = 0xffffff00);
+
+  /// @brief Configure every planned interface on the IPv4 stacks (if any), in link order
+  void
+  AssignAddresses ();
+
+  /// @brief Hash of everything that shapes the topology of @p nCampus campuses
+  uint64_t
+  GetConfigHash (uint32_t nCampus) const;
+
+  void
+  UnmapSnapshot ();
+
+private:
+  uint32_t m_lanSize;
+  bool m_nix;
+  bool m_internetStack;
+  bool m_correctedUplinks;
+  LanMode m_lanMode;
+  Backbone m_backbone;
+  uint32_t m_systemCount;
+  double m_buildTime;
+
+  std::vector<uint64_t> m_selected; ///< sorted (campus, LAN number, host) keys
+
+  NodeContainer m_nodes;
+  CampusTopologyIndex m_index;
+
+  /// @brief Link as installed, before any address is assigned
+  struct InstalledLink
+  {
+    uint32_t from;
+    uint32_t to;
+    uint64_t bitRate;
+    int64_t delay; ///< nanoseconds
+  };
+
+  std::vector<InstalledLink> m_installed;   ///< in installation order
+  std::vector<NetDeviceContainer> m_devices; ///< in installation order
+  std::vector<uint32_t> m_linkInstall;      ///< installation number of every index link
+
+  DataRate m_campusDataRate;
+  Time m_campusDelay;
+  DataRate m_lanDataRate;
+  Time m_lanDelay;
+  DataRate m_ringDataRate;
+  Time m_ringDelay;
+
+  PointToPointHelper m_p2p;
+  PointToPointHelper m_p2p1gb5ms;
+  PointToPointHelper m_p2p100mb1ms;
+  PointToPointHelper m_p2p2gb200ms;
+  InternetStackHelper m_stack;
+  CampusAddressPlan m_plan;
+
+  const char *m_snapshot; ///< mapped snapshot, kept until LoadRoutes ()
+  size_t m_snapshotSize;
+};
+
+} // namespace ns3
+
+#endif // CAMPUS_TOPOLOGY_BUILDER_H
@@ -0,0 +1,261 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "campus-topology-index.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+const uint32_t CampusTopologyIndex::NO_LINK;
+const uint32_t CampusTopologyIndex::N_LANS;
+
+// Routers per router tier, LANs per LAN tier
+static const uint32_t g_tierUnits[CampusTopologyIndex::N_TIERS] = { 3, 6, 14, 7, 9, 5, 2 };
+
+static inline bool
+IsLanTier (uint32_t tier)
+{
+  return tier == CampusTopologyIndex::NET2_LAN || tier == CampusTopologyIndex::NET3_LAN;
+}
+
+CampusTopologyIndex::CampusTopologyIndex ()
+{
+  Reset (0, 0);
+}
+
+void
+CampusTopologyIndex::Reset (uint32_t nCampus, uint32_t lanSize)
+{
+  Reset (lanSize, std::vector<uint32_t> (nCampus * N_LANS, lanSize));
+}
+
+void
+CampusTopologyIndex::Reset (uint32_t lanSize, const std::vector<uint32_t> &lanNodes)
+{
+  NS_ASSERT (lanNodes.size () % N_LANS == 0);
+
+  m_nCampus = lanNodes.size () / N_LANS;
+  m_lanSize = lanSize;
+
+  m_tierStart.resize (m_nCampus * N_TIERS + 1);
+  m_lanStart.resize (m_nCampus * N_LANS);
+  m_lanNodes = lanNodes;
+
+  uint32_t next = 0;
+  for (uint32_t z = 0; z < m_nCampus; ++z)
+    {
+      for (uint32_t t = 0; t < N_TIERS; ++t)
+        {
+          m_tierStart[z * N_TIERS + t] = next;
+          if (!IsLanTier (t))
+            {
+              next += g_tierUnits[t];
+              continue;
+            }
+          for (uint32_t lan = 0; lan < g_tierUnits[t]; ++lan)
+            {
+              uint32_t n = GetLanNumber (static_cast<Tier> (t), lan);
+              m_lanStart[z * N_LANS + n] = next;
+              next += lanNodes[z * N_LANS + n];
+            }
+        }
+    }
+  m_tierStart.back () = next;
+
+  // Every node owns at most one link, plus the ring
+  m_links.clear ();
+  m_links.reserve (GetNNodes () + m_nCampus);
+  m_primaryLink.assign (GetNNodes (), NO_LINK);
+  m_adjStart.clear ();
+  m_adjLinks.clear ();
+}
+
+uint32_t
+CampusTopologyIndex::GetLanNumber (Tier tier, uint32_t lan)
+{
+  NS_ASSERT (IsLanTier (tier) && lan < g_tierUnits[tier]);
+  return tier == NET2_LAN ? lan : g_tierUnits[NET2_LAN] + lan;
+}
+
+uint32_t
+CampusTopologyIndex::GetNCampus () const
+{
+  return m_nCampus;
+}
+
+uint32_t
+CampusTopologyIndex::GetLanSize () const
+{
+  return m_lanSize;
+}
+
+uint32_t
+CampusTopologyIndex::GetNNodes () const
+{
+  return m_tierStart.back ();
+}
+
+uint32_t
+CampusTopologyIndex::GetCampusStart (uint32_t campus) const
+{
+  return m_tierStart[campus * N_TIERS];
+}
+
+uint32_t
+CampusTopologyIndex::GetCampusSize (uint32_t campus) const
+{
+  return m_tierStart[(campus + 1) * N_TIERS] - m_tierStart[campus * N_TIERS];
+}
+
+uint32_t
+CampusTopologyIndex::GetTierStart (uint32_t campus, Tier tier) const
+{
+  return m_tierStart[campus * N_TIERS + tier];
+}
+
+uint32_t
+CampusTopologyIndex::GetTierSize (uint32_t campus, Tier tier) const
+{
+  return m_tierStart[campus * N_TIERS + tier + 1] - m_tierStart[campus * N_TIERS + tier];
+}
+
+uint32_t
+CampusTopologyIndex::GetLanNodes (uint32_t campus, Tier tier, uint32_t lan) const
+{
+  return m_lanNodes[campus * N_LANS + GetLanNumber (tier, lan)];
+}
+
+uint32_t
+CampusTopologyIndex::GetIndex (uint32_t campus, Tier tier, uint32_t subnet, uint32_t host) const
+{
+  NS_ASSERT (campus < m_nCampus);
+  NS_ASSERT (subnet < g_tierUnits[tier]);
+
+  if (IsLanTier (tier))
+    {
+      NS_ASSERT (host < GetLanNodes (campus, tier, subnet));
+      return m_lanStart[campus * N_LANS + GetLanNumber (tier, subnet)] + host;
+    }
+
+  NS_ASSERT (host == 0);
+  return m_tierStart[campus * N_TIERS + tier] + subnet;
+}
+
+uint32_t
+CampusTopologyIndex::GetCampus (uint32_t node) const
+{
+  NS_ASSERT (node < GetNNodes ());
+  std::vector<uint32_t>::const_iterator i = std::upper_bound (m_tierStart.begin (), m_tierStart.end (), node);
+  return (i - m_tierStart.begin () - 1) / N_TIERS;
+}
+
+CampusTopologyIndex::Tier
+CampusTopologyIndex::GetTier (uint32_t node) const
+{
+  NS_ASSERT (node < GetNNodes ());
+  // Empty tiers (fully elided LANs) share their start with the next tier,
+  // upper_bound skips them
+  std::vector<uint32_t>::const_iterator i = std::upper_bound (m_tierStart.begin (), m_tierStart.end (), node);
+  return static_cast<Tier> ((i - m_tierStart.begin () - 1) % N_TIERS);
+}
+
+uint32_t
+CampusTopologyIndex::AddLink (uint32_t from, uint32_t to, uint32_t fromIf, uint32_t toIf)
+{
+  NS_ASSERT (from < GetNNodes () && to < GetNNodes ());
+
+  Link link;
+  link.from = from;
+  link.to = to;
+  link.fromIf = fromIf;
+  link.toIf = toIf;
+  m_links.push_back (link);
+  return m_links.size () - 1;
+}
+
+void
+CampusTopologyIndex::SetPrimaryLink (uint32_t node, uint32_t link)
+{
+  m_primaryLink[node] = link;
+}
+
+uint32_t
+CampusTopologyIndex::GetPrimaryLink (uint32_t node) const
+{
+  return m_primaryLink[node];
+}
+
+uint32_t
+CampusTopologyIndex::GetNLinks () const
+{
+  return m_links.size ();
+}
+
+const CampusTopologyIndex::Link &
+CampusTopologyIndex::GetLink (uint32_t link) const
+{
+  return m_links[link];
+}
+
+void
+CampusTopologyIndex::Finalize ()
+{
+  const uint32_t nNodes = GetNNodes ();
+
+  // Count degrees, prefix-sum them into start offsets, then scatter
+  m_adjStart.assign (nNodes + 1, 0);
+  for (std::vector<Link>::const_iterator l = m_links.begin (); l != m_links.end (); ++l)
+    {
+      ++m_adjStart[l->from + 1];
+      ++m_adjStart[l->to + 1];
+    }
+  for (uint32_t n = 0; n < nNodes; ++n)
+    {
+      m_adjStart[n + 1] += m_adjStart[n];
+    }
+
+  m_adjLinks.resize (m_adjStart[nNodes]);
+  std::vector<uint32_t> fill (m_adjStart.begin (), m_adjStart.end () - 1);
+  for (uint32_t i = 0; i < m_links.size (); ++i)
+    {
+      m_adjLinks[fill[m_links[i].from]++] = i;
+      m_adjLinks[fill[m_links[i].to]++] = i;
+    }
+}
+
+uint32_t
+CampusTopologyIndex::GetDegree (uint32_t node) const
+{
+  NS_ASSERT_MSG (!m_adjStart.empty (), "CampusTopologyIndex::Finalize () has not been called");
+  return m_adjStart[node + 1] - m_adjStart[node];
+}
+
+uint32_t
+CampusTopologyIndex::GetNeighborLink (uint32_t node, uint32_t k) const
+{
+  NS_ASSERT (k < GetDegree (node));
+  return m_adjLinks[m_adjStart[node] + k];
+}
+
+uint32_t
+CampusTopologyIndex::GetNeighbor (uint32_t node, uint32_t k) const
+{
+  const Link &link = m_links[GetNeighborLink (node, k)];
+  return link.from == node ? link.to : link.from;
+}
+
+} // namespace ns3
@@ -0,0 +1,194 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CAMPUS_TOPOLOGY_INDEX_H
+#define CAMPUS_TOPOLOGY_INDEX_H
+
+#include <vector>
+
+#include <ns3-dev/ns3/core-module.h>
+
+namespace ns3 {
+
+/**
+ * @brief Flat index of the nodes and links of a ring of NMS campuses
+ *
+ * Nodes are identified by a dense index (equal to their position in the
+ * builder's NodeContainer).  Campus, tier and LAN start offsets are kept in
+ * flat offset tables, so (campus, tier, subnet, host) lookups are a couple
+ * of array reads.  LANs do not need to have the same number of hosts, which
+ * lets the builder elide or aggregate hosts that are not used.
+ *
+ * Links are stored in a single array and adjacency is kept in CSR form
+ * (one offset array plus one array of link indexes), so the whole topology
+ * is described by a handful of contiguous vectors regardless of the number
+ * of campuses and LAN hosts.
+ */
+class CampusTopologyIndex
+{
+public:
+  /// @brief Tiers of a campus, in node creation order
+  enum Tier
+    {
+      NET0 = 0,
+      NET1,
+      NET2,
+      NET2_LAN,
+      NET3,
+      NET3_LAN,
+      LONE_ROUTER,
+      N_TIERS
+    };
+
+  /// @brief Returned by GetPrimaryLink () for nodes that own no link
+  static const uint32_t NO_LINK = 0xffffffff;
+
+  /// @brief Number of LANs in a campus (Net2 LANs first, then Net3 LANs)
+  static const uint32_t N_LANS = 12;
+
+  /// @brief Point-to-point link between two nodes, with their IPv4 interface indexes
+  struct Link
+  {
+    uint32_t from;
+    uint32_t to;
+    uint32_t fromIf;
+    uint32_t toIf;
+  };
+
+  CampusTopologyIndex ();
+
+  /**
+   * @brief Set the shape of the index and drop all links
+   *
+   * Computes the offset tables and reserves the link and adjacency arrays
+   * for @p nCampus campuses with @p lanSize hosts on every LAN.
+   */
+  void
+  Reset (uint32_t nCampus, uint32_t lanSize);
+
+  /**
+   * @brief Same as Reset (uint32_t, uint32_t), with a per-LAN number of nodes
+   *
+   * @param lanSize nominal number of hosts per LAN
+   * @param lanNodes number of nodes actually created on every LAN, N_LANS
+   *        entries per campus (see GetLanNumber ())
+   */
+  void
+  Reset (uint32_t lanSize, const std::vector<uint32_t> &lanNodes);
+
+  /// @brief Position of LAN @p lan of @p tier among the N_LANS LANs of a campus
+  static uint32_t
+  GetLanNumber (Tier tier, uint32_t lan);
+
+  uint32_t
+  GetNCampus () const;
+
+  /// @brief Nominal number of hosts per LAN
+  uint32_t
+  GetLanSize () const;
+
+  /// @brief Total number of indexed nodes
+  uint32_t
+  GetNNodes () const;
+
+  /// @brief Index of the first node of @p campus
+  uint32_t
+  GetCampusStart (uint32_t campus) const;
+
+  /// @brief Number of nodes of @p campus
+  uint32_t
+  GetCampusSize (uint32_t campus) const;
+
+  /// @brief Index of the first node of @p tier in @p campus
+  uint32_t
+  GetTierStart (uint32_t campus, Tier tier) const;
+
+  /// @brief Number of nodes of @p tier in @p campus
+  uint32_t
+  GetTierSize (uint32_t campus, Tier tier) const;
+
+  /// @brief Number of nodes on LAN @p lan of @p tier in @p campus
+  uint32_t
+  GetLanNodes (uint32_t campus, Tier tier, uint32_t lan) const;
+
+  /**
+   * @brief Dense index of a node
+   *
+   * For router tiers @p subnet is the router number and @p host must be 0.
+   * For the LAN tiers @p subnet is the LAN number and @p host the host on it.
+   */
+  uint32_t
+  GetIndex (uint32_t campus, Tier tier, uint32_t subnet, uint32_t host = 0) const;
+
+  /// @brief Campus that node @p node belongs to
+  uint32_t
+  GetCampus (uint32_t node) const;
+
+  /// @brief Tier of node @p node
+  Tier
+  GetTier (uint32_t node) const;
+
+  /// @brief Record a link and return its index
+  uint32_t
+  AddLink (uint32_t from, uint32_t to, uint32_t fromIf, uint32_t toIf);
+
+  /// @brief Mark @p link as the link owned by @p node (the old ifsN[z][i] slot)
+  void
+  SetPrimaryLink (uint32_t node, uint32_t link);
+
+  /// @brief Link owned by @p node or NO_LINK
+  uint32_t
+  GetPrimaryLink (uint32_t node) const;
+
+  uint32_t
+  GetNLinks () const;
+
+  const Link &
+  GetLink (uint32_t link) const;
+
+  /// @brief Build the CSR adjacency, must be called after the last AddLink ()
+  void
+  Finalize ();
+
+  /// @brief Number of links attached to @p node
+  uint32_t
+  GetDegree (uint32_t node) const;
+
+  /// @brief Index of the @p k-th link attached to @p node
+  uint32_t
+  GetNeighborLink (uint32_t node, uint32_t k) const;
+
+  /// @brief Node on the other side of the @p k-th link of @p node
+  uint32_t
+  GetNeighbor (uint32_t node, uint32_t k) const;
+
+private:
+  uint32_t m_nCampus;
+  uint32_t m_lanSize;
+
+  std::vector<uint32_t> m_tierStart; ///< N_TIERS entries per campus, plus the end
+  std::vector<uint32_t> m_lanStart;  ///< N_LANS entries per campus
+  std::vector<uint32_t> m_lanNodes;  ///< N_LANS entries per campus
+
+  std::vector<Link> m_links;
+  std::vector<uint32_t> m_primaryLink;
+  std::vector<uint32_t> m_adjStart;
+  std::vector<uint32_t> m_adjLinks;
+};
+
+} // namespace ns3
+
+#endif // CAMPUS_TOPOLOGY_INDEX_H
@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "consumer-zipf-alias.h"
+
+#include <cmath>
+#include <limits>
+#include <map>
+#include <mutex>
+
+NS_LOG_COMPONENT_DEFINE ("ConsumerZipfAlias");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (ConsumerZipfAlias);
+
+ZipfAliasTable::ZipfAliasTable (uint32_t n, double q, double s)
+  : m_keep (n, 1)
+  , m_alias (n)
+{
+  NS_ASSERT (n > 0);
+  std::vector<double> scaled (n);
+  double sum = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      scaled[i] = 1.0 / std::pow (i + 1 + q, s);
+      sum += scaled[i];
+    }
+
+  // Vose: columns below the mean are topped up by one above it, which
+  // becomes their alias and loses what it gave
+  std::vector<uint32_t> small;
+  std::vector<uint32_t> large;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      scaled[i] *= n / sum;
+      m_alias[i] = i;
+      (scaled[i] < 1 ? small : large).push_back (i);
+    }
+  while (!small.empty () && !large.empty ())
+    {
+      uint32_t l = small.back ();
+      uint32_t g = large.back ();
+      small.pop_back ();
+      m_keep[l] = scaled[l];
+      m_alias[l] = g;
+      scaled[g] -= 1 - scaled[l];
+      if (scaled[g] < 1)
+        {
+          large.pop_back ();
+          small.push_back (g);
+        }
+    }
+  // Whatever is left is 1 up to rounding errors and keeps its column
+}
+
+const ZipfAliasTable *
+ZipfAliasTable::Get (uint32_t n, double q, double s)
+{
+  typedef std::map<std::pair<uint32_t, std::pair<double, double> >, Ptr<const ZipfAliasTable> > Tables;
+  static Tables tables;
+  // Consumers of different partitions of CampusParallelSimulatorImpl
+  // start in different threads
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock (mutex);
+
+  Ptr<const ZipfAliasTable> &table = tables[std::make_pair (n, std::make_pair (q, s))];
+  if (table == 0)
+    {
+      table = Create<ZipfAliasTable> (n, q, s);
+    }
+  return PeekPointer (table);
+}
+
+uint32_t
+ZipfAliasTable::GetN () const
+{
+  return m_keep.size ();
+}
+
+uint32_t
+ZipfAliasTable::Sample (double u) const
+{
+  double x = u * m_keep.size ();
+  uint32_t i = std::min (static_cast<uint32_t> (x), GetN () - 1);
+  return x - i < m_keep[i] ? i : m_alias[i];
+}
+
+TypeId
+ConsumerZipfAlias::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::ConsumerZipfAlias")
+    .SetParent<CampusConsumerCbr> ()
+    .AddConstructor<ConsumerZipfAlias> ()
+    .AddAttribute ("NumberOfContents", "Number of contents in the catalog",
+                   UintegerValue (1000000),
+                   MakeUintegerAccessor (&ConsumerZipfAlias::m_n),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("q", "Plateau q of the Zipf-Mandelbrot popularity, 0 for plain Zipf",
+                   DoubleValue (0.7),
+                   MakeDoubleAccessor (&ConsumerZipfAlias::m_q),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("s", "Exponent s of the Zipf-Mandelbrot popularity",
+                   DoubleValue (0.7),
+                   MakeDoubleAccessor (&ConsumerZipfAlias::m_s),
+                   MakeDoubleChecker<double> (0))
+    ;
+  return tid;
+}
+
+ConsumerZipfAlias::ConsumerZipfAlias ()
+  : m_n (1000000)
+  , m_q (0.7)
+  , m_s (0.7)
+  , m_table (0)
+  , m_contentRandom (CreateObject<UniformRandomVariable> ())
+{
+}
+
+int64_t
+ConsumerZipfAlias::AssignStreams (int64_t stream)
+{
+  int64_t n = CampusConsumerCbr::AssignStreams (stream);
+  m_contentRandom->SetStream (stream + n);
+  return n + 1;
+}
+
+void
+ConsumerZipfAlias::StartApplication ()
+{
+  m_table = ZipfAliasTable::Get (m_n, m_q, m_s);
+  // Contents are drawn, not counted up to MaxSeq
+  m_seqMax = std::numeric_limits<uint32_t>::max ();
+  CampusConsumerCbr::StartApplication ();
+}
+
+void
+ConsumerZipfAlias::ScheduleNextPacket ()
+{
+  // Consumer::SendPacket () asks for m_seq when nothing is to be
+  // retransmitted
+  m_seq = m_table->Sample (m_contentRandom->GetValue ());
+  CampusConsumerCbr::ScheduleNextPacket ();
+}
+
+} // namespace ns3
@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CONSUMER_ZIPF_ALIAS_H
+#define CONSUMER_ZIPF_ALIAS_H
+
+#include <vector>
+
+#include <ns3-dev/ns3/core-module.h>
+
+#include "campus-consumer-cbr.h"
+
+namespace ns3 {
+
+/**
+ * @brief Alias table of a Zipf-Mandelbrot popularity over a catalog
+ *
+ * Content of rank k, from 1, has a probability proportional to
+ * 1 / (k + q)^s.  The table is built in O(n) by Vose's method and draws a
+ * rank in O(1) from a single uniform number: the integer part picks a
+ * column, the fraction decides between the column and its alias.  It takes
+ * 8 bytes per content, so tables are shared by every consumer with the
+ * same catalog (see Get ()).
+ */
+class ZipfAliasTable : public SimpleRefCount<ZipfAliasTable>
+{
+public:
+  ZipfAliasTable (uint32_t n, double q, double s);
+
+  /// @brief Table of (@p n, @p q, @p s), built at the first request and kept until exit
+  ///
+  /// A plain pointer, as consumers of different threads must not share a
+  /// reference count
+  static const ZipfAliasTable *
+  Get (uint32_t n, double q, double s);
+
+  /// @brief Number of contents in the catalog
+  uint32_t
+  GetN () const;
+
+  /// @brief Index of the content, 0 being the most popular, for @p u uniform in [0, 1)
+  uint32_t
+  Sample (double u) const;
+
+private:
+  std::vector<float> m_keep;        ///< probability of keeping the column
+  std::vector<uint32_t> m_alias;    ///< content drawn otherwise
+};
+
+/**
+ * @brief CampusConsumerCbr asking each Interest for a Zipf-Mandelbrot draw
+ *
+ * ndn::ConsumerZipfMandelbrot finds each content by a linear search of a
+ * cumulative table, which does not scale to catalogs of millions of
+ * objects asked for by thousands of clients.  This consumer draws from a
+ * shared ZipfAliasTable instead: Interests ask for <prefix>/<content>,
+ * content 0 being the most popular, at the rate of CampusConsumerCbr.
+ * Retransmissions ask for the same content again.
+ *
+ * The contents, like the gaps, come from a random variable of the
+ * consumer, on the streams set by AssignStreams () or automatic ones.
+ */
+class ConsumerZipfAlias : public CampusConsumerCbr
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  ConsumerZipfAlias ();
+
+  /// @brief Use streams from @p stream on for the gaps and the content draws, returns the number of streams used
+  virtual int64_t
+  AssignStreams (int64_t stream);
+
+protected:
+  virtual void
+  StartApplication ();
+
+  /// @brief Draw the content of the next Interest, then schedule it
+  virtual void
+  ScheduleNextPacket ();
+
+private:
+  uint32_t m_n;
+  double m_q;
+  double m_s;
+  const ZipfAliasTable *m_table;
+  Ptr<UniformRandomVariable> m_contentRandom;
+};
+
+} // namespace ns3
+
+#endif // CONSUMER_ZIPF_ALIAS_H
@@ -0,0 +1,422 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "counting-scheduler.h"
+
+#include <ns3-dev/ns3/map-scheduler.h>
+
+#include <cxxabi.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+NS_LOG_COMPONENT_DEFINE ("CountingScheduler");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (CountingScheduler);
+
+uint64_t CountingScheduler::s_nExecuted = 0;
+uint64_t CountingScheduler::s_nInserted = 0;
+uint64_t CountingScheduler::s_nRemoved = 0;
+uint64_t CountingScheduler::s_lastTs = 0;
+std::set<const CountingScheduler *> CountingScheduler::s_live;
+CountingScheduler::Profile *CountingScheduler::s_profile = 0;
+int CountingScheduler::s_stopRequested = 0;
+int CountingScheduler::s_finished = 0;
+
+// Guards the static totals and s_live, schedulers may be created and
+// destroyed by any thread
+static std::mutex g_countersMutex;
+
+// Counters are written by the thread of their scheduler only and read by
+// any thread: relaxed atomic accesses are enough, and as cheap as plain
+// ones
+static inline void
+Increment (uint64_t &counter)
+{
+  __atomic_store_n (&counter, counter + 1, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t
+Load (const uint64_t &counter)
+{
+  return __atomic_load_n (&counter, __ATOMIC_RELAXED);
+}
+
+/// @brief Executed events and wall time per event origin
+struct CountingScheduler::Profile
+{
+  struct Origin
+  {
+    Origin ()
+      : events (0)
+      , wall (0)
+    {
+    }
+
+    uint64_t events;
+    std::chrono::steady_clock::duration wall;
+  };
+
+  typedef std::unordered_map<std::type_index, Origin> Origins;
+
+  Profile ()
+    : running (0)
+  {
+  }
+
+  // An event of @p origin starts, the previous one has ended
+  void
+  Begin (const std::type_info &origin)
+  {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now ();
+    if (running != 0)
+      {
+        running->wall += now - start;
+      }
+    running = &origins[std::type_index (origin)];
+    ++running->events;
+    start = now;
+  }
+
+  // The running event, if any, has ended
+  void
+  End ()
+  {
+    if (running != 0)
+      {
+        running->wall += std::chrono::steady_clock::now () - start;
+        running = 0;
+      }
+  }
+
+  void
+  Merge (const Profile &other)
+  {
+    for (Origins::const_iterator i = other.origins.begin (); i != other.origins.end (); ++i)
+      {
+        Origin &origin = origins[i->first];
+        origin.events += i->second.events;
+        origin.wall += i->second.wall;
+      }
+  }
+
+  Origins origins;
+  Origin *running; ///< origin of the event being executed, stable across rehashes
+  std::chrono::steady_clock::time_point start;
+};
+
+// Events made by MakeEvent () are instances of a class local to the
+// MakeEvent () template, "ns3::EventImpl* ns3::MakeEvent<void
+// (ns3::Foo::*)(), ns3::Foo*>(...)::EventMemberImpl0": keep the template
+// arguments only, the scheduled function and its arguments
+static std::string
+OriginName (const std::type_index &origin)
+{
+  int status;
+  char *demangled = abi::__cxa_demangle (origin.name (), 0, 0, &status);
+  std::string name = status == 0 ? demangled : origin.name ();
+  std::free (demangled);
+
+  std::string::size_type begin = name.find ("MakeEvent<");
+  if (begin == std::string::npos)
+    {
+      return name;
+    }
+  begin += std::strlen ("MakeEvent<");
+  std::string::size_type end = begin;
+  for (int depth = 1; end < name.size (); ++end)
+    {
+      if (name[end] == '<')
+        {
+          ++depth;
+        }
+      else if (name[end] == '>' && --depth == 0)
+        {
+          break;
+        }
+    }
+  return name.substr (begin, end - begin);
+}
+
+TypeId
+CountingScheduler::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::CountingScheduler")
+    .SetParent<Scheduler> ()
+    .AddConstructor<CountingScheduler> ()
+    .AddAttribute ("Scheduler", "Scheduler that actually keeps the events",
+                   TypeIdValue (MapScheduler::GetTypeId ()),
+                   MakeTypeIdAccessor (&CountingScheduler::SetScheduler),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("Profile", "Time the executed events by origin, printed by Simulator::Destroy ()",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&CountingScheduler::SetProfile),
+                   MakeBooleanChecker ())
+    ;
+  return tid;
+}
+
+CountingScheduler::CountingScheduler ()
+  : m_nExecuted (0)
+  , m_nInserted (0)
+  , m_nRemoved (0)
+  , m_lastTs (0)
+  , m_profile (0)
+{
+  std::lock_guard<std::mutex> lock (g_countersMutex);
+  s_live.insert (this);
+  // A new simulation
+  __atomic_store_n (&s_finished, 0, __ATOMIC_RELAXED);
+}
+
+CountingScheduler::~CountingScheduler ()
+{
+  std::lock_guard<std::mutex> lock (g_countersMutex);
+  s_nExecuted += m_nExecuted;
+  s_nInserted += m_nInserted;
+  s_nRemoved += m_nRemoved;
+  s_lastTs = std::max (s_lastTs, m_lastTs);
+  s_live.erase (this);
+
+  if (m_profile != 0)
+    {
+      m_profile->End ();
+      if (s_profile == 0)
+        {
+          s_profile = new Profile;
+        }
+      s_profile->Merge (*m_profile);
+      delete m_profile;
+    }
+  if (s_live.empty () && s_profile != 0)
+    {
+      PrintProfile ();
+      delete s_profile;
+      s_profile = 0;
+    }
+}
+
+void
+CountingScheduler::PrintProfile ()
+{
+  typedef std::pair<Profile::Origins::const_iterator, double> Entry;
+  std::vector<Entry> entries;
+  uint64_t events = 0;
+  double wall = 0;
+  for (Profile::Origins::const_iterator i = s_profile->origins.begin (); i != s_profile->origins.end (); ++i)
+    {
+      double seconds = std::chrono::duration<double> (i->second.wall).count ();
+      entries.push_back (Entry (i, seconds));
+      events += i->second.events;
+      wall += seconds;
+    }
+  std::sort (entries.begin (), entries.end (),
+             [] (const Entry &a, const Entry &b) { return a.second > b.second; });
+
+  char line[128];
+  std::cout << "Event profile: " << events << " events, " << wall << " s" << std::endl;
+  std::snprintf (line, sizeof (line), "%12s %10s %6s %10s  %s", "Events", "Wall (s)", "%", "us/event", "Origin");
+  std::cout << line << std::endl;
+  for (std::vector<Entry>::const_iterator i = entries.begin (); i != entries.end (); ++i)
+    {
+      uint64_t n = i->first->second.events;
+      std::snprintf (line, sizeof (line), "%12llu %10.3f %6.2f %10.3f  ", (unsigned long long)n, i->second,
+                     wall > 0 ? 100.0 * i->second / wall : 0.0, 1e6 * i->second / n);
+      std::cout << line << OriginName (i->first->first) << std::endl;
+    }
+}
+
+void
+CountingScheduler::SetScheduler (TypeId type)
+{
+  NS_ASSERT_MSG (m_scheduler == 0 || m_scheduler->IsEmpty (), "Cannot change the scheduler of a running simulation");
+
+  ObjectFactory factory;
+  factory.SetTypeId (type);
+  m_scheduler = factory.Create<Scheduler> ();
+}
+
+void
+CountingScheduler::SetProfile (bool enable)
+{
+  if (enable && m_profile == 0)
+    {
+      m_profile = new Profile;
+    }
+  else if (!enable)
+    {
+      delete m_profile;
+      m_profile = 0;
+    }
+}
+
+uint64_t
+CountingScheduler::GetNExecuted ()
+{
+  std::lock_guard<std::mutex> lock (g_countersMutex);
+  uint64_t n = s_nExecuted;
+  for (std::set<const CountingScheduler *>::const_iterator i = s_live.begin (); i != s_live.end (); ++i)
+    {
+      n += Load ((*i)->m_nExecuted);
+    }
+  return n;
+}
+
+uint64_t
+CountingScheduler::GetNInserted ()
+{
+  std::lock_guard<std::mutex> lock (g_countersMutex);
+  uint64_t n = s_nInserted;
+  for (std::set<const CountingScheduler *>::const_iterator i = s_live.begin (); i != s_live.end (); ++i)
+    {
+      n += Load ((*i)->m_nInserted);
+    }
+  return n;
+}
+
+uint64_t
+CountingScheduler::GetNRemoved ()
+{
+  std::lock_guard<std::mutex> lock (g_countersMutex);
+  uint64_t n = s_nRemoved;
+  for (std::set<const CountingScheduler *>::const_iterator i = s_live.begin (); i != s_live.end (); ++i)
+    {
+      n += Load ((*i)->m_nRemoved);
+    }
+  return n;
+}
+
+Time
+CountingScheduler::GetLastEventTime ()
+{
+  std::lock_guard<std::mutex> lock (g_countersMutex);
+  uint64_t ts = s_lastTs;
+  for (std::set<const CountingScheduler *>::const_iterator i = s_live.begin (); i != s_live.end (); ++i)
+    {
+      ts = std::max (ts, Load ((*i)->m_lastTs));
+    }
+  return TimeStep (ts);
+}
+
+bool
+CountingScheduler::LookupScheduler (const std::string &name, TypeId *tid)
+{
+  static const char *names[][2] = {
+    { "map", "ns3::MapScheduler" },
+    { "list", "ns3::ListScheduler" },
+    { "heap", "ns3::HeapScheduler" },
+    { "calendar", "ns3::CalendarScheduler" },
+    { "ladder", "ns3::LadderScheduler" },
+  };
+  std::string typeName = name;
+  for (size_t i = 0; i < sizeof (names) / sizeof (names[0]); i++)
+    {
+      if (name == names[i][0])
+        {
+          typeName = names[i][1];
+        }
+    }
+  return TypeId::LookupByNameFailSafe (typeName, tid) && tid->IsChildOf (Scheduler::GetTypeId ());
+}
+
+void
+CountingScheduler::RequestStop ()
+{
+  __atomic_store_n (&s_stopRequested, 1, __ATOMIC_RELAXED);
+}
+
+void
+CountingScheduler::Finish ()
+{
+  std::lock_guard<std::mutex> lock (g_countersMutex);
+  __atomic_store_n (&s_finished, 1, __ATOMIC_RELAXED);
+  for (std::set<const CountingScheduler *>::const_iterator i = s_live.begin (); i != s_live.end (); ++i)
+    {
+      if ((*i)->m_profile != 0)
+        {
+          (*i)->m_profile->End ();
+        }
+    }
+}
+
+void
+CountingScheduler::Insert (const Event &ev)
+{
+  Increment (m_nInserted);
+  m_scheduler->Insert (ev);
+}
+
+// The simulator only calls IsEmpty (), PeekNext () or RemoveNext () after
+// an event has run, which ends its timing
+bool
+CountingScheduler::IsEmpty (void) const
+{
+  if (m_profile != 0)
+    {
+      m_profile->End ();
+    }
+  return m_scheduler->IsEmpty ();
+}
+
+Scheduler::Event
+CountingScheduler::PeekNext (void) const
+{
+  if (m_profile != 0)
+    {
+      m_profile->End ();
+    }
+  return m_scheduler->PeekNext ();
+}
+
+Scheduler::Event
+CountingScheduler::RemoveNext (void)
+{
+  Event ev = m_scheduler->RemoveNext ();
+  // Simulator::Destroy () emptying the queue
+  if (__atomic_load_n (&s_finished, __ATOMIC_RELAXED))
+    {
+      return ev;
+    }
+  Increment (m_nExecuted);
+  __atomic_store_n (&m_lastTs, ev.key.m_ts, __ATOMIC_RELAXED);
+  if (m_profile != 0)
+    {
+      m_profile->Begin (typeid (*ev.impl));
+    }
+  if (__atomic_load_n (&s_stopRequested, __ATOMIC_RELAXED)
+      && __atomic_exchange_n (&s_stopRequested, 0, __ATOMIC_RELAXED))
+    {
+      Simulator::Stop ();
+    }
+  return ev;
+}
+
+void
+CountingScheduler::Remove (const Event &ev)
+{
+  Increment (m_nRemoved);
+  m_scheduler->Remove (ev);
+}
+
+} // namespace ns3
@@ -0,0 +1,171 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COUNTING_SCHEDULER_H
+#define COUNTING_SCHEDULER_H
+
+#include <set>
+#include <string>
+
+#include <ns3-dev/ns3/core-module.h>
+#include <ns3-dev/ns3/scheduler.h>
+
+namespace ns3 {
+
+/**
+ * @brief Scheduler that counts the events going through another scheduler
+ *
+ * Every call is forwarded to the scheduler selected with the "Scheduler"
+ * attribute (ns3::MapScheduler by default), so event order is unchanged.
+ * Install it before the simulation starts:
+ *
+ * @code
+ *   ObjectFactory factory;
+ *   factory.SetTypeId ("ns3::CountingScheduler");
+ *   Simulator::SetScheduler (factory);
+ *   ...
+ *   Simulator::Run ();
+ *   CountingScheduler::Finish ();
+ *   std::cout << CountingScheduler::GetNExecuted () << " events" << std::endl;
+ * @endcode
+ *
+ * Simulator::Destroy () empties the queue with RemoveNext () without
+ * running the events left: Finish (), once Simulator::Run () has returned,
+ * keeps them out of the counts and of the profile.
+ *
+ * Every scheduler counts its own events, so that the partitions of a
+ * parallel simulator each keep a private counter, and the static getters
+ * add them up process-wide.  Totals survive Simulator::Destroy ().
+ *
+ * Only the thread running a scheduler updates its counters, and the getters
+ * may be called from any thread while the simulation runs, e.g. by
+ * ProgressReporter.
+ *
+ * With the "Profile" attribute, every executed event is also timed, from
+ * its removal from the queue to the next call of the simulator into the
+ * queue, and accounted to its origin: the type of its EventImpl, which
+ * names the scheduled function or member function.  When the last
+ * scheduler is destroyed, in Simulator::Destroy (), the origins are printed
+ * by decreasing wall time.  Without the attribute, the cost is one test per
+ * event.
+ *
+ * @code
+ *   ./build/disaster-ccn-scenario1v1 --ns3::CountingScheduler::Profile=true
+ * @endcode
+ */
+class CountingScheduler : public Scheduler
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  CountingScheduler ();
+  virtual ~CountingScheduler ();
+
+  /// @brief Number of events taken out of the queue for execution
+  static uint64_t
+  GetNExecuted ();
+
+  /// @brief Number of events inserted in the queue
+  static uint64_t
+  GetNInserted ();
+
+  /// @brief Number of cancelled events removed from the queue before their time
+  static uint64_t
+  GetNRemoved ();
+
+  /// @brief Time of the latest event taken out of a queue, the simulation time of a running simulation
+  static Time
+  GetLastEventTime ();
+
+  /**
+   * @brief TypeId of the scheduler called @p name, for the "Scheduler" attribute
+   *
+   * @p name is map, list, heap, calendar, ladder (ns3::LadderScheduler) or
+   * the TypeId name of any scheduler.  Returns false if there is no such
+   * scheduler.
+   */
+  static bool
+  LookupScheduler (const std::string &name, TypeId *tid);
+
+  /**
+   * @brief Stop counting and profiling, Simulator::Run () has returned
+   *
+   * The events that Simulator::Destroy () takes out of the queue afterwards
+   * never run.  The next scheduler created counts again.
+   */
+  static void
+  Finish ();
+
+  /**
+   * @brief Stop the simulation before the next event
+   *
+   * May be called from any thread or from a signal handler: the scheduler
+   * calls Simulator::Stop () from the simulation thread when it hands out
+   * the next event, which still runs.
+   */
+  static void
+  RequestStop ();
+
+  virtual void
+  Insert (const Event &ev);
+
+  virtual bool
+  IsEmpty (void) const;
+
+  virtual Event
+  PeekNext (void) const;
+
+  virtual Event
+  RemoveNext (void);
+
+  virtual void
+  Remove (const Event &ev);
+
+private:
+  struct Profile;
+
+  void
+  SetScheduler (TypeId type);
+
+  void
+  SetProfile (bool enable);
+
+  /// @brief Print s_profile by decreasing wall time, with g_countersMutex held
+  static void
+  PrintProfile ();
+
+  Ptr<Scheduler> m_scheduler;
+
+  uint64_t m_nExecuted;
+  uint64_t m_nInserted;
+  uint64_t m_nRemoved;
+  uint64_t m_lastTs;
+  Profile *m_profile; ///< 0 unless profiling
+
+  static uint64_t s_nExecuted; ///< events of destroyed schedulers
+  static uint64_t s_nInserted;
+  static uint64_t s_nRemoved;
+  static uint64_t s_lastTs;
+  static std::set<const CountingScheduler *> s_live;
+  static Profile *s_profile; ///< profiles of destroyed schedulers
+  static int s_stopRequested;
+  static int s_finished;
+};
+
+} // namespace ns3
+
+#endif // COUNTING_SCHEDULER_H
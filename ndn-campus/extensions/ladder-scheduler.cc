@@ -0,0 +1,257 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+// Buckets larger than this are spread over a new rung instead of being
+// sorted into Bottom
+static const uint32_t SPLIT_THRESHOLD = 50;
+static const uint32_t MAX_RUNGS = 8;
+static const uint32_t MAX_BUCKETS = 4096;
+
+// Bottom is sorted by decreasing key, so that the next event is last
+static inline bool
+Later (const Scheduler::Event &a, const Scheduler::Event &b)
+{
+  return b.key < a.key;
+}
+
+static inline bool
+SameEvent (const Scheduler::Event &a, const Scheduler::Event &b)
+{
+  return a.key.m_uid == b.key.m_uid;
+}
+
+TypeId
+LadderScheduler::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .AddConstructor<LadderScheduler> ()
+    ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topStart (0)
+  , m_rungs (MAX_RUNGS)
+  , m_nRungs (0)
+  , m_size (0)
+{
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+}
+
+LadderScheduler::Bucket &
+LadderScheduler::Locate (uint64_t ts)
+{
+  if (ts >= m_topStart)
+    {
+      return m_top;
+    }
+  for (uint32_t r = 0; r < m_nRungs; r++)
+    {
+      Rung &rung = m_rungs[r];
+      if (ts >= rung.start + rung.current * rung.width)
+        {
+          uint64_t bucket = (ts - rung.start) / rung.width;
+          NS_ASSERT (bucket < rung.nBuckets);
+          return rung.buckets[bucket];
+        }
+    }
+  return m_bottom;
+}
+
+void
+LadderScheduler::PushRung (uint64_t start, uint64_t end, Bucket &events)
+{
+  NS_ASSERT (m_nRungs < MAX_RUNGS && end > start && !events.empty ());
+  Rung &rung = m_rungs[m_nRungs++];
+  uint64_t span = end - start;
+  uint64_t n = std::min<uint64_t> (std::min<uint64_t> (events.size (), MAX_BUCKETS), span);
+  rung.start = start;
+  rung.width = (span + n - 1) / n;
+  rung.nBuckets = (span + rung.width - 1) / rung.width;
+  rung.current = 0;
+  if (rung.buckets.size () < rung.nBuckets)
+    {
+      rung.buckets.resize (rung.nBuckets);
+    }
+
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      rung.buckets[(i->key.m_ts - start) / rung.width].push_back (*i);
+    }
+  events.clear ();
+}
+
+void
+LadderScheduler::Refill ()
+{
+  NS_ASSERT (m_bottom.empty () && m_size > 0);
+  while (m_bottom.empty ())
+    {
+      if (m_nRungs == 0)
+        {
+          // The ladder is used up, start a new one with Top
+          NS_ASSERT (!m_top.empty ());
+          uint64_t min = m_top.front ().key.m_ts, max = min;
+          for (Bucket::const_iterator i = m_top.begin (); i != m_top.end (); ++i)
+            {
+              min = std::min (min, i->key.m_ts);
+              max = std::max (max, i->key.m_ts);
+            }
+          PushRung (min, max + 1, m_top);
+          m_topStart = m_rungs[0].start + m_rungs[0].nBuckets * m_rungs[0].width;
+        }
+
+      Rung &rung = m_rungs[m_nRungs - 1];
+      while (rung.current < rung.nBuckets && rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      if (rung.current == rung.nBuckets)
+        {
+          m_nRungs--;
+          continue;
+        }
+
+      Bucket &bucket = rung.buckets[rung.current];
+      uint64_t start = rung.start + rung.current * rung.width;
+      rung.current++;
+      if (bucket.size () > SPLIT_THRESHOLD && rung.width > 1 && m_nRungs < MAX_RUNGS)
+        {
+          PushRung (start, start + rung.width, bucket);
+        }
+      else
+        {
+          // Bottom is empty: swapping keeps the capacity of both vectors
+          m_bottom.swap (bucket);
+          std::sort (m_bottom.begin (), m_bottom.end (), Later);
+        }
+    }
+}
+
+void
+LadderScheduler::SpawnBottom ()
+{
+  // Bottom holds the events before the current bucket of the lowest rung
+  uint64_t end = m_topStart;
+  if (m_nRungs > 0)
+    {
+      const Rung &lowest = m_rungs[m_nRungs - 1];
+      end = lowest.start + lowest.current * lowest.width;
+    }
+  PushRung (m_bottom.back ().key.m_ts, end, m_bottom);
+  Refill ();
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  Bucket &bucket = Locate (ev.key.m_ts);
+  m_size++;
+  if (&bucket == &m_bottom)
+    {
+      // Bottom stays within SPLIT_THRESHOLD events, unless they all share a
+      // time or the ladder is full, so the sorted insertion is O(1)
+      m_bottom.insert (std::upper_bound (m_bottom.begin (), m_bottom.end (), ev, Later), ev);
+      if (m_bottom.size () > SPLIT_THRESHOLD && m_nRungs < MAX_RUNGS
+          && m_bottom.front ().key.m_ts != m_bottom.back ().key.m_ts)
+        {
+          SpawnBottom ();
+        }
+    }
+  else
+    {
+      bucket.push_back (ev);
+    }
+
+  if (m_bottom.empty ())
+    {
+      Refill ();
+    }
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  return m_size == 0;
+}
+
+// Bottom is never empty while the queue is not, see Insert () and Remove ()
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_ASSERT (!IsEmpty ());
+  return m_bottom.back ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_ASSERT (!IsEmpty ());
+  Event ev = m_bottom.back ();
+  m_bottom.pop_back ();
+  m_size--;
+
+  if (m_bottom.empty () && m_size > 0)
+    {
+      Refill ();
+    }
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  Bucket &bucket = Locate (ev.key.m_ts);
+  if (&bucket == &m_bottom)
+    {
+      Bucket::iterator i = std::lower_bound (m_bottom.begin (), m_bottom.end (), ev, Later);
+      NS_ASSERT (i != m_bottom.end () && SameEvent (*i, ev));
+      m_bottom.erase (i);
+    }
+  else
+    {
+      Bucket::iterator i = bucket.begin ();
+      while (i != bucket.end () && !SameEvent (*i, ev))
+        {
+          ++i;
+        }
+      NS_ASSERT (i != bucket.end ());
+      *i = bucket.back ();
+      bucket.pop_back ();
+    }
+  m_size--;
+
+  if (m_bottom.empty () && m_size > 0)
+    {
+      Refill ();
+    }
+}
+
+} // namespace ns3
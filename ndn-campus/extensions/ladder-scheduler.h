@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include <vector>
+
+#include <ns3-dev/ns3/core-module.h>
+#include <ns3-dev/ns3/scheduler.h>
+
+namespace ns3 {
+
+/**
+ * @brief Ladder queue event scheduler
+ *
+ * Ladder queue of Tang, Goh and Thng (ACM TOMACS 15(3), 2005), with
+ * amortized O(1) insertion and removal whatever the distribution of the
+ * event times:
+ *
+ * - Top: unsorted events at or after the end of the ladder, appended in
+ *   O(1), e.g. the periodic events of the tracers and applications
+ * - Ladder: rungs of buckets of equal width, each rung spreading one
+ *   bucket of the rung above over finer buckets; events are appended to
+ *   their bucket in O(1)
+ * - Bottom: the few earliest events, sorted
+ *
+ * When Bottom is empty, the first non-empty bucket of the lowest rung is
+ * sorted into it, or spread over a new rung if it is too large.  When the
+ * ladder is empty, Top becomes its first rung.  Bottom growing too large
+ * from insertions is spread over a new rung as well, which keeps its sorted
+ * insertion in O(1).
+ *
+ * scenarios/scheduler-order checks that it dequeues events in the order of
+ * ns3::MapScheduler, and compares their hold-model speed.  It has not been
+ * run against ns-3 yet.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  LadderScheduler ();
+  virtual ~LadderScheduler ();
+
+  virtual void
+  Insert (const Event &ev);
+
+  virtual bool
+  IsEmpty (void) const;
+
+  virtual Event
+  PeekNext (void) const;
+
+  virtual Event
+  RemoveNext (void);
+
+  virtual void
+  Remove (const Event &ev);
+
+private:
+  typedef std::vector<Event> Bucket;
+
+  struct Rung
+  {
+    uint64_t start;          ///< time of the first bucket
+    uint64_t width;          ///< time span of a bucket
+    uint32_t current;        ///< first bucket that may hold events
+    uint32_t nBuckets;
+    std::vector<Bucket> buckets; ///< at least nBuckets, kept across uses
+  };
+
+  /// @brief Bucket of the ladder or Top or Bottom where @p ts belongs
+  Bucket &
+  Locate (uint64_t ts);
+
+  /// @brief Push rung m_nRungs, covering [start, end), and move @p events into it
+  void
+  PushRung (uint64_t start, uint64_t end, Bucket &events);
+
+  /// @brief Move the earliest events to Bottom, which must be empty
+  void
+  Refill ();
+
+  /// @brief Spread Bottom, grown past SPLIT_THRESHOLD, over a new lowest rung
+  void
+  SpawnBottom ();
+
+  Bucket m_top;
+  uint64_t m_topStart;       ///< end of the ladder, events at or after it go to Top
+  std::vector<Rung> m_rungs; ///< m_nRungs in use, from the coarsest
+  uint32_t m_nRungs;
+  Bucket m_bottom;           ///< sorted by decreasing key, the next event last
+  uint32_t m_size;
+};
+
+} // namespace ns3
+
+#endif // LADDER_SCHEDULER_H
@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "memory-accounting.h"
+#include "memory-usage.h"
+
+#include <sys/time.h>
+#include <fstream>
+#include <sstream>
+
+#include <ns3-dev/ns3/ndnSIM-module.h>
+
+namespace ns3 {
+
+// Per-entry costs besides the name: the entry itself, its node in the
+// name trie and the bookkeeping of the policy and the hash index
+static const uint32_t PIT_ENTRY_BYTES = 400;
+static const uint32_t PIT_FACE_BYTES = 64;    ///< per incoming or outgoing face
+static const uint32_t FIB_ENTRY_BYTES = 300;
+static const uint32_t FIB_FACE_BYTES = 96;    ///< per face metric
+static const uint32_t CS_ENTRY_BYTES = 350;   ///< plus the Data packet
+
+static inline double
+WallClock ()
+{
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  return (double)tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+template<class T>
+static uint64_t
+NameBytes (const T &name)
+{
+  std::ostringstream os;
+  os << name;
+  return os.str ().size ();
+}
+
+MemoryAccounting::MemoryAccounting ()
+  : m_payloadSize (1024)
+  , m_start (WallClock ())
+{
+  m_samples.push_back (Take ("start"));
+}
+
+void
+MemoryAccounting::SetPayloadSize (uint32_t bytes)
+{
+  m_payloadSize = bytes;
+}
+
+MemoryAccounting::Sample
+MemoryAccounting::Take (const std::string &phase) const
+{
+  Sample s;
+  s.phase = phase;
+  s.wall = WallClock () - m_start;
+  s.rss = MemoryUsage::GetCurrentRss ();
+  s.peakRss = MemoryUsage::GetPeakRss ();
+  s.heap = MemoryUsage::GetHeapInUse ();
+  s.allocations = MemoryUsage::GetAllocations ();
+  return s;
+}
+
+void
+MemoryAccounting::Mark (const std::string &phase)
+{
+  m_samples.push_back (Take (phase));
+}
+
+void
+MemoryAccounting::EstimateTables (const NodeContainer &nodes)
+{
+  m_tables.clear ();
+  for (NodeContainer::Iterator n = nodes.Begin (); n != nodes.End (); ++n)
+    {
+      Ptr<ndn::Pit> pit = (*n)->GetObject<ndn::Pit> ();
+      Ptr<ndn::Fib> fib = (*n)->GetObject<ndn::Fib> ();
+      Ptr<ndn::ContentStore> cs = (*n)->GetObject<ndn::ContentStore> ();
+      if (pit == 0 && fib == 0 && cs == 0)
+        {
+          continue;
+        }
+
+      Tables t = { (*n)->GetId (), 0, 0, 0, 0, 0, 0 };
+      if (pit != 0)
+        {
+          for (Ptr<ndn::pit::Entry> entry = pit->Begin (); entry != pit->End (); entry = pit->Next (entry))
+            {
+              t.pitEntries++;
+              t.pitBytes += PIT_ENTRY_BYTES + NameBytes (entry->GetPrefix ())
+                + PIT_FACE_BYTES * (entry->GetIncoming ().size () + entry->GetOutgoing ().size ());
+            }
+        }
+      if (fib != 0)
+        {
+          for (Ptr<const ndn::fib::Entry> entry = fib->Begin (); entry != fib->End (); entry = fib->Next (entry))
+            {
+              t.fibEntries++;
+              t.fibBytes += FIB_ENTRY_BYTES + NameBytes (entry->GetPrefix ())
+                + FIB_FACE_BYTES * entry->m_faces.size ();
+            }
+        }
+      if (cs != 0)
+        {
+          // Names of cached Data are as long as the PIT ones, which are
+          // not known here: count them in the entry cost
+          t.csEntries = cs->GetSize ();
+          t.csBytes = static_cast<uint64_t> (t.csEntries) * (CS_ENTRY_BYTES + m_payloadSize);
+        }
+      m_tables.push_back (t);
+    }
+}
+
+void
+MemoryAccounting::Print (std::ostream &os) const
+{
+  for (uint32_t i = 1; i < m_samples.size (); i++)
+    {
+      const Sample &s = m_samples[i], &prev = m_samples[i - 1];
+      os << "Memory after " << s.phase << ": RSS " << s.rss / 1048576.0 << " MB ("
+         << ((double)s.rss - prev.rss) / 1048576.0 << " MB), heap "
+         << ((double)s.heap - prev.heap) / 1048576.0 << " MB, "
+         << s.allocations - prev.allocations << " allocations, peak RSS "
+         << s.peakRss / 1048576.0 << " MB" << std::endl;
+    }
+
+  if (m_tables.empty ())
+    {
+      return;
+    }
+  uint64_t pit = 0, fib = 0, cs = 0;
+  for (std::vector<Tables>::const_iterator t = m_tables.begin (); t != m_tables.end (); ++t)
+    {
+      pit += t->pitBytes;
+      fib += t->fibBytes;
+      cs += t->csBytes;
+    }
+  os << "NDN tables (estimate) on " << m_tables.size () << " nodes: PIT " << pit / 1048576.0
+     << " MB, FIB " << fib / 1048576.0 << " MB, CS " << cs / 1048576.0 << " MB" << std::endl;
+}
+
+void
+MemoryAccounting::Write (const std::string &file) const
+{
+  std::ofstream os (file.c_str ());
+  os << "Phase\tWall\tRss\tRssDelta\tPeakRss\tHeapDelta\tAllocations" << std::endl;
+  for (uint32_t i = 1; i < m_samples.size (); i++)
+    {
+      const Sample &s = m_samples[i], &prev = m_samples[i - 1];
+      os << s.phase << "\t" << s.wall << "\t" << s.rss << "\t" << (int64_t)(s.rss - prev.rss) << "\t"
+         << s.peakRss << "\t" << (int64_t)(s.heap - prev.heap) << "\t"
+         << s.allocations - prev.allocations << std::endl;
+    }
+
+  os << std::endl << "Node\tPitEntries\tPitBytes\tFibEntries\tFibBytes\tCsEntries\tCsBytes" << std::endl;
+  for (std::vector<Tables>::const_iterator t = m_tables.begin (); t != m_tables.end (); ++t)
+    {
+      os << t->node << "\t" << t->pitEntries << "\t" << t->pitBytes << "\t" << t->fibEntries << "\t"
+         << t->fibBytes << "\t" << t->csEntries << "\t" << t->csBytes << std::endl;
+    }
+}
+
+} // namespace ns3
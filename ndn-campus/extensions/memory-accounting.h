@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <ns3-dev/ns3/core-module.h>
+#include <ns3-dev/ns3/network-module.h>
+
+namespace ns3 {
+
+/**
+ * @brief Memory used by each phase of a scenario and by the NDN tables
+ *
+ * Mark () closes a phase of the scenario main and records the resident
+ * set size, the peak RSS, the heap in use and the allocation count at that
+ * point (see MemoryUsage); Print () and Write () report them together
+ * with their growth during the phase.
+ *
+ * EstimateTables () sizes the PIT, FIB and content store of every node
+ * from their entries: the per-entry costs are estimates of the ndnSIM
+ * containers, not measurements, but they tell which table grows with
+ * the topology.
+ *
+ * @code
+ *   MemoryAccounting memory;
+ *   topology.Build (nCN);
+ *   memory.Mark ("topology");
+ *   ndnHelper.InstallAll ();
+ *   memory.Mark ("ndn-stack");
+ *   ...
+ *   Simulator::Run ();
+ *   memory.Mark ("run");
+ *   memory.EstimateTables (NodeContainer::GetGlobal ());
+ *   memory.Write ("results/memory.txt");
+ * @endcode
+ */
+class MemoryAccounting
+{
+public:
+  MemoryAccounting ();
+
+  /// @brief Bytes of the Data packets in the content stores [1024]
+  void
+  SetPayloadSize (uint32_t bytes);
+
+  /// @brief Record the end of @p phase, which started at the previous mark or at construction
+  void
+  Mark (const std::string &phase);
+
+  /// @brief Estimate the PIT, FIB and content store bytes of every node of @p nodes with an NDN stack
+  void
+  EstimateTables (const NodeContainer &nodes);
+
+  /// @brief Print the phases and the totals of the NDN tables
+  void
+  Print (std::ostream &os) const;
+
+  /// @brief Write the phases, then the tables of every node, as whitespace-separated columns
+  void
+  Write (const std::string &file) const;
+
+private:
+  struct Sample
+  {
+    std::string phase;
+    double wall;            ///< seconds since construction
+    uint64_t rss;
+    uint64_t peakRss;
+    uint64_t heap;
+    uint64_t allocations;
+  };
+
+  struct Tables
+  {
+    uint32_t node;
+    uint32_t pitEntries;
+    uint64_t pitBytes;
+    uint32_t fibEntries;
+    uint64_t fibBytes;
+    uint32_t csEntries;
+    uint64_t csBytes;
+  };
+
+  Sample
+  Take (const std::string &phase) const;
+
+  uint32_t m_payloadSize;
+  double m_start;
+  std::vector<Sample> m_samples;   ///< starts with the construction
+  std::vector<Tables> m_tables;
+};
+
+} // namespace ns3
+
+#endif // MEMORY_ACCOUNTING_H
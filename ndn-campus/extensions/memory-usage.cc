@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "memory-usage.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+static uint64_t g_allocations = 0;
+
+// Counting replacements of the global allocation functions: one relaxed
+// atomic increment per allocation, from any simulator thread
+void *
+operator new (std::size_t size)
+{
+  __atomic_fetch_add (&g_allocations, 1, __ATOMIC_RELAXED);
+  for (;;)
+    {
+      void *p = std::malloc (size > 0 ? size : 1);
+      if (p != 0)
+        {
+          return p;
+        }
+      std::new_handler handler = std::get_new_handler ();
+      if (handler == 0)
+        {
+          throw std::bad_alloc ();
+        }
+      handler ();
+    }
+}
+
+void *
+operator new[] (std::size_t size)
+{
+  return ::operator new (size);
+}
+
+void
+operator delete (void *p) noexcept
+{
+  std::free (p);
+}
+
+void
+operator delete[] (void *p) noexcept
+{
+  std::free (p);
+}
+
+namespace ns3 {
+
+uint64_t
+MemoryUsage::GetCurrentRss ()
+{
+  // Second field of statm is the number of resident pages
+  std::ifstream statm ("/proc/self/statm");
+  uint64_t size = 0, resident = 0;
+  if (!(statm >> size >> resident))
+    {
+      return 0;
+    }
+  return resident * sysconf (_SC_PAGESIZE);
+}
+
+uint64_t
+MemoryUsage::GetPeakRss ()
+{
+  struct rusage usage;
+  if (getrusage (RUSAGE_SELF, &usage) != 0)
+    {
+      return 0;
+    }
+#ifdef __APPLE__
+  return usage.ru_maxrss;
+#else
+  return static_cast<uint64_t> (usage.ru_maxrss) * 1024;
+#endif
+}
+
+uint64_t
+MemoryUsage::GetHeapInUse ()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+  struct mallinfo2 info = mallinfo2 ();
+  return info.uordblks + info.hblkhd;
+#elif defined(__GLIBC__)
+  // Wraps around at 4 GB
+  struct mallinfo info = mallinfo ();
+  return static_cast<uint32_t> (info.uordblks) + static_cast<uint32_t> (info.hblkhd);
+#else
+  return 0;
+#endif
+}
+
+uint64_t
+MemoryUsage::GetAllocations ()
+{
+  return __atomic_load_n (&g_allocations, __ATOMIC_RELAXED);
+}
+
+} // namespace ns3
@@ -0,0 +1,53 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include <ns3-dev/ns3/core-module.h>
+
+namespace ns3 {
+
+/**
+ * @brief Resident memory of the simulation process
+ *
+ * Values are in bytes, 0 when the platform does not report them.
+ * Allocations are counted by the global operator new of the extensions,
+ * which every scenario links.
+ */
+class MemoryUsage
+{
+public:
+  /// @brief Current resident set size
+  static uint64_t
+  GetCurrentRss ();
+
+  /// @brief Largest resident set size since the process started
+  static uint64_t
+  GetPeakRss ();
+
+  /// @brief Bytes allocated from the heap and not freed yet
+  static uint64_t
+  GetHeapInUse ();
+
+  /// @brief Calls to operator new since the process started
+  static uint64_t
+  GetAllocations ();
+};
+
+} // namespace ns3
+
+#endif // MEMORY_USAGE_H
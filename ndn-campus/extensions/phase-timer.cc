@@ -0,0 +1,209 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "phase-timer.h"
+#include "counting-scheduler.h"
+
+#include <sys/time.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <cstdio>
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE ("PhaseTimer");
+
+namespace ns3 {
+
+static inline double
+WallClock ()
+{
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  return (double)tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+static inline double
+CpuClock ()
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static std::string
+JsonString (const std::string &s)
+{
+  std::ostringstream os;
+  os << '"';
+  for (std::string::const_iterator c = s.begin (); c != s.end (); ++c)
+    {
+      if (*c == '"' || *c == '\\')
+        {
+          os << '\\' << *c;
+        }
+      else if (static_cast<unsigned char> (*c) < 0x20)
+        {
+          char escaped[8];
+          sprintf (escaped, "\\u%04x", *c);
+          os << escaped;
+        }
+      else
+        {
+          os << *c;
+        }
+    }
+  os << '"';
+  return os.str ();
+}
+
+PhaseTimer::PhaseTimer (const std::string &scenario, int argc, char *argv[])
+  : m_scenario (scenario)
+  , m_startWall (WallClock ())
+  , m_cpu (0)
+  , m_lastCpu (CpuClock ())
+  , m_startEvents (CountingScheduler::GetNExecuted ())
+  , m_startTime (time (0))
+  , m_running (false)
+  , m_phaseWall (0)
+  , m_phaseCpu (0)
+  , m_phaseEvents (0)
+{
+  for (int i = 1; i < argc; i++)
+    {
+      m_args.push_back (argv[i]);
+    }
+}
+
+void
+PhaseTimer::Start (const std::string &phase)
+{
+  Stop ();
+  Phase p;
+  p.name = phase;
+  p.wall = 0;
+  p.cpu = 0;
+  p.events = 0;
+  m_phases.push_back (p);
+  m_running = true;
+  m_phaseWall = WallClock ();
+  m_phaseCpu = GetCpu ();
+  m_phaseEvents = CountingScheduler::GetNExecuted ();
+}
+
+void
+PhaseTimer::Stop ()
+{
+  if (!m_running)
+    {
+      return;
+    }
+  Phase &p = m_phases.back ();
+  p.wall = WallClock () - m_phaseWall;
+  p.cpu = GetCpu () - m_phaseCpu;
+  p.events = CountingScheduler::GetNExecuted () - m_phaseEvents;
+  m_running = false;
+}
+
+double
+PhaseTimer::GetCpu () const
+{
+  // The CPU clock of a forked process starts again from 0
+  double now = CpuClock ();
+  m_cpu += now >= m_lastCpu ? now - m_lastCpu : now;
+  m_lastCpu = now;
+  return m_cpu;
+}
+
+double
+PhaseTimer::GetWall (const std::string &phase) const
+{
+  double wall = 0;
+  for (std::vector<Phase>::const_iterator p = m_phases.begin (); p != m_phases.end (); ++p)
+    {
+      if (p->name == phase)
+        {
+          wall += p->wall;
+        }
+    }
+  return wall;
+}
+
+double
+PhaseTimer::GetElapsed () const
+{
+  return WallClock () - m_startWall;
+}
+
+void
+PhaseTimer::Print (std::ostream &os) const
+{
+  for (std::vector<Phase>::const_iterator p = m_phases.begin (); p != m_phases.end (); ++p)
+    {
+      os << "Phase " << p->name << ": " << p->wall << " s wall, " << p->cpu << " s CPU";
+      if (p->events > 0)
+        {
+          os << ", " << p->events << " events";
+        }
+      os << std::endl;
+    }
+}
+
+void
+PhaseTimer::Write (const std::string &file) const
+{
+  std::ostringstream os;
+  os << "{\"scenario\": " << JsonString (m_scenario) << ", \"args\": [";
+  for (uint32_t i = 0; i < m_args.size (); i++)
+    {
+      os << (i > 0 ? ", " : "") << JsonString (m_args[i]);
+    }
+  os << "], \"start\": " << m_startTime << ", \"phases\": [";
+  for (uint32_t i = 0; i < m_phases.size (); i++)
+    {
+      const Phase &p = m_phases[i];
+      os << (i > 0 ? ", " : "") << "{\"name\": " << JsonString (p.name) << ", \"wall\": " << p.wall
+         << ", \"cpu\": " << p.cpu << ", \"events\": " << p.events << "}";
+    }
+  os << "], \"wall\": " << WallClock () - m_startWall << ", \"cpu\": " << GetCpu ()
+     << ", \"events\": " << CountingScheduler::GetNExecuted () - m_startEvents << "}\n";
+
+  // One write () with O_APPEND, so that concurrent runs of a sweep do not
+  // interleave their records
+  std::string record = os.str ();
+  int fd = open (file.c_str (), O_WRONLY | O_APPEND | O_CREAT, 0644);
+  if (fd < 0 || write (fd, record.data (), record.size ()) != (ssize_t) record.size ())
+    {
+      NS_LOG_ERROR ("Cannot append the phase timings to " << file);
+    }
+  if (fd >= 0)
+    {
+      close (fd);
+    }
+}
+
+PhaseTimer::Scope::Scope (PhaseTimer &timer, const std::string &phase)
+  : m_timer (timer)
+{
+  m_timer.Start (phase);
+}
+
+PhaseTimer::Scope::~Scope ()
+{
+  m_timer.Stop ();
+}
+
+} // namespace ns3
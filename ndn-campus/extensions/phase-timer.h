@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PHASE_TIMER_H
+#define PHASE_TIMER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <ns3-dev/ns3/core-module.h>
+
+namespace ns3 {
+
+/**
+ * @brief Wall-clock time, CPU time and events of the phases of a scenario
+ *
+ * The timer starts when it is constructed, at the top of the scenario
+ * main.  Start () opens a phase and closes the previous one, Stop () closes
+ * the current phase, and a Scope does both for a block.  Events are
+ * counted by CountingScheduler, the scheduler of every scenario; CPU time
+ * includes every thread of the process, and carries over to the processes
+ * forked by SeedForker.
+ *
+ * Write () appends one JSON record per run to a file shared by all the
+ * runs of a sweep, which run.py aggregates:
+ *
+ * @code
+ *   {"scenario": "disaster-tcp", "args": ["--networks=3"], "start": 1371020400,
+ *    "phases": [{"name": "topology", "wall": 1.2, "cpu": 1.19, "events": 0}, ...],
+ *    "wall": 35.2, "cpu": 35.0, "events": 4200000}
+ * @endcode
+ *
+ * @code
+ *   PhaseTimer timer ("disaster-tcp", argc, argv);
+ *   timer.Start ("topology");
+ *   topology.Build (3);
+ *   timer.Start ("routing");
+ *   Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+ *   {
+ *     PhaseTimer::Scope run (timer, "run");
+ *     Simulator::Run ();
+ *   }
+ *   timer.Start ("teardown");
+ *   Simulator::Destroy ();
+ *   timer.Stop ();
+ *   timer.Write ("results/timings.jsonl");
+ * @endcode
+ */
+class PhaseTimer
+{
+public:
+  /// @brief Start timing the run of @p scenario, recorded with its command line arguments
+  PhaseTimer (const std::string &scenario, int argc, char *argv[]);
+
+  /// @brief Start @p phase, ending the current phase if any
+  void
+  Start (const std::string &phase);
+
+  /// @brief End the current phase if any
+  void
+  Stop ();
+
+  /// @brief Wall-clock seconds of @p phase, added up if it ran several times
+  double
+  GetWall (const std::string &phase) const;
+
+  /// @brief Wall-clock seconds since construction
+  double
+  GetElapsed () const;
+
+  /// @brief Print the wall and CPU time of every phase
+  void
+  Print (std::ostream &os) const;
+
+  /// @brief Append the record of the run to @p file, as one line of JSON
+  void
+  Write (const std::string &file) const;
+
+  /// @brief Phase that lasts as long as the enclosing block
+  class Scope
+  {
+  public:
+    Scope (PhaseTimer &timer, const std::string &phase);
+    ~Scope ();
+
+  private:
+    Scope (const Scope &);
+    Scope &
+    operator= (const Scope &);
+
+    PhaseTimer &m_timer;
+  };
+
+private:
+  /// @brief CPU seconds of the process since construction
+  double
+  GetCpu () const;
+
+  struct Phase
+  {
+    std::string name;
+    double wall;
+    double cpu;
+    uint64_t events;
+  };
+
+  std::string m_scenario;
+  std::vector<std::string> m_args;
+  double m_startWall;
+  mutable double m_cpu;       ///< CPU seconds up to m_lastCpu
+  mutable double m_lastCpu;   ///< CPU clock when m_cpu was last updated
+  uint64_t m_startEvents;
+  long m_startTime;     ///< Unix time, tells the runs of a sweep apart
+
+  std::vector<Phase> m_phases;
+  bool m_running;           ///< whether the last phase is still open
+  double m_phaseWall;       ///< when the open phase started
+  double m_phaseCpu;
+  uint64_t m_phaseEvents;
+};
+
+} // namespace ns3
+
+#endif // PHASE_TIMER_H
@@ -0,0 +1,184 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "progress-reporter.h"
+#include "counting-scheduler.h"
+#include "memory-usage.h"
+
+#include <sys/time.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+NS_LOG_COMPONENT_DEFINE ("ProgressReporter");
+
+namespace ns3 {
+
+static inline double
+WallClock ()
+{
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  return (double)tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+struct ProgressReporter::Thread
+{
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable wakeup;
+  bool stop;
+  std::ofstream output;
+};
+
+ProgressReporter::ProgressReporter ()
+  : m_interval (10.0)
+  , m_thread (0)
+  , m_start (0.0)
+  , m_events0 (0)
+  , m_lastWall (0.0)
+  , m_lastSim (0.0)
+  , m_lastEvents (0)
+{
+}
+
+ProgressReporter::~ProgressReporter ()
+{
+  Stop ();
+}
+
+void
+ProgressReporter::SetInterval (double seconds)
+{
+  m_interval = seconds;
+}
+
+void
+ProgressReporter::SetOutput (const std::string &file)
+{
+  m_output = file;
+}
+
+void
+ProgressReporter::Start (Time stopTime)
+{
+  NS_ASSERT_MSG (m_thread == 0, "Progress reporter already started");
+  if (m_interval <= 0)
+    {
+      return;
+    }
+
+  m_stopTime = stopTime;
+  m_start = m_lastWall = WallClock ();
+  m_lastSim = CountingScheduler::GetLastEventTime ().GetSeconds ();
+  m_events0 = m_lastEvents = CountingScheduler::GetNExecuted ();
+
+  m_thread = new Thread;
+  m_thread->stop = false;
+  if (!m_output.empty ())
+    {
+      m_thread->output.open (m_output.c_str ());
+      if (!m_thread->output)
+        {
+          NS_LOG_ERROR ("Cannot open progress file " << m_output);
+        }
+      m_thread->output << "Wall\tSimTime\tEvents\tEventsPerSec\tSimRate\tRssMB" << std::endl;
+    }
+  m_thread->thread = std::thread (&ProgressReporter::Run, this);
+}
+
+void
+ProgressReporter::Stop ()
+{
+  if (m_thread == 0)
+    {
+      return;
+    }
+
+  {
+    std::lock_guard<std::mutex> lock (m_thread->mutex);
+    m_thread->stop = true;
+  }
+  m_thread->wakeup.notify_one ();
+  m_thread->thread.join ();
+
+  // The end of the run, for the time series only: the scenario prints its
+  // own runtime stats
+  Sample (false);
+
+  delete m_thread;
+  m_thread = 0;
+}
+
+void
+ProgressReporter::Run ()
+{
+  std::unique_lock<std::mutex> lock (m_thread->mutex);
+  std::chrono::duration<double> interval (m_interval);
+  while (!m_thread->wakeup.wait_for (lock, interval, [this] { return m_thread->stop; }))
+    {
+      Sample (true);
+    }
+}
+
+void
+ProgressReporter::Sample (bool print)
+{
+  double wall = WallClock ();
+  double sim = CountingScheduler::GetLastEventTime ().GetSeconds ();
+  uint64_t events = CountingScheduler::GetNExecuted ();
+  double rss = MemoryUsage::GetCurrentRss () / 1048576.0;
+
+  double elapsed = wall - m_lastWall;
+  double simRate = elapsed > 0 ? (sim - m_lastSim) / elapsed : 0.0;
+  double eventRate = elapsed > 0 ? (events - m_lastEvents) / elapsed : 0.0;
+  m_lastWall = wall;
+  m_lastSim = sim;
+  m_lastEvents = events;
+
+  if (print)
+    {
+      double stop = m_stopTime.GetSeconds ();
+      char line[256];
+      int n = std::snprintf (line, sizeof (line), "Progress: %.1f", sim);
+      if (stop > 0)
+        {
+          n += std::snprintf (line + n, sizeof (line) - n, "/%g s (%.1f%%)", stop, 100.0 * sim / stop);
+        }
+      else
+        {
+          n += std::snprintf (line + n, sizeof (line) - n, " s");
+        }
+      n += std::snprintf (line + n, sizeof (line) - n, ", %.3g sim s/s, %.0f events/s, RSS %.0f MB",
+                          simRate, eventRate, rss);
+      if (stop > 0 && simRate > 0)
+        {
+          std::snprintf (line + n, sizeof (line) - n, ", ETA %.0f s", (stop - sim) / simRate);
+        }
+      std::cout << line << std::endl;
+    }
+
+  if (m_thread->output.is_open ())
+    {
+      m_thread->output << wall - m_start << "\t" << sim << "\t" << events - m_events0 << "\t"
+                       << eventRate << "\t" << simRate << "\t" << rss << std::endl;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PROGRESS_REPORTER_H
+#define PROGRESS_REPORTER_H
+
+#include <string>
+
+#include <ns3-dev/ns3/core-module.h>
+
+namespace ns3 {
+
+/**
+ * @brief Wall-clock progress reports of a running simulation
+ *
+ * A background thread wakes up every SetInterval () wall-clock seconds and
+ * samples the simulation time, the number of executed events and the
+ * resident memory; nothing is scheduled in the simulator.  Each sample is
+ * printed as
+ *
+ *   Progress: 12.5/60 s (20.8%), 0.42 sim s/s, 153210 events/s, RSS 812 MB, ETA 113 s
+ *
+ * where rates are measured over the last interval, and appended to the
+ * SetOutput () file, if any, with the columns
+ *
+ *   Wall SimTime Events EventsPerSec SimRate RssMB
+ *
+ * so that slowdowns of long runs can be plotted.  Simulation time and
+ * events come from CountingScheduler, which must be the scheduler of the
+ * simulation.
+ *
+ * @code
+ *   ProgressReporter progress;
+ *   progress.SetOutput ("results/progress.txt");
+ *   progress.Start (Seconds (stopTime));
+ *   Simulator::Run ();
+ *   progress.Stop ();
+ * @endcode
+ */
+class ProgressReporter
+{
+public:
+  ProgressReporter ();
+
+  /// @brief Calls Stop ()
+  ~ProgressReporter ();
+
+  /// @brief Wall-clock seconds between samples, 0 to disable the reporter [10]
+  void
+  SetInterval (double seconds);
+
+  /// @brief Time series file, truncated by Start (), none if empty [""]
+  void
+  SetOutput (const std::string &file);
+
+  /// @brief Start the reporting thread, for a simulation stopping at @p stopTime (0 if unknown)
+  void
+  Start (Time stopTime);
+
+  /// @brief Write a last sample to the time series and join the thread
+  void
+  Stop ();
+
+private:
+  ProgressReporter (const ProgressReporter &);
+  ProgressReporter &
+  operator= (const ProgressReporter &);
+
+  struct Thread;
+
+  /// @brief Reporting thread body
+  void
+  Run ();
+
+  /// @brief Take a sample, printed only if @p print
+  void
+  Sample (bool print);
+
+  double m_interval;
+  std::string m_output;
+  Time m_stopTime;
+  Thread *m_thread;
+
+  double m_start;        ///< wall clock of Start ()
+  uint64_t m_events0;    ///< events executed before Start ()
+  double m_lastWall;     ///< previous sample, for the rates
+  double m_lastSim;
+  uint64_t m_lastEvents;
+};
+
+} // namespace ns3
+
+#endif // PROGRESS_REPORTER_H
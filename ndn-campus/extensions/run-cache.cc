@@ -0,0 +1,349 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "run-cache.h"
+
+#include <sys/stat.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <link.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE ("RunCache");
+
+namespace ns3 {
+
+// FNV-1a
+static inline void
+HashBytes (uint64_t &hash, const void *data, size_t size)
+{
+  const unsigned char *p = static_cast<const unsigned char *> (data);
+  for (size_t i = 0; i < size; ++i)
+    {
+      hash = (hash ^ p[i]) * 1099511628211ULL;
+    }
+}
+
+// With the terminating NUL, so that "ab" "c" and "a" "bc" differ
+static inline void
+HashString (uint64_t &hash, const std::string &s)
+{
+  HashBytes (hash, s.c_str (), s.size () + 1);
+}
+
+// HashBytes () of the contents of @p file, false if it cannot be read
+static bool
+HashFile (const std::string &file, uint64_t *hash)
+{
+  std::ifstream is (file.c_str (), std::ios::binary);
+  if (!is)
+    {
+      return false;
+    }
+  *hash = 14695981039346656037ULL;
+  char buffer[65536];
+  do
+    {
+      is.read (buffer, sizeof (buffer));
+      HashBytes (*hash, buffer, is.gcount ());
+    }
+  while (is);
+  return !is.bad ();
+}
+
+static std::string
+HexString (uint64_t value)
+{
+  char hex[20];
+  sprintf (hex, "%016llx", (unsigned long long) value);
+  return hex;
+}
+
+struct BuildIds
+{
+  uint64_t hash;
+  uint32_t count;
+};
+
+// Hashes the NT_GNU_BUILD_ID note of every loaded object, in load order
+static int
+HashBuildId (struct dl_phdr_info *info, size_t size, void *data)
+{
+  BuildIds *ids = static_cast<BuildIds *> (data);
+  for (int i = 0; i < info->dlpi_phnum; i++)
+    {
+      const ElfW(Phdr) &phdr = info->dlpi_phdr[i];
+      if (phdr.p_type != PT_NOTE)
+        {
+          continue;
+        }
+      const char *p = reinterpret_cast<const char *> (info->dlpi_addr + phdr.p_vaddr);
+      const char *end = p + phdr.p_memsz;
+      while (p + sizeof (ElfW(Nhdr)) <= end)
+        {
+          const ElfW(Nhdr) *note = reinterpret_cast<const ElfW(Nhdr) *> (p);
+          const char *name = p + sizeof (ElfW(Nhdr));
+          const char *desc = name + ((note->n_namesz + 3) & ~3);
+          if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4
+              && memcmp (name, "GNU", 4) == 0 && desc + note->n_descsz <= end)
+            {
+              HashBytes (ids->hash, desc, note->n_descsz);
+              ids->count++;
+            }
+          p = desc + ((note->n_descsz + 3) & ~3);
+        }
+    }
+  return 0;
+}
+
+RunCache::RunCache (const std::string &scenario, int argc, char *argv[])
+  : m_scenario (scenario)
+  , m_manifest ("results/run-cache.txt")
+{
+  for (int i = 1; i < argc; i++)
+    {
+      m_args.push_back (argv[i]);
+    }
+}
+
+void
+RunCache::SetManifest (const std::string &file)
+{
+  m_manifest = file;
+}
+
+void
+RunCache::Ignore (const std::string &option)
+{
+  m_ignored.insert (option);
+}
+
+std::string
+RunCache::GetOptions () const
+{
+  // Global values are hashed with their current value, which for RngRun
+  // may come from SeedForker rather than from the command line
+  std::set<std::string> globals;
+  for (GlobalValue::Iterator i = GlobalValue::Begin (); i != GlobalValue::End (); ++i)
+    {
+      globals.insert ((*i)->GetName ());
+    }
+
+  std::map<std::string, std::string> options;
+  for (uint32_t i = 0; i < m_args.size (); i++)
+    {
+      std::string arg = m_args[i];
+      std::string::size_type start = arg.find_first_not_of ('-');
+      if (start == std::string::npos || start == 0)
+        {
+          continue;
+        }
+      std::string::size_type eq = arg.find ('=', start);
+      std::string name = arg.substr (start, eq == std::string::npos ? std::string::npos : eq - start);
+      std::string value = eq == std::string::npos ? "" : arg.substr (eq + 1);
+      // Attributes are hashed with their initial value
+      if (name.find ("::") != std::string::npos || globals.count (name) || m_ignored.count (name))
+        {
+          continue;
+        }
+      options[name] = value;
+    }
+
+  std::ostringstream os;
+  for (std::map<std::string, std::string>::const_iterator i = options.begin (); i != options.end (); ++i)
+    {
+      os << (i == options.begin () ? "" : " ") << i->first << "=" << i->second;
+    }
+  return os.str ();
+}
+
+void
+RunCache::AddInput (const std::string &file)
+{
+  m_inputs.push_back (file);
+}
+
+uint64_t
+RunCache::GetKey () const
+{
+  uint64_t hash = 14695981039346656037ULL;
+  HashString (hash, m_scenario);
+  HashString (hash, GetOptions ());
+
+  for (uint32_t i = 0; i < TypeId::GetRegisteredN (); i++)
+    {
+      TypeId tid = TypeId::GetRegistered (i);
+      for (uint32_t j = 0; j < tid.GetAttributeN (); j++)
+        {
+          struct TypeId::AttributeInformation info = tid.GetAttribute (j);
+          HashString (hash, tid.GetName ());
+          HashString (hash, info.name);
+          HashString (hash, info.initialValue->SerializeToString (info.checker));
+        }
+    }
+
+  for (GlobalValue::Iterator i = GlobalValue::Begin (); i != GlobalValue::End (); ++i)
+    {
+      Ptr<const AttributeChecker> checker = (*i)->GetChecker ();
+      Ptr<AttributeValue> value = checker->Create ();
+      (*i)->GetValue (*value);
+      HashString (hash, (*i)->GetName ());
+      HashString (hash, value->SerializeToString (checker));
+    }
+
+  for (uint32_t i = 0; i < m_inputs.size (); i++)
+    {
+      std::ifstream is (m_inputs[i].c_str (), std::ios::binary);
+      std::ostringstream contents;
+      contents << is.rdbuf ();
+      HashString (hash, m_inputs[i]);
+      HashString (hash, is ? contents.str () : std::string ());
+    }
+
+  BuildIds ids;
+  ids.hash = hash;
+  ids.count = 0;
+  dl_iterate_phdr (&HashBuildId, &ids);
+  hash = ids.hash;
+  // Linked without --build-id: a rebuilt program has another size or time
+  if (ids.count == 0)
+    {
+      struct stat st;
+      if (stat ("/proc/self/exe", &st) == 0)
+        {
+          HashBytes (hash, &st.st_size, sizeof (st.st_size));
+          HashBytes (hash, &st.st_mtime, sizeof (st.st_mtime));
+        }
+    }
+  return hash;
+}
+
+std::string
+RunCache::GetKeyString () const
+{
+  return HexString (GetKey ());
+}
+
+bool
+RunCache::Lookup ()
+{
+  m_hit.clear ();
+  std::string key = GetKeyString ();
+  std::ifstream manifest (m_manifest.c_str ());
+  std::string line;
+  std::vector<std::string> entry;
+  while (std::getline (manifest, line))
+    {
+      if (line.compare (0, key.size () + 1, key + "\t") != 0)
+        {
+          continue;
+        }
+      // The last entry of the key is the latest run
+      entry.clear ();
+      std::istringstream fields (line);
+      std::string field;
+      while (std::getline (fields, field, '\t'))
+        {
+          entry.push_back (field);
+        }
+    }
+  if (entry.size () < 4)
+    {
+      return false;
+    }
+
+  std::vector<std::string> files;
+  for (uint32_t i = 3; i < entry.size (); i++)
+    {
+      // size:hash:file, entries without the hash predate it and miss
+      std::string::size_type colon = entry[i].find (':');
+      std::string::size_type colon2 = colon == std::string::npos ? colon : entry[i].find (':', colon + 1);
+      if (colon2 == std::string::npos)
+        {
+          return false;
+        }
+      std::string file = entry[i].substr (colon2 + 1);
+      // The size first, it is cheaper
+      struct stat st;
+      uint64_t hash;
+      if (stat (file.c_str (), &st) != 0
+          || (long long) st.st_size != atoll (entry[i].substr (0, colon).c_str ())
+          || !HashFile (file, &hash)
+          || HexString (hash) != entry[i].substr (colon + 1, colon2 - colon - 1))
+        {
+          NS_LOG_INFO ("Cached run " << key << " lost " << file);
+          return false;
+        }
+      files.push_back (file);
+    }
+  m_hit = files;
+  return true;
+}
+
+void
+RunCache::PrintHit (std::ostream &os) const
+{
+  os << "Cached run " << GetKeyString () << " of " << m_scenario << ", results in:" << std::endl;
+  for (uint32_t i = 0; i < m_hit.size (); i++)
+    {
+      os << "  " << m_hit[i] << std::endl;
+    }
+}
+
+void
+RunCache::AddOutput (const std::string &file)
+{
+  m_outputs.push_back (file);
+}
+
+void
+RunCache::Commit () const
+{
+  std::ostringstream os;
+  os << GetKeyString () << "\t" << m_scenario << "\t" << GetOptions ();
+  for (uint32_t i = 0; i < m_outputs.size (); i++)
+    {
+      struct stat st;
+      uint64_t hash;
+      if (stat (m_outputs[i].c_str (), &st) != 0 || !HashFile (m_outputs[i], &hash))
+        {
+          NS_LOG_ERROR ("Not caching the run, " << m_outputs[i] << " is missing");
+          return;
+        }
+      os << "\t" << (long long) st.st_size << ":" << HexString (hash) << ":" << m_outputs[i];
+    }
+  os << "\n";
+
+  // One write () with O_APPEND, as for the phase timings
+  std::string record = os.str ();
+  int fd = open (m_manifest.c_str (), O_WRONLY | O_APPEND | O_CREAT, 0644);
+  if (fd < 0 || write (fd, record.data (), record.size ()) != (ssize_t) record.size ())
+    {
+      NS_LOG_ERROR ("Cannot append the run to " << m_manifest);
+    }
+  if (fd >= 0)
+    {
+      close (fd);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RUN_CACHE_H
+#define RUN_CACHE_H
+
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <ns3-dev/ns3/core-module.h>
+
+namespace ns3 {
+
+/**
+ * @brief Skips the runs whose results are already there
+ *
+ * The key of a run hashes everything its results depend on:
+ *
+ * - the scenario name and its command line options, sorted, the last
+ *   value of an option winning,
+ * - the initial value of every attribute, which includes the
+ *   Config::SetDefault calls and the --ns3::Type::Attribute options,
+ * - the global values, among them RngSeed and RngRun,
+ * - the GNU build IDs of the program and of the libraries it loaded,
+ * - the contents of the input files passed to AddInput ().
+ *
+ * Options that do not change the results (--progress, --timings, ...) are
+ * left out with Ignore ().  The defaults of the options are part of the
+ * binary, so spelling one out on the command line only costs a cache miss.
+ *
+ * Commit () appends the key, the scenario, its options and the size and
+ * content hash of every output file to a manifest shared by all the runs,
+ * by default results/run-cache.txt:
+ *
+ * @code
+ *   3f2a9c0d11e4b7a8<TAB>disaster-ccn-scenario1v1<TAB>clients=300 networks=3<TAB>2013:9b1c0e5d7a3f2e41:results/disaster1-...txt<TAB>...
+ * @endcode
+ *
+ * Lookup () finds the last entry of the key and succeeds if all its files
+ * still have the recorded size and contents.  Output names need not
+ * include every option: a file overwritten by a run with another key, or
+ * by a run that did not complete, no longer matches and the run is done
+ * again.
+ *
+ * @code
+ *   RunCache cache ("disaster-tcp", argc, argv);
+ *   cache.Ignore ("progress");
+ *   if (cache.Lookup ())
+ *     {
+ *       cache.PrintHit (std::cout);
+ *       return 0;
+ *     }
+ *   ...
+ *   cache.AddOutput (filename);
+ *   ...
+ *   Simulator::Destroy ();
+ *   cache.Commit ();
+ * @endcode
+ */
+class RunCache
+{
+public:
+  /// @brief Cache of the runs of @p scenario, configured by its command line arguments
+  RunCache (const std::string &scenario, int argc, char *argv[]);
+
+  /// @brief Manifest of the cached runs [results/run-cache.txt]
+  void
+  SetManifest (const std::string &file);
+
+  /// @brief Leave @p option out of the key, as it does not change the results
+  void
+  Ignore (const std::string &option);
+
+  /// @brief Hash the contents of @p file into the key, for input files named by an option
+  void
+  AddInput (const std::string &file);
+
+  /// @brief Key of the run, from the configuration as it is now
+  uint64_t
+  GetKey () const;
+
+  /// @brief GetKey () as 16 hexadecimal digits
+  std::string
+  GetKeyString () const;
+
+  /// @brief Whether the manifest has complete results for the key
+  bool
+  Lookup ();
+
+  /// @brief Print the key and the files of the run found by Lookup ()
+  void
+  PrintHit (std::ostream &os) const;
+
+  /// @brief Record @p file among the results of the run
+  void
+  AddOutput (const std::string &file);
+
+  /// @brief Append the run, and the size and hash of its output files, to the manifest
+  ///
+  /// To be called once the run completed and its output files are closed
+  void
+  Commit () const;
+
+private:
+  /// @brief Options as "name=value", sorted, without the ignored ones
+  std::string
+  GetOptions () const;
+
+  std::string m_scenario;
+  std::vector<std::string> m_args;
+  std::string m_manifest;
+  std::set<std::string> m_ignored;
+  std::vector<std::string> m_inputs;
+  std::vector<std::string> m_outputs;
+  std::vector<std::string> m_hit;   ///< files of the run found by Lookup ()
+};
+
+} // namespace ns3
+
+#endif // RUN_CACHE_H
@@ -0,0 +1,64 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "scenario-random.h"
+
+namespace ns3 {
+
+ScenarioRandom::ScenarioRandom ()
+{
+}
+
+Ptr<UniformRandomVariable>
+ScenarioRandom::Get (Substream substream)
+{
+  NS_ASSERT (substream < N_SUBSTREAMS);
+  if (m_streams[substream] == 0)
+    {
+      m_streams[substream] = CreateObject<UniformRandomVariable> ();
+      m_streams[substream]->SetStream (FIRST_STREAM + substream);
+    }
+  return m_streams[substream];
+}
+
+uint32_t
+ScenarioRandom::Integer (Substream substream, uint32_t min, uint32_t max)
+{
+  return Get (substream)->GetInteger (min, max);
+}
+
+double
+ScenarioRandom::Uniform (Substream substream, double min, double max)
+{
+  return Get (substream)->GetValue (min, max);
+}
+
+int64_t
+ScenarioRandom::GetAppStream (uint32_t app)
+{
+  return FIRST_STREAM + N_SUBSTREAMS + APP_STREAMS * app;
+}
+
+void
+ScenarioRandom::Reset ()
+{
+  for (uint32_t i = 0; i < N_SUBSTREAMS; i++)
+    {
+      m_streams[i] = 0;
+    }
+}
+
+} // namespace ns3
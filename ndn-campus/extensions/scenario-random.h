@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SCENARIO_RANDOM_H
+#define SCENARIO_RANDOM_H
+
+#include <ns3-dev/ns3/core-module.h>
+
+namespace ns3 {
+
+/**
+ * @brief Random draws of a scenario, reproducible from --RngSeed and --RngRun
+ *
+ * Every substream is an ns-3 random variable on a fixed stream number, so
+ * a run is set by the (seed, run) pair alone: the same --RngRun draws the
+ * same clients, content names and start times, different runs are
+ * independent replications, and one substream does not shift when another
+ * one draws more or fewer numbers.
+ *
+ * The variables are created at the first draw, once the command line has
+ * set the run number.  After RngSeedManager::SetRun (), e.g. in a process
+ * forked by SeedForker, Reset () starts the substreams of the new run.
+ *
+ * @code
+ *   ScenarioRandom rng;
+ *   cmd.Parse (argc, argv);
+ *   uint32_t host = rng.Integer (ScenarioRandom::PLACEMENT, 0, nHosts - 1);
+ *   double start = rng.Uniform (ScenarioRandom::JITTER, 0, 1);
+ * @endcode
+ */
+class ScenarioRandom
+{
+public:
+  enum Substream
+  {
+    PLACEMENT,    ///< clients and servers
+    POPULARITY,   ///< content names requested
+    JITTER,       ///< application start times
+    N_SUBSTREAMS
+  };
+
+  /**
+   * @brief Stream number of the first substream
+   *
+   * Well above the streams that the ns-3 and ndnSIM helpers number from 0
+   * with AssignStreams (), and below the automatic ones from 2^63.
+   */
+  static const int64_t FIRST_STREAM = 1000000;
+
+  ScenarioRandom ();
+
+  /// @brief Integer uniformly drawn from [@p min, @p max]
+  uint32_t
+  Integer (Substream substream, uint32_t min, uint32_t max);
+
+  /// @brief Real uniformly drawn from [@p min, @p max)
+  double
+  Uniform (Substream substream, double min, double max);
+
+  /// @brief Variable of @p substream, e.g. to pass to a helper
+  Ptr<UniformRandomVariable>
+  Get (Substream substream);
+
+  /// @brief Streams reserved for the own random variables of each application
+  static const int64_t APP_STREAMS = 2;
+
+  /**
+   * @brief First of the APP_STREAMS streams of application @p app
+   *
+   * Follows the substreams, so that each application, e.g. a consumer
+   * drawing its gaps and contents, keeps its draws whatever the others draw.
+   */
+  static int64_t
+  GetAppStream (uint32_t app);
+
+  /// @brief Start the substreams again from the current seed and run
+  void
+  Reset ();
+
+private:
+  Ptr<UniformRandomVariable> m_streams[N_SUBSTREAMS];
+};
+
+} // namespace ns3
+
+#endif // SCENARIO_RANDOM_H
@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "seed-forker.h"
+
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE ("SeedForker");
+
+namespace ns3 {
+
+static inline double
+WallClock ()
+{
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  return (double)tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+SeedForker::SeedForker ()
+  : m_jobs (std::max (1L, sysconf (_SC_NPROCESSORS_ONLN)))
+  , m_logPrefix ("seed")
+  , m_index (0)
+  , m_nFailed (0)
+{
+}
+
+void
+SeedForker::SetJobs (uint32_t jobs)
+{
+  m_jobs = std::max (1u, jobs);
+}
+
+void
+SeedForker::SetLogPrefix (const std::string &prefix)
+{
+  m_logPrefix = prefix;
+}
+
+std::string
+SeedForker::GetLogFile (uint32_t index) const
+{
+  std::ostringstream os;
+  os << m_logPrefix << ".seed" << index << ".log";
+  return os.str ();
+}
+
+bool
+SeedForker::Fork (uint32_t n)
+{
+  // Children would flush the buffered output of the parent once more
+  std::cout.flush ();
+  std::fflush (0);
+
+  double start = WallClock ();
+  std::map<pid_t, uint32_t> running;
+  uint32_t next = 0;
+  while (next < n || !running.empty ())
+    {
+      while (next < n && running.size () < m_jobs)
+        {
+          pid_t pid = fork ();
+          NS_ABORT_MSG_IF (pid < 0, "Cannot fork seed run " << next << ": " << std::strerror (errno));
+          if (pid == 0)
+            {
+              m_index = next;
+              int fd = open (GetLogFile (next).c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+              NS_ABORT_MSG_IF (fd < 0, "Cannot open " << GetLogFile (next) << ": " << std::strerror (errno));
+              dup2 (fd, STDOUT_FILENO);
+              dup2 (fd, STDERR_FILENO);
+              close (fd);
+              return true;
+            }
+          running[pid] = next++;
+        }
+
+      int status;
+      pid_t pid = waitpid (-1, &status, 0);
+      if (pid < 0)
+        {
+          NS_ABORT_MSG_IF (errno != EINTR, "waitpid failed: " << std::strerror (errno));
+          continue;
+        }
+      std::map<pid_t, uint32_t>::iterator child = running.find (pid);
+      if (child != running.end ())
+        {
+          Report (child->second, status);
+          running.erase (child);
+        }
+    }
+
+  std::cout << "Seed runs: " << n << " in " << WallClock () - start << " s, " << m_nFailed << " failed"
+            << std::endl;
+  return false;
+}
+
+void
+SeedForker::Report (uint32_t index, int status)
+{
+  std::cout << "==== Seed run " << index;
+  if (WIFEXITED (status))
+    {
+      std::cout << " exited with status " << WEXITSTATUS (status);
+    }
+  else if (WIFSIGNALED (status))
+    {
+      std::cout << " killed by signal " << WTERMSIG (status);
+    }
+  std::cout << " (" << GetLogFile (index) << ")" << std::endl;
+  if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+    {
+      m_nFailed++;
+    }
+
+  // Streaming an empty file would set failbit on std::cout
+  std::ifstream log (GetLogFile (index).c_str ());
+  if (log.peek () != std::ifstream::traits_type::eof ())
+    {
+      std::cout << log.rdbuf () << std::flush;
+    }
+}
+
+uint32_t
+SeedForker::GetIndex () const
+{
+  return m_index;
+}
+
+uint32_t
+SeedForker::GetNFailed () const
+{
+  return m_nFailed;
+}
+
+} // namespace ns3
@@ -0,0 +1,93 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SEED_FORKER_H
+#define SEED_FORKER_H
+
+#include <string>
+
+#include <ns3-dev/ns3/core-module.h>
+
+namespace ns3 {
+
+/**
+ * @brief Run the rest of a scenario once per seed in forked processes
+ *
+ * The topology, the stacks and the routes are built once, then Fork ()
+ * makes copy-on-write copies of the process which each draw their own
+ * random inputs and run the simulation.  Children run SetJobs () at a
+ * time; the output of child i goes to "<prefix>.seed<i>.log", which the
+ * parent prints, with the exit status, as soon as the child is done.
+ *
+ * Fork () must be called before any thread is started, e.g. before
+ * ProgressReporter::Start (), and not under MPI.
+ *
+ * @code
+ *   SeedForker forker;
+ *   forker.SetLogPrefix ("results/run");
+ *   if (!forker.Fork (10))
+ *     return forker.GetNFailed () > 0;
+ *   RngSeedManager::SetRun (RngSeedManager::GetRun () + forker.GetIndex ());
+ *   ...
+ * @endcode
+ */
+class SeedForker
+{
+public:
+  SeedForker ();
+
+  /// @brief Children running at the same time [number of processors]
+  void
+  SetJobs (uint32_t jobs);
+
+  /// @brief Prefix of the child log files ["seed"]
+  void
+  SetLogPrefix (const std::string &prefix);
+
+  /**
+   * @brief Fork @p n children and wait for them
+   *
+   * Returns true in every child, with its output redirected to its log
+   * file, and false in the parent, once every child has exited.
+   */
+  bool
+  Fork (uint32_t n);
+
+  /// @brief Index of the child, from 0 to n - 1
+  uint32_t
+  GetIndex () const;
+
+  /// @brief Number of children that did not exit with status 0
+  uint32_t
+  GetNFailed () const;
+
+private:
+  std::string
+  GetLogFile (uint32_t index) const;
+
+  /// @brief Print the exit status and the output of child @p index
+  void
+  Report (uint32_t index, int status);
+
+  uint32_t m_jobs;
+  std::string m_logPrefix;
+  uint32_t m_index;
+  uint32_t m_nFailed;
+};
+
+} // namespace ns3
+
+#endif // SEED_FORKER_H
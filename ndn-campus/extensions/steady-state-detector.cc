@@ -0,0 +1,244 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "steady-state-detector.h"
+
+#include <cmath>
+#include <limits>
+
+#include <ns3-dev/ns3/ndnSIM-module.h>
+
+NS_LOG_COMPONENT_DEFINE ("SteadyStateDetector");
+
+namespace ns3 {
+
+static const uint32_t MSER_BATCH = 5;
+static const uint32_t N_BATCHES = 10;
+// 0.975 quantile of Student's t with N_BATCHES - 1 degrees of freedom
+static const double T_QUANTILE = 2.262;
+
+enum { THROUGHPUT, DELAY, HIT_RATIO };
+
+SteadyStateDetector::SteadyStateDetector ()
+  : m_interval (Seconds (1.0))
+  , m_precision (0.05)
+  , m_minSamples (30)
+  , m_nData (0)
+  , m_delaySum (0)
+  , m_nHits (0)
+  , m_nMisses (0)
+  , m_metrics (3)
+  , m_steady (false)
+{
+  m_metrics[THROUGHPUT].name = "Data/s";
+  m_metrics[DELAY].name = "delay (s)";
+  m_metrics[HIT_RATIO].name = "cache hit ratio";
+  for (std::vector<Metric>::iterator i = m_metrics.begin (); i != m_metrics.end (); ++i)
+    {
+      i->warmup = 0;
+      i->mean = 0;
+      i->halfWidth = 0;
+      i->absolute = false;
+    }
+  m_metrics[HIT_RATIO].absolute = true;
+}
+
+void
+SteadyStateDetector::SetInterval (Time interval)
+{
+  m_interval = interval;
+}
+
+void
+SteadyStateDetector::SetPrecision (double precision)
+{
+  m_precision = precision;
+}
+
+void
+SteadyStateDetector::SetMinSamples (uint32_t samples)
+{
+  m_minSamples = std::max (samples, MSER_BATCH * 2);
+}
+
+void
+SteadyStateDetector::Install ()
+{
+  // Same source as ndn::AppDelayTracer, for every consumer
+  Config::ConnectWithoutContext ("/NodeList/*/ApplicationList/*/LastRetransmittedInterestDataDelay",
+                                 MakeCallback (&SteadyStateDetector::OnData, this));
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::ndn::ContentStore/CacheHits",
+                                 MakeCallback (&SteadyStateDetector::OnCacheHit, this));
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::ndn::ContentStore/CacheMisses",
+                                 MakeCallback (&SteadyStateDetector::OnCacheMiss, this));
+  Simulator::Schedule (m_interval, &SteadyStateDetector::Sample, this);
+}
+
+void
+SteadyStateDetector::OnData (Ptr<ndn::App> app, uint32_t seqno, Time delay, int32_t hopCount)
+{
+  m_nData++;
+  m_delaySum += delay.GetSeconds ();
+}
+
+void
+SteadyStateDetector::OnCacheHit (Ptr<const ndn::Interest> interest, Ptr<const ndn::Data> data)
+{
+  m_nHits++;
+}
+
+void
+SteadyStateDetector::OnCacheMiss (Ptr<const ndn::Interest> interest)
+{
+  m_nMisses++;
+}
+
+void
+SteadyStateDetector::Sample ()
+{
+  m_metrics[THROUGHPUT].samples.push_back (m_nData / m_interval.GetSeconds ());
+  // Delay and hit ratio are undefined without Data or lookups
+  if (m_nData > 0)
+    {
+      m_metrics[DELAY].samples.push_back (m_delaySum / m_nData);
+    }
+  if (m_nHits + m_nMisses > 0)
+    {
+      m_metrics[HIT_RATIO].samples.push_back ((double)m_nHits / (m_nHits + m_nMisses));
+    }
+  m_nData = 0;
+  m_delaySum = 0;
+  m_nHits = 0;
+  m_nMisses = 0;
+
+  bool steady = true;
+  for (std::vector<Metric>::iterator i = m_metrics.begin (); i != m_metrics.end (); ++i)
+    {
+      steady = Test (*i) && steady;
+    }
+  if (steady)
+    {
+      m_steady = true;
+      m_steadyTime = Simulator::Now ();
+      std::cout << "Steady state reached at " << m_steadyTime.GetSeconds () << " s" << std::endl;
+      Simulator::Stop ();
+      return;
+    }
+  Simulator::Schedule (m_interval, &SteadyStateDetector::Sample, this);
+}
+
+bool
+SteadyStateDetector::Test (Metric &metric) const
+{
+  const std::vector<double> &x = metric.samples;
+  uint32_t n = x.size ();
+  if (n < m_minSamples)
+    {
+      return false;
+    }
+
+  // MSER-5: batch means of 5 samples, then the truncation d that minimizes
+  // the variance of the mean of the remaining batches, sum (z - mean)^2 / (nb - d)^2
+  uint32_t nb = n / MSER_BATCH;
+  std::vector<double> z (nb, 0.0);
+  for (uint32_t j = 0; j < nb; j++)
+    {
+      for (uint32_t i = 0; i < MSER_BATCH; i++)
+        {
+          z[j] += x[j * MSER_BATCH + i];
+        }
+      z[j] /= MSER_BATCH;
+    }
+  double sum = 0, sumSquares = 0, best = std::numeric_limits<double>::max ();
+  uint32_t bestD = 0;
+  for (uint32_t d = nb; d-- > 0; )
+    {
+      sum += z[d];
+      sumSquares += z[d] * z[d];
+      uint32_t count = nb - d;
+      if (d > nb / 2)
+        {
+          continue;
+        }
+      double squares = std::max (0.0, sumSquares - sum * sum / count);
+      double mser = squares / ((double)count * count);
+      // Ties go to the shortest warm-up
+      if (mser <= best)
+        {
+          best = mser;
+          bestD = d;
+        }
+    }
+  metric.warmup = bestD * MSER_BATCH;
+  // The best truncation at the end of the search means that the run is
+  // still too short to tell the warm-up from the steady state
+  if (bestD == nb / 2)
+    {
+      return false;
+    }
+
+  // Batch means over the latest samples after the warm-up
+  uint32_t batch = (n - metric.warmup) / N_BATCHES;
+  uint32_t start = n - batch * N_BATCHES;
+  double mean = 0;
+  std::vector<double> y (N_BATCHES, 0.0);
+  for (uint32_t k = 0; k < N_BATCHES; k++)
+    {
+      for (uint32_t i = 0; i < batch; i++)
+        {
+          y[k] += x[start + k * batch + i];
+        }
+      y[k] /= batch;
+      mean += y[k] / N_BATCHES;
+    }
+  double variance = 0;
+  for (uint32_t k = 0; k < N_BATCHES; k++)
+    {
+      variance += (y[k] - mean) * (y[k] - mean) / (N_BATCHES - 1);
+    }
+  metric.mean = mean;
+  metric.halfWidth = T_QUANTILE * std::sqrt (variance / N_BATCHES);
+
+  if (metric.absolute)
+    {
+      return metric.halfWidth <= m_precision;
+    }
+  return mean != 0 && metric.halfWidth <= m_precision * std::fabs (mean);
+}
+
+bool
+SteadyStateDetector::IsSteady () const
+{
+  return m_steady;
+}
+
+Time
+SteadyStateDetector::GetSteadyTime () const
+{
+  return m_steadyTime;
+}
+
+void
+SteadyStateDetector::Print (std::ostream &os) const
+{
+  for (std::vector<Metric>::const_iterator i = m_metrics.begin (); i != m_metrics.end (); ++i)
+    {
+      os << "Steady state " << i->name << ": " << i->mean << " +- " << i->halfWidth << " (95%), warm-up "
+         << i->warmup * m_interval.GetSeconds () << " s, " << i->samples.size () << " samples" << std::endl;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef STEADY_STATE_DETECTOR_H
+#define STEADY_STATE_DETECTOR_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <ns3-dev/ns3/core-module.h>
+
+namespace ns3 {
+
+namespace ndn {
+class App;
+class Data;
+class Interest;
+}
+
+/**
+ * @brief Stop the simulation once the consumer metrics reach steady state
+ *
+ * Every SetInterval () of simulated time (1 s, the period of the L3
+ * tracers), the Data received by all consumers and the lookups of all
+ * content stores over the interval give three samples:
+ *
+ * - throughput, Data per second
+ * - mean Interest-Data delay
+ * - cache hit ratio, the CacheHits over the CacheHits and CacheMisses of
+ *   every ndn::ContentStore, which rises as the caches fill up
+ *
+ * After each sample, the warm-up of every metric is estimated with MSER-5
+ * (the truncation point that minimizes the standard error of the remaining
+ * batch means of 5 samples, searched over the first half of the run), and
+ * the rest of the samples are split in 10 batches.  When the 95%
+ * confidence interval of the batch means of every metric is within
+ * SetPrecision () of its mean, the simulation stops.  The precision of the
+ * hit ratio is absolute rather than relative, so that a network with few
+ * hits can still reach steady state.
+ *
+ * @code
+ *   SteadyStateDetector steady;
+ *   steady.SetPrecision (0.05);
+ *   steady.Install ();        // once the consumers are installed
+ *   Simulator::Stop (Seconds (maxTime));
+ *   Simulator::Run ();
+ *   steady.Print (std::cout);
+ * @endcode
+ */
+class SteadyStateDetector
+{
+public:
+  SteadyStateDetector ();
+
+  /// @brief Sampling period [1s]
+  void
+  SetInterval (Time interval);
+
+  /// @brief Largest confidence interval half-width, relative to the mean [0.05]
+  void
+  SetPrecision (double precision);
+
+  /// @brief Samples taken before the first test [30]
+  void
+  SetMinSamples (uint32_t samples);
+
+  /// @brief Connect to the consumers and content stores installed so far and start sampling
+  void
+  Install ();
+
+  /// @brief Whether the simulation was stopped at steady state
+  bool
+  IsSteady () const;
+
+  /// @brief Time at which steady state was detected
+  Time
+  GetSteadyTime () const;
+
+  /// @brief Print the warm-up, mean and confidence interval of every metric
+  void
+  Print (std::ostream &os) const;
+
+private:
+  struct Metric
+  {
+    std::string name;
+    std::vector<double> samples;
+    uint32_t warmup;   ///< samples cut by MSER-5
+    double mean;       ///< of the samples after the warm-up
+    double halfWidth;  ///< of the 95% confidence interval
+    bool absolute;     ///< precision not relative to the mean
+  };
+
+  void
+  OnData (Ptr<ndn::App> app, uint32_t seqno, Time delay, int32_t hopCount);
+
+  void
+  OnCacheHit (Ptr<const ndn::Interest> interest, Ptr<const ndn::Data> data);
+
+  void
+  OnCacheMiss (Ptr<const ndn::Interest> interest);
+
+  void
+  Sample ();
+
+  /// @brief Update the warm-up and the confidence interval of @p metric, true if precise enough
+  bool
+  Test (Metric &metric) const;
+
+  Time m_interval;
+  double m_precision;
+  uint32_t m_minSamples;
+
+  // Data received and content store lookups during the current interval
+  uint64_t m_nData;
+  double m_delaySum;
+  uint64_t m_nHits;
+  uint64_t m_nMisses;
+
+  std::vector<Metric> m_metrics;
+  bool m_steady;
+  Time m_steadyTime;
+};
+
+} // namespace ns3
+
+#endif // STEADY_STATE_DETECTOR_H
@@ -0,0 +1,306 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "topology-file-reader.h"
+
+#include <sys/time.h>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include <ns3-dev/ns3/internet-module.h>
+#include <ns3-dev/ns3/ndnSIM-module.h>
+
+NS_LOG_COMPONENT_DEFINE ("TopologyFileReader");
+
+namespace ns3 {
+
+static inline double
+WallClock ()
+{
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  return (double)tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// Split @p line in place on white space, stopping at '#'.  Returns the
+// number of fields, at most @p max
+static size_t
+SplitFields (std::string &line, const char *fields[], size_t max)
+{
+  // Trailing blank, so that the last field is terminated in place as well
+  line += ' ';
+  size_t n = 0;
+  char *p = &line[0];
+  char *end = p + line.size ();
+  while (p != end && n < max)
+    {
+      while (p != end && std::isspace (static_cast<unsigned char> (*p)))
+        {
+          ++p;
+        }
+      if (p == end || *p == '#')
+        {
+          break;
+        }
+      fields[n++] = p;
+      while (p != end && !std::isspace (static_cast<unsigned char> (*p)) && *p != '#')
+        {
+          ++p;
+        }
+      if (p != end)
+        {
+          bool comment = *p == '#';
+          *p++ = '\0';
+          if (comment)
+            {
+              break;
+            }
+        }
+    }
+  return n;
+}
+
+TopologyFileReader::TopologyFileReader ()
+  : m_format (FORMAT_AUTO)
+  , m_defaultDataRate ("1Gbps")
+  , m_defaultDelay ("10ms")
+  , m_registerNames (true)
+  , m_parseTime (0.0)
+  , m_buildTime (0.0)
+{
+}
+
+void
+TopologyFileReader::SetFormat (Format format)
+{
+  m_format = format;
+}
+
+void
+TopologyFileReader::SetDefaultLink (const std::string &dataRate, const std::string &delay)
+{
+  m_defaultDataRate = dataRate;
+  m_defaultDelay = delay;
+}
+
+void
+TopologyFileReader::SetRegisterNames (bool enable)
+{
+  m_registerNames = enable;
+}
+
+bool
+TopologyFileReader::Read (const std::string &file)
+{
+  std::ifstream is (file.c_str ());
+  if (!is)
+    {
+      NS_LOG_ERROR ("Cannot open topology file " << file);
+      return false;
+    }
+
+  double start = WallClock ();
+  m_buildTime = 0.0;
+  const uint32_t firstNode = m_nodes.GetN ();
+  const uint32_t firstLink = m_links.size ();
+
+  enum { NO_SECTION, ROUTERS, LINKS } section = NO_SECTION;
+  Format format = m_format;
+  std::string line;
+  const char *f[8];
+  uint32_t lineNo = 0;
+  while (std::getline (is, line))
+    {
+      ++lineNo;
+      size_t n = SplitFields (line, f, sizeof (f) / sizeof (f[0]));
+      if (n == 0)
+        {
+          continue;
+        }
+
+      bool header = n == 1 && (std::strcmp (f[0], "router") == 0 || std::strcmp (f[0], "link") == 0);
+      if (format == FORMAT_AUTO)
+        {
+          format = header ? FORMAT_ANNOTATED : FORMAT_EDGE_LIST;
+        }
+
+      if (format == FORMAT_EDGE_LIST)
+        {
+          NS_ABORT_MSG_IF (n < 2, file << ":" << lineNo << ": expected \"src dst [bandwidth [delay]]\"");
+          AddLink (GetOrCreateNode (f[0]), GetOrCreateNode (f[1]),
+                   n > 2 ? f[2] : m_defaultDataRate.c_str (), n > 3 ? f[3] : m_defaultDelay.c_str (), 0, 1);
+        }
+      else if (header)
+        {
+          section = f[0][0] == 'r' ? ROUTERS : LINKS;
+        }
+      else if (section == ROUTERS)
+        {
+          GetOrCreateNode (f[0]);
+        }
+      else if (section == LINKS)
+        {
+          NS_ABORT_MSG_IF (n < 5, file << ":" << lineNo << ": expected \"src dst bandwidth metric delay [queue]\"");
+          uint32_t from = FindNode (f[0]);
+          uint32_t to = FindNode (f[1]);
+          NS_ABORT_MSG_IF (from == m_nodes.GetN () || to == m_nodes.GetN (),
+                           file << ":" << lineNo << ": link to a node missing from the router section");
+
+          char *end;
+          unsigned long metric = std::strtoul (f[3], &end, 10);
+          NS_ABORT_MSG_IF (*end != '\0', file << ":" << lineNo << ": bad metric " << f[3]);
+          AddLink (from, to, f[2], f[4], n > 5 ? f[5] : 0, metric);
+        }
+      else
+        {
+          NS_FATAL_ERROR (file << ":" << lineNo << ": expected a router or link section");
+        }
+    }
+
+  m_parseTime = WallClock () - start - m_buildTime;
+  std::cout << "Topology file " << file << " read in " << m_parseTime + m_buildTime << " s (parse "
+            << m_parseTime << " s, build " << m_buildTime << " s): " << m_nodes.GetN () - firstNode
+            << " nodes, " << m_links.size () - firstLink << " links" << std::endl;
+  return true;
+}
+
+uint32_t
+TopologyFileReader::GetOrCreateNode (const std::string &name)
+{
+  std::pair<boost::unordered_map<std::string, uint32_t>::iterator, bool> i =
+    m_nodeIndex.insert (std::make_pair (name, m_nodes.GetN ()));
+  if (i.second)
+    {
+      double start = WallClock ();
+      Ptr<Node> node = CreateObject<Node> ();
+      m_nodes.Add (node);
+      if (m_registerNames)
+        {
+          Names::Add (name, node);
+        }
+      m_buildTime += WallClock () - start;
+    }
+  return i.first->second;
+}
+
+void
+TopologyFileReader::AddLink (uint32_t from, uint32_t to, const char *dataRate, const char *delay,
+                             const char *queue, uint32_t metric)
+{
+  double start = WallClock ();
+
+  // Files usually repeat the same parameters, only touch the helper when
+  // they change
+  if (m_dataRate != dataRate)
+    {
+      m_dataRate = dataRate;
+      m_p2p.SetDeviceAttribute ("DataRate", StringValue (m_dataRate));
+    }
+  if (m_delay != delay)
+    {
+      m_delay = delay;
+      m_p2p.SetChannelAttribute ("Delay", StringValue (m_delay));
+    }
+  if (queue == 0 && !m_queue.empty ())
+    {
+      m_queue.clear ();
+      m_p2p.SetQueue ("ns3::DropTailQueue");
+    }
+  else if (queue != 0 && m_queue != queue)
+    {
+      m_queue = queue;
+      m_p2p.SetQueue ("ns3::DropTailQueue", "MaxPackets", StringValue (m_queue));
+    }
+
+  Link link;
+  link.from = from;
+  link.to = to;
+  link.metric = metric;
+  link.devices = m_p2p.Install (m_nodes.Get (from), m_nodes.Get (to));
+  m_links.push_back (link);
+
+  m_buildTime += WallClock () - start;
+}
+
+const NodeContainer &
+TopologyFileReader::GetNodes () const
+{
+  return m_nodes;
+}
+
+uint32_t
+TopologyFileReader::FindNode (const std::string &name) const
+{
+  boost::unordered_map<std::string, uint32_t>::const_iterator i = m_nodeIndex.find (name);
+  return i == m_nodeIndex.end () ? m_nodes.GetN () : i->second;
+}
+
+uint32_t
+TopologyFileReader::GetNLinks () const
+{
+  return m_links.size ();
+}
+
+const TopologyFileReader::Link &
+TopologyFileReader::GetLink (uint32_t link) const
+{
+  return m_links[link];
+}
+
+void
+TopologyFileReader::ApplyMetrics () const
+{
+  for (std::vector<Link>::const_iterator link = m_links.begin (); link != m_links.end (); ++link)
+    {
+      for (uint32_t i = 0; i < link->devices.GetN (); i++)
+        {
+          Ptr<NetDevice> device = link->devices.Get (i);
+          Ptr<Node> node = device->GetNode ();
+
+          Ptr<ndn::L3Protocol> ndn = node->GetObject<ndn::L3Protocol> ();
+          if (ndn != 0)
+            {
+              Ptr<ndn::Face> face = ndn->GetFaceByNetDevice (device);
+              NS_ASSERT (face != 0);
+              face->SetMetric (link->metric);
+            }
+
+          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+          if (ipv4 != 0)
+            {
+              int32_t interface = ipv4->GetInterfaceForDevice (device);
+              NS_ASSERT (interface >= 0);
+              ipv4->SetMetric (interface, link->metric);
+            }
+        }
+    }
+}
+
+double
+TopologyFileReader::GetParseTime () const
+{
+  return m_parseTime;
+}
+
+double
+TopologyFileReader::GetBuildTime () const
+{
+  return m_buildTime;
+}
+
+} // namespace ns3
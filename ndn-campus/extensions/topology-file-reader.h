@@ -0,0 +1,161 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TOPOLOGY_FILE_READER_H
+#define TOPOLOGY_FILE_READER_H
+
+#include <string>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+#include <ns3-dev/ns3/core-module.h>
+#include <ns3-dev/ns3/network-module.h>
+#include <ns3-dev/ns3/point-to-point-module.h>
+
+namespace ns3 {
+
+/**
+ * @brief Streaming reader for topology files
+ *
+ * Two formats are understood:
+ *
+ * - ndnSIM annotated topologies: a "router" section with one node name per
+ *   line (other columns are ignored), then a "link" section with
+ *   "src dst bandwidth metric delay [queue]" lines
+ * - edge lists: "src dst [bandwidth [delay]]" lines, nodes are created the
+ *   first time they appear and missing columns take the default link
+ *   parameters
+ *
+ * '#' starts a comment in both formats.  The file is read one line at a
+ * time and nodes and links are created as soon as their line is parsed, so
+ * only the node name table and the link table are kept in memory, whatever
+ * the size of the file.  Only nodes and point-to-point links are created;
+ * the scenario installs the stacks it needs on GetNodes (), then calls
+ * ApplyMetrics () so that routing uses the metrics of the file, as with
+ * ndn::AnnotatedTopologyReader::ApplyOspfMetric ().
+ *
+ * @code
+ *   TopologyFileReader reader;
+ *   if (!reader.Read ("topologies/isp.txt"))
+ *     return 1;
+ *   ndn::StackHelper ndnHelper;
+ *   ndnHelper.Install (reader.GetNodes ());
+ *   reader.ApplyMetrics ();
+ * @endcode
+ */
+class TopologyFileReader
+{
+public:
+  enum Format
+    {
+      FORMAT_AUTO,      ///< annotated if the first statement is "router" or "link", edge list otherwise
+      FORMAT_ANNOTATED,
+      FORMAT_EDGE_LIST
+    };
+
+  /// @brief Link read from the file, between two node indexes
+  struct Link
+  {
+    uint32_t from;
+    uint32_t to;
+    uint32_t metric;          ///< metric column of annotated files, 1 for edge lists
+    NetDeviceContainer devices; ///< devices on the from and to nodes
+  };
+
+  TopologyFileReader ();
+
+  /// @brief Format of the next Read () [FORMAT_AUTO]
+  void
+  SetFormat (Format format);
+
+  /// @brief Link parameters used when an edge list line has none ["1Gbps", "10ms"]
+  void
+  SetDefaultLink (const std::string &dataRate, const std::string &delay);
+
+  /// @brief Register every node under its name with ns3::Names [true]
+  void
+  SetRegisterNames (bool enable);
+
+  /**
+   * @brief Create the nodes and links described in @p file
+   *
+   * Returns false if the file cannot be opened.  Malformed lines abort the
+   * simulation with their file name and line number.
+   */
+  bool
+  Read (const std::string &file);
+
+  /// @brief Nodes in order of first appearance in the file
+  const NodeContainer &
+  GetNodes () const;
+
+  /// @brief Index of the node named @p name in GetNodes (), or GetNodes ().GetN () if unknown
+  uint32_t
+  FindNode (const std::string &name) const;
+
+  uint32_t
+  GetNLinks () const;
+
+  const Link &
+  GetLink (uint32_t link) const;
+
+  /**
+   * @brief Set the metric of every link on the faces of its two devices
+   *
+   * To be called once the NDN stack is installed and before the routes are
+   * calculated.  Also sets the IPv4 interface metrics on nodes with an
+   * Internet stack.  Nodes without a stack are skipped.
+   */
+  void
+  ApplyMetrics () const;
+
+  /// @brief Wall-clock seconds spent reading and parsing the file in the last Read ()
+  double
+  GetParseTime () const;
+
+  /// @brief Wall-clock seconds spent creating nodes and links in the last Read ()
+  double
+  GetBuildTime () const;
+
+private:
+  uint32_t
+  GetOrCreateNode (const std::string &name);
+
+  void
+  AddLink (uint32_t from, uint32_t to, const char *dataRate, const char *delay, const char *queue, uint32_t metric);
+
+  Format m_format;
+  std::string m_defaultDataRate;
+  std::string m_defaultDelay;
+  bool m_registerNames;
+
+  NodeContainer m_nodes;
+  boost::unordered_map<std::string, uint32_t> m_nodeIndex;
+  std::vector<Link> m_links;
+
+  PointToPointHelper m_p2p;
+  std::string m_dataRate; ///< current m_p2p settings, to skip redundant attribute updates
+  std::string m_delay;
+  std::string m_queue;
+
+  double m_parseTime;
+  double m_buildTime;
+};
+
+} // namespace ns3
+
+#endif // TOPOLOGY_FILE_READER_H
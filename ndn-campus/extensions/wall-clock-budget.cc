@@ -0,0 +1,183 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "wall-clock-budget.h"
+#include "counting-scheduler.h"
+
+#include <sys/time.h>
+#include <csignal>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+NS_LOG_COMPONENT_DEFINE ("WallClockBudget");
+
+namespace ns3 {
+
+static inline double
+WallClock ()
+{
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  return (double)tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// Last signal caught, handlers are process-wide
+static volatile sig_atomic_t g_signal = 0;
+static struct sigaction g_oldInt;
+static struct sigaction g_oldTerm;
+
+static void
+OnSignal (int signo)
+{
+  g_signal = signo;
+  CountingScheduler::RequestStop ();
+}
+
+struct WallClockBudget::Thread
+{
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable wakeup;
+  bool stop;
+};
+
+WallClockBudget::WallClockBudget ()
+  : m_catchSignals (true)
+  , m_budget (0.0)
+  , m_start (0.0)
+  , m_thread (0)
+  , m_exhausted (false)
+  , m_signalsCaught (false)
+{
+}
+
+WallClockBudget::~WallClockBudget ()
+{
+  Stop ();
+}
+
+void
+WallClockBudget::SetCatchSignals (bool enable)
+{
+  m_catchSignals = enable;
+}
+
+void
+WallClockBudget::Start (double seconds)
+{
+  NS_ASSERT_MSG (m_thread == 0 && !m_signalsCaught, "Wall-clock budget already started");
+  m_budget = seconds;
+  m_start = WallClock ();
+  m_exhausted = false;
+  g_signal = 0;
+
+  if (m_catchSignals)
+    {
+      // The second signal gets the default handler and kills the process
+      struct sigaction action;
+      action.sa_handler = OnSignal;
+      sigemptyset (&action.sa_mask);
+      action.sa_flags = SA_RESETHAND;
+      sigaction (SIGINT, &action, &g_oldInt);
+      sigaction (SIGTERM, &action, &g_oldTerm);
+      m_signalsCaught = true;
+    }
+
+  if (m_budget > 0)
+    {
+      m_thread = new Thread;
+      m_thread->stop = false;
+      m_thread->thread = std::thread (&WallClockBudget::Run, this);
+    }
+}
+
+void
+WallClockBudget::Stop ()
+{
+  if (m_thread != 0)
+    {
+      {
+        std::lock_guard<std::mutex> lock (m_thread->mutex);
+        m_thread->stop = true;
+      }
+      m_thread->wakeup.notify_one ();
+      m_thread->thread.join ();
+      delete m_thread;
+      m_thread = 0;
+    }
+
+  if (m_signalsCaught)
+    {
+      sigaction (SIGINT, &g_oldInt, 0);
+      sigaction (SIGTERM, &g_oldTerm, 0);
+      m_signalsCaught = false;
+    }
+}
+
+void
+WallClockBudget::Run ()
+{
+  std::unique_lock<std::mutex> lock (m_thread->mutex);
+  std::chrono::steady_clock::time_point deadline =
+    std::chrono::steady_clock::now () + std::chrono::duration_cast<std::chrono::steady_clock::duration> (
+      std::chrono::duration<double> (m_budget));
+  if (!m_thread->wakeup.wait_until (lock, deadline, [this] { return m_thread->stop; }))
+    {
+      m_exhausted = true;
+      CountingScheduler::RequestStop ();
+    }
+}
+
+bool
+WallClockBudget::IsExhausted () const
+{
+  return m_exhausted || g_signal != 0;
+}
+
+std::string
+WallClockBudget::GetReason () const
+{
+  std::ostringstream os;
+  if (m_exhausted)
+    {
+      os << "wall budget of " << m_budget << " s";
+    }
+  else if (g_signal != 0)
+    {
+      os << "signal " << g_signal;
+    }
+  return os.str ();
+}
+
+void
+WallClockBudget::WriteMarker (const std::string &file, Time reached) const
+{
+  std::ofstream os (file.c_str ());
+  if (!os)
+    {
+      NS_LOG_ERROR ("Cannot write " << file);
+      return;
+    }
+  os << "Stopped: " << GetReason () << std::endl
+     << "SimTime: " << reached.GetSeconds () << std::endl
+     << "Wall: " << WallClock () - m_start << std::endl;
+}
+
+} // namespace ns3
@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WALL_CLOCK_BUDGET_H
+#define WALL_CLOCK_BUDGET_H
+
+#include <string>
+
+#include <ns3-dev/ns3/core-module.h>
+
+namespace ns3 {
+
+/**
+ * @brief Stop a simulation cleanly after a wall-clock budget or a signal
+ *
+ * A background thread sleeps until the budget runs out, then asks
+ * CountingScheduler, which must be the scheduler of the simulation, to
+ * stop before the next event; nothing is scheduled in the simulator.
+ * SIGINT and SIGTERM do the same, so that killed sweep jobs end like
+ * budget-limited ones, and a second signal kills the process.
+ *
+ * Simulator::Run () then returns normally, the scenario destroys the
+ * simulator and exits, which flushes and closes every tracer file.
+ * WriteMarker () records how far the simulation went.
+ *
+ * @code
+ *   WallClockBudget budget;
+ *   budget.Start (3600);
+ *   Simulator::Run ();
+ *   budget.Stop ();
+ *   if (budget.IsExhausted ())
+ *     budget.WriteMarker ("results/run.incomplete", Simulator::Now ());
+ *   Simulator::Destroy ();
+ * @endcode
+ */
+class WallClockBudget
+{
+public:
+  WallClockBudget ();
+
+  /// @brief Calls Stop ()
+  ~WallClockBudget ();
+
+  /// @brief Stop on SIGINT and SIGTERM as well [true]
+  void
+  SetCatchSignals (bool enable);
+
+  /// @brief Start the budget of @p seconds of wall-clock time, 0 for none
+  void
+  Start (double seconds);
+
+  /// @brief Cancel the budget and restore the signal handlers
+  void
+  Stop ();
+
+  /// @brief Whether the simulation was stopped by the budget or a signal
+  bool
+  IsExhausted () const;
+
+  /// @brief What stopped the simulation, e.g. "wall budget of 3600 s" or "signal 15"
+  std::string
+  GetReason () const;
+
+  /// @brief Write the reason, the simulated time reached and the wall-clock time to @p file
+  void
+  WriteMarker (const std::string &file, Time reached) const;
+
+private:
+  WallClockBudget (const WallClockBudget &);
+  WallClockBudget &
+  operator= (const WallClockBudget &);
+
+  struct Thread;
+
+  void
+  Run ();
+
+  bool m_catchSignals;
+  double m_budget;
+  double m_start;
+  Thread *m_thread;
+  bool m_exhausted;       ///< set by the budget thread, read after Stop ()
+  bool m_signalsCaught;
+};
+
+} // namespace ns3
+
+#endif // WALL_CLOCK_BUDGET_H
@@ -8,6 +8,7 @@ CFLAG=1
 PFLAG=1
 NFLAG=1
 SFLAG=10
+RFLAG=1
 
 function usage() {
 echo "Tiny script to automize running of a ns3 scenario"
@@ -16,10 +17,11 @@ echo "    -c NUM    Number of clients (consumers) for the scenario. Default [$CF
 echo "    -p NUM    Number of servers (producers) for the scenario. Default [$PFLAG]"
 echo "    -n NUM    Number of networks the scenario will have. Default [$NFLAG]"
 echo "    -s NUM    Size, in MB of the content to be distributed. Default [$SFLAG]"
+echo "    -r NUM    Run number (replication), passed as --RngRun. Default [$RFLAG]"
 echo ""
 }
 
-while getopts "c:s:n:p:h" OPT
+while getopts "c:s:n:p:r:h" OPT
 do
     case $OPT in
     c)
@@ -34,6 +36,9 @@ do
     s)
         SFLAG=$OPTARG
         ;;
+    r)
+        RFLAG=$OPTARG
+        ;;
     \?)
         echo "Invalid option: -$OPTARG" >&2
         exit 1
@@ -60,5 +65,10 @@ fi
 
 BYTES=$($CONTSIZE --avg $SFLAG)
 
-$WAF --run "disaster-tcp --clients=$CFLAG --contentsize=$BYTES --networks=$NFLAG --producers=$PFLAG"
-$WAF --run "nms-disaster-ccn --clients=$CFLAG --contentsize=$BYTES --networks=$NFLAG --producers=$PFLAG"
+ARGS="--clients=$CFLAG --contentsize=$BYTES --networks=$NFLAG --servers=$PFLAG --RngRun=$RFLAG"
+# Written by the TCP run, read back by the CCN run so that both protocols
+# are compared on the same clients
+CLIENTS=$(printf "results/disaster-tcp-clients-%02d-%03d-%03d-%012d.txt" $NFLAG $PFLAG $CFLAG $BYTES)
+
+$WAF --run "disaster-tcp-onoff-scenario1 $ARGS" || exit 1
+$WAF --run "disaster-ccn-scenario1v1 $ARGS --placementFile=$CLIENTS"
@@ -8,6 +8,10 @@ import subprocess
 import workerpool
 import multiprocessing
 import argparse
+import glob
+import hashlib
+import json
+import re
 
 ######################################################################
 ######################################################################
@@ -92,11 +96,402 @@ class Scenario (Processor):
         # any postprocessing, if any
         pass
 
+class ScalingBenchmark (Processor):
+    "Setup time, event rate and peak memory of disaster-ccn-scenario1v1 for growing rings"
+    stats = [("Topology setup took", "setup"),
+             ("Simulator init time", "init"),
+             ("Simulator run time", "run"),
+             ("Simulated time reached", "reached"),
+             ("Events per second", "events_per_s"),
+             ("Events", "events"),
+             ("Peak RSS (MB)", "peak_rss_mb")]
+    keys = ["campuses"]
+    extra = []
+
+    def __init__ (self, name, campuses, clientsPerCampus=50, stopTime=10, wallBudget=0):
+        self.name = name
+        self.campuses = campuses
+        self.clientsPerCampus = clientsPerCampus
+        self.stopTime = stopTime
+        # Runs stop cleanly after that many wall-clock seconds, "reached" < stopTime tells them apart
+        self.wallBudget = wallBudget
+        self.contentsize = 1048576
+        self.results = []
+
+    def run_once (self, n, extra=[], launcher=[]):
+        cmdline = launcher + ["./build/disaster-ccn-scenario1v1",
+                   "--networks=%d" % n,
+                   "--servers=%d" % n,
+                   "--clients=%d" % (n * self.clientsPerCampus),
+                   "--clientsPerCampus=%d" % self.clientsPerCampus,
+                   "--contentsize=%d" % self.contentsize,
+                   "--stopTime=%d" % self.stopTime,
+                   "--wallBudget=%d" % self.wallBudget,
+                   # Benchmarks time the runs, a cached one would report nothing
+                   "--cache=false"] + extra
+        print (" ".join (cmdline))
+        output = subprocess.Popen (cmdline, stdout=subprocess.PIPE).communicate ()[0]
+
+        result = {"campuses": n}
+        for line in output.splitlines ():
+            for prefix, key in self.stats:
+                if line.startswith (prefix) and key not in result:
+                    result[key] = line[len (prefix):].strip (" :").split (" ")[0]
+                    break
+        return result
+
+    def simulate (self):
+        # Runs go one at a time, concurrent runs would skew time and memory
+        for n in self.campuses:
+            self.results.append (self.run_once (n))
+
+    def postprocess (self):
+        columns = self.keys + [key for prefix, key in self.stats] + self.extra
+        with open ("results/%s.txt" % self.name, "w") as f:
+            f.write ("\t".join (columns) + "\n")
+            for result in self.results:
+                f.write ("\t".join ([str (result.get (c, "NA")) for c in columns]) + "\n")
+        print (open ("results/%s.txt" % self.name).read ())
+
+    def graph (self):
+        # The table printed by postprocess () is the result
+        pass
+
+class BackboneBenchmark (ScalingBenchmark):
+    "Latency, events and wall time of disaster-ccn-scenario1v1 for each backbone shape"
+    keys = ["backbone", "campuses"]
+    extra = ["delay_s", "hops"]
+
+    def __init__ (self, name, backbones, campuses=16, **kwargs):
+        ScalingBenchmark.__init__ (self, name, [campuses], **kwargs)
+        self.backbones = backbones
+
+    def app_delays (self, n):
+        "Mean Interest-Data delay and hop count of the last run, from its AppDelayTracer output"
+        trace = "results/disaster1-ccn-app-delays-trace-%02d-%03d-%03d-%012d.txt" % (
+            n, n, n * self.clientsPerCampus, self.contentsize)
+        delays = []
+        hops = []
+        with open (trace) as f:
+            header = f.readline ().split ()
+            for line in f:
+                row = dict (zip (header, line.split ()))
+                if row.get ("Type") == "LastDelay":
+                    delays.append (float (row["DelayS"]))
+                    hops.append (float (row["HopCount"]))
+        if not delays:
+            return "NA", "NA"
+        return sum (delays) / len (delays), sum (hops) / len (hops)
+
+    def simulate (self):
+        for backbone in self.backbones:
+            for n in self.campuses:
+                result = self.run_once (n, ["--backbone=%s" % backbone])
+                result["backbone"] = backbone
+                # The trace name does not include the backbone, read it before the next run
+                result["delay_s"], result["hops"] = self.app_delays (n)
+                self.results.append (result)
+
+class StackBenchmark (ScalingBenchmark):
+    "Startup time and memory of disaster-ccn-scenario1v1 for each way of installing the protocol stacks"
+    stats = ScalingBenchmark.stats + [("NDN stack install took", "stack_s")]
+    keys = ["stacks", "campuses"]
+
+    def __init__ (self, name, modes, campuses, **kwargs):
+        ScalingBenchmark.__init__ (self, name, campuses, **kwargs)
+        # (label, extra command line arguments)
+        self.modes = modes
+
+    def simulate (self):
+        for label, extra in self.modes:
+            for n in self.campuses:
+                result = self.run_once (n, extra)
+                result["stacks"] = label
+                self.results.append (result)
+
+# Counters that are added up when ranks report the same row
+RANK_SUMMED_COLUMNS = set (["Packets", "Kilobytes", "PacketRaw", "PacketsRaw", "KilobytesRaw"])
+
+def merge_rank_traces (directory="results"):
+    "Merge the <trace>.rank<N>.txt files of an MPI run, or the <trace>.part<N>.txt of partitions, into <trace>.txt, ordered by time"
+    traces = {}
+    for name in glob.glob (os.path.join (directory, "*.rank*.txt")) + glob.glob (os.path.join (directory, "*.part*.txt")):
+        base = re.sub (r"\.(rank|part)\d+\.txt$", ".txt", name)
+        if base != name:
+            traces.setdefault (base, []).append (name)
+
+    for base, names in traces.items ():
+        header = None
+        rows = {}
+        order = []
+        for name in sorted (names):
+            with open (name) as f:
+                header = f.readline ().split ()
+                summed = [i for i, c in enumerate (header) if c in RANK_SUMMED_COLUMNS]
+                for line in f:
+                    row = line.split ()
+                    if not row:
+                        continue
+                    if not summed:
+                        order.append ((float (row[0]), len (order), row))
+                        continue
+                    # Nodes of other ranks are reported with zero counters
+                    key = tuple ([c for i, c in enumerate (row) if i not in summed])
+                    if key in rows:
+                        for i in summed:
+                            rows[key][i] = "%g" % (float (rows[key][i]) + float (row[i]))
+                    else:
+                        rows[key] = row
+                        order.append ((float (row[0]), len (order), row))
+        order.sort ()
+        with open (base, "w") as f:
+            f.write ("\t".join (header) + "\n")
+            for time, i, row in order:
+                f.write ("\t".join (row) + "\n")
+        for name in names:
+            os.remove (name)
+
+class MpiBenchmark (ScalingBenchmark):
+    "Speedup of disaster-ccn-scenario1v1 with one campus per MPI rank over the sequential run"
+    keys = ["campuses", "ranks"]
+    extra = ["speedup"]
+
+    def __init__ (self, name, campuses, maxRanks=multiprocessing.cpu_count (), **kwargs):
+        ScalingBenchmark.__init__ (self, name, campuses, **kwargs)
+        self.maxRanks = maxRanks
+
+    def simulate (self):
+        for n in self.campuses:
+            sequential = self.run_once (n)
+            sequential["ranks"] = 1
+            self.results.append (sequential)
+
+            ranks = min (n, self.maxRanks)
+            # Same command line as waf --run ... --mpi=<ranks>
+            result = self.run_once (n, ["--SimulatorImplementationType=ns3::DistributedSimulatorImpl", "--mpi=1"],
+                                    launcher=["openmpirun", "-np", str (ranks)])
+            merge_rank_traces ()
+            result["ranks"] = ranks
+            try:
+                result["speedup"] = float (sequential["run"]) / float (result["run"])
+            except (KeyError, ValueError, ZeroDivisionError):
+                result["speedup"] = "NA"
+            self.results.append (result)
+
+class ParallelBenchmark (ScalingBenchmark):
+    "Speedup of disaster-ccn-scenario1v1 with one campus per ns3::CampusParallelSimulatorImpl partition, and whether its traces match the sequential run"
+    # CampusParallelSimulatorImpl is meant to match the sequential run, but
+    # that was never verified with ns-3 and ndnSIM: "identical" is the check.
+    # It runs on one thread, as ns-3 packets are not thread-safe
+    keys = ["campuses", "simulator"]
+    extra = ["speedup", "identical"]
+
+    def trace_digests (self, n):
+        "Digest of every trace of the last run but its memory use, by file name"
+        pattern = "results/disaster1-ccn-*-%02d-%03d-%03d-%012d*.txt" % (
+            n, n, n * self.clientsPerCampus, self.contentsize)
+        digests = {}
+        for name in glob.glob (pattern):
+            if "-memory-" in name:
+                continue
+            digest = hashlib.sha1 ()
+            with open (name, "rb") as f:
+                for chunk in iter (lambda: f.read (1 << 20), b""):
+                    digest.update (chunk)
+            digests[name] = digest.hexdigest ()
+        return digests
+
+    def simulate (self):
+        for n in self.campuses:
+            # Same partitions, hence the same links and trace files, in both runs
+            partitions = ["--partitions=%d" % n]
+            sequential = self.run_once (n, partitions)
+            sequential["simulator"] = "default"
+            self.results.append (sequential)
+            expected = self.trace_digests (n)
+
+            result = self.run_once (n, partitions + ["--SimulatorImplementationType=ns3::CampusParallelSimulatorImpl"])
+            result["simulator"] = "parallel"
+            result["identical"] = "yes" if expected and self.trace_digests (n) == expected else "no"
+            merge_rank_traces ()
+            try:
+                result["speedup"] = float (sequential["run"]) / float (result["run"])
+            except (KeyError, ValueError, ZeroDivisionError):
+                result["speedup"] = "NA"
+            self.results.append (result)
+
+class SchedulerBenchmark (ScalingBenchmark):
+    "Run time and event rate of each scenario with each event scheduler"
+    stats = []
+    keys = ["scenario", "scheduler"]
+    extra = ["run", "events", "events_per_s"]
+
+    def __init__ (self, name, scenarios, schedulers):
+        self.name = name
+        # (scenario, extra command line arguments)
+        self.scenarios = scenarios
+        self.schedulers = schedulers
+        self.results = []
+
+    def last_sample (self, progress):
+        "Wall time and events of a run, from the last line of its --progressFile"
+        with open (progress) as f:
+            header = f.readline ().split ()
+            row = None
+            for line in f:
+                if line.strip ():
+                    row = dict (zip (header, line.split ()))
+        return float (row["Wall"]), int (row["Events"])
+
+    def simulate (self):
+        devnull = open (os.devnull, "w")
+        for scenario, extra in self.scenarios:
+            for scheduler in self.schedulers:
+                progress = "results/%s-%s-%s.txt" % (self.name, scenario, scheduler)
+                # The scheduler is not part of the run cache key
+                cmdline = ["./build/%s" % scenario, "--scheduler=%s" % scheduler,
+                           "--progressFile=%s" % progress, "--cache=false"] + extra
+                print (" ".join (cmdline))
+                if os.path.exists (progress):
+                    os.remove (progress)
+                subprocess.call (cmdline, stdout=devnull)
+
+                result = {"scenario": scenario, "scheduler": scheduler}
+                try:
+                    run, events = self.last_sample (progress)
+                    result.update ({"run": run, "events": events,
+                                    "events_per_s": events / run if run > 0 else "NA"})
+                except (IOError, KeyError, TypeError, ValueError):
+                    pass
+                self.results.append (result)
+
+def median (values):
+    values = sorted (values)
+    n = len (values)
+    return (values[(n - 1) // 2] + values[n // 2]) / 2.0
+
+class TimingReport (Processor):
+    "Median phase timings of every scenario configuration, from the PhaseTimer records of the runs, against a baseline"
+
+    def __init__ (self, name, timings="results/timings.jsonl", baseline="results/timings-baseline.txt", tolerance=0.1):
+        self.name = name
+        self.timings = timings
+        self.baseline = baseline
+        # Relative slowdown of the median wall time reported as a regression
+        self.tolerance = tolerance
+
+    def simulate (self):
+        pass
+
+    def postprocess (self):
+        pass
+
+    def read_records (self):
+        "(scenario, arguments) -> {column: [values]}"
+        runs = {}
+        with open (self.timings) as f:
+            for line in f:
+                try:
+                    record = json.loads (line)
+                except ValueError:
+                    # Truncated by a killed run
+                    continue
+                key = (record["scenario"], " ".join (record["args"]))
+                columns = runs.setdefault (key, {})
+                for column in ["wall", "cpu", "events"]:
+                    columns.setdefault (column, []).append (record[column])
+                for phase in record["phases"]:
+                    columns.setdefault (phase["name"], []).append (phase["wall"])
+        return runs
+
+    def read_table (self, name):
+        "(scenario, arguments, column) -> median of a table written by graph ()"
+        table = {}
+        with open (name) as f:
+            f.readline ()
+            for line in f:
+                row = line.rstrip ("\n").split ("\t")
+                if len (row) == 5:
+                    table[(row[0], row[1], row[2])] = float (row[4])
+        return table
+
+    def graph (self):
+        if not os.path.exists (self.timings):
+            print ("No phase timings in %s" % self.timings)
+            return
+        runs = self.read_records ()
+        report = "results/%s.txt" % self.name
+        with open (report, "w") as f:
+            f.write ("scenario\targs\tcolumn\truns\tmedian\n")
+            for (scenario, arguments), columns in sorted (runs.items ()):
+                for column, values in sorted (columns.items ()):
+                    f.write ("%s\t%s\t%s\t%d\t%g\n" % (scenario, arguments, column, len (values), median (values)))
+        print (open (report).read ())
+
+        if not os.path.exists (self.baseline):
+            print ("No baseline, copy %s to %s to compare later runs" % (report, self.baseline))
+            return
+        baseline = self.read_table (self.baseline)
+        current = self.read_table (report)
+        for key in sorted (current):
+            scenario, arguments, column = key
+            if column == "events" or key not in baseline or baseline[key] <= 0:
+                continue
+            change = current[key] / baseline[key] - 1
+            if change > self.tolerance:
+                print ("REGRESSION %s %s %s: %g s, baseline %g s (%+.0f%%)" % (
+                    scenario, arguments, column, current[key], baseline[key], change * 100))
+
 try:
     # Simulation, processing, and graph building
     fig = Scenario (name="NAME_TO_CONFIGURE")
     fig.run ()
 
+    # Where the ring-of-campuses model stops scaling
+    scaling = ScalingBenchmark (name="scaling", campuses=[8, 16, 32], wallBudget=3600)
+    scaling.run ()
+
+    backbones = BackboneBenchmark (name="backbones", backbones=["ring", "mesh", "star", "tree", "torus"],
+                                   campuses=16)
+    backbones.run ()
+
+    # Standard NMS run, 15 clients on 3 campuses
+    stacks = StackBenchmark (name="stacks", modes=[("ipv4+ndn", ["--ip=true"]),
+                                                   ("ndn", []),
+                                                   ("ndn-selective", ["--ndnStack=selective"])],
+                             campuses=[3], clientsPerCampus=5)
+    stacks.run ()
+
+    # One campus per rank on the local machine
+    mpi = MpiBenchmark (name="mpi", campuses=[4, 8, 16])
+    mpi.run ()
+
+    # The same in partitions, "identical" tells whether they match
+    parallel = ParallelBenchmark (name="parallel", campuses=[4, 8, 16])
+    parallel.run ()
+
+    # Every scenario that runs without input files, with every scheduler
+    schedulers = SchedulerBenchmark (name="schedulers",
+                                     scenarios=[("disaster-ccn-scenario1v1", ["--networks=8", "--servers=8",
+                                                                              "--clients=400", "--stopTime=10"]),
+                                                ("disaster-ccn-scenario1_zl", []),
+                                                ("disaster-ccn-server-random", []),
+                                                ("disaster-ccn-with-routing", []),
+                                                ("nms-disaster-ccn", []),
+                                                ("nms-disaster-ccn_zl", []),
+                                                ("ccn-s1", []),
+                                                ("smart-grid-campus-ccn", []),
+                                                ("smart-grid-campus-tcp", []),
+                                                ("disaster-tcp", []),
+                                                ("disaster-tcp-onoff-scenario1", []),
+                                                ("tcp-s1", [])],
+                                     schedulers=["map", "list", "heap", "calendar", "ladder"])
+    schedulers.run ()
+
+    # After the other benchmarks, which append their runs to the timings
+    timings = TimingReport (name="timings")
+    timings.run ()
+
 finally:
     pool.join ()
     pool.shutdown ()
@@ -86,169 +86,56 @@
 #include <ns3-dev/ns3/ndnSIM/utils/tracers/ipv4-rate-l3-tracer.h>
 #include <ns3-dev/ns3/ndnSIM/utils/tracers/ipv4-seqs-app-tracer.h>
 
+#include "campus-placement.h"
+#include "campus-topology-builder.h"
+#include "counting-scheduler.h"
+#include "memory-accounting.h"
+#include "phase-timer.h"
+#include "progress-reporter.h"
+#include "run-cache.h"
+#include "scenario-random.h"
+
 using namespace ns3;
 using namespace boost;
 
 namespace br = boost::random;
 
-typedef struct timeval TIMER_TYPE;
-#define TIMER_NOW(_t) gettimeofday (&_t,NULL);
-//#define TIMER_SECONDS(_t) ((double)(_t).tv_sec + (_t).tv_usec*1e-6)
-//#define TIMER_DIFF(_t1, _t2) (TIMER_SECONDS (_t1)-TIMER_SECONDS (_t2))
-
 NS_LOG_COMPONENT_DEFINE ("CampusNetworkModel");
 //NS_LOG_INFO ("Obtaining the clients and servers");
-// Number generator
-br::mt19937_64 gen;
-
-// Obtains a random number from a uniform distribution between min and max.
-// Must seed number generator to ensure randomness at runtime.
-int obtain_Num(int min, int max) {
-    br::uniform_int_distribution<> dist(min, max);
-    return dist(gen);
-}
-
-
-
-
-
-// Obtains a random list of clients and servers. Must be run once all nodes have been
-// created to function correctly
-
-
-tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > assignClientsandServers(int num_clients, int num_servers) {
-
-	char buffer[250];
-
-	// Obtain the global list of Nodes in the simulation
-	NodeContainer global = NodeContainer::GetGlobal ();
-
-	// Get the number of nodes in the simulation
-	uint32_t size = global.GetN ();
+// Random draws of the scenario, set by --RngSeed and --RngRun
+ScenarioRandom rng;
 
-	sprintf(buffer, "assignClientsandServers, we have %d nodes", size);
+// Draws random clients among the LAN hosts and servers among the Net1 routers,
+// from the placement substream. Must be run once the topology is built
+tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > assignClientsandServers(const CampusTopologyBuilder &topology, int num_clients, int num_servers) {
 
-	NS_LOG_INFO (buffer);
+	CampusPlacement placement (topology.GetIndex ());
+	std::vector<uint32_t> clientIds = placement.Sample (CampusPlacement::LAN_HOST, num_clients, rng.Get (ScenarioRandom::PLACEMENT));
+	std::vector<uint32_t> serverIds = placement.Sample (CampusPlacement::NET1_ROUTER, num_servers, rng.Get (ScenarioRandom::PLACEMENT));
 
-	sprintf(buffer, "assignClientsandServers, %d clients, %d servers", num_clients, num_servers);
-
-	// Check that we haven't asked for a scenario where we don't have enough Nodes to fulfill
-	// the requirements
-	if (num_clients + num_servers > size) {
-		return tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > ();
-	}
-
-    std::vector<Ptr<Node> > globalmutable;
-
-	// Copy the global list into a mutable vector
-	for (uint32_t i = 0; i < size; i++) {
-		globalmutable.push_back (global.Get(i));
-	}
-
-	uint32_t clientMin = size - num_clients - 1;
-	uint32_t serverMin = clientMin - num_servers;
+	NS_LOG_INFO ("assignClientsandServers, " << num_clients << " clients, " << num_servers << " servers");
 
 	std::vector<Ptr<Node> > ClientContainer;
 	std::vector<Ptr<Node> > ServerContainer;
 
-	// Apply Fisher-Yates shuffle - start with clients
-	for (uint32_t i = size-1; i > clientMin; i--) {
-		// Get a random number
-		int toSwap = obtain_Num (0, i);
-		// Push into the client container the number we got from the global vector
-		ClientContainer.push_back (globalmutable[toSwap]);
-		// Swap the obtained number with the last element
-		std::swap (globalmutable[toSwap], globalmutable[i]);
-	}
-        
-    // Apply Fisher-Yates shuffle - servers
-	for (uint32_t i = clientMin; i > serverMin; i--) {
-		// Get a random number
-		int toSwap = obtain_Num(0, i);
-		// Push into the client container the number we got from the global vector
-		ServerContainer.push_back(globalmutable[toSwap]);
-		// Swap the obtained number with the last element
-		std::swap (globalmutable[toSwap], globalmutable[i]);
-	}
-    
-    
-    return tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > (ClientContainer,ServerContainer);
-}
-
-
-
+	for (uint32_t i = 0; i < clientIds.size (); i++)
+		ClientContainer.push_back (topology.GetNode (clientIds[i]));
+	for (uint32_t i = 0; i < serverIds.size (); i++)
+		ServerContainer.push_back (topology.GetNode (serverIds[i]));
 
-
-    
-
-void Progress()
-{
-	Simulator::Schedule (Seconds (0.1), Progress);
+	return tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > (ClientContainer,ServerContainer);
 }
 
-template <typename T>
-class Array2D
-{
-public:
-	Array2D (const size_t x, const size_t y) : p (new T*[x]), m_xMax (x)
-	{
-		for (size_t i = 0; i < m_xMax; i++)
-			p[i] = new T[y];
-	}
-
-	~Array2D (void)
-	{
-		for (size_t i = 0; i < m_xMax; i++)
-			delete[] p[i];
-		delete p;
-		p = 0;
-	}
-
-	T* operator[] (const size_t i)
-	{
-		return p[i];
-	}
-
-private:
-	T** p;
-	const size_t m_xMax;
-};
 
-template <typename T>
-class Array3D
-{
-public:
-	Array3D (const size_t x, const size_t y, const size_t z) : p (new Array2D<T>*[x]), m_xMax (x)
-	{
-		for (size_t i = 0; i < m_xMax; i++)
-			p[i] = new Array2D<T> (y, z);
-	}
 
-	~Array3D (void)
-	{
-		for (size_t i = 0; i < m_xMax; i++)
-		{
-			delete p[i];
-			p[i] = 0;
-		}
-		delete[] p;
-		p = 0;
-	}
 
-	Array2D<T>& operator[] (const size_t i)
-	{
-		return *(p[i]);
-	}
 
-private:
-	Array2D<T>** p;
-	const size_t m_xMax;
-};
+    
 
 int main (int argc, char *argv[])
 {
-    TIMER_TYPE t0;
-	TIMER_NOW (t0);    
+    PhaseTimer timer ("disaster-ccn-scenario1_zl", argc, argv);
+    MemoryAccounting memory;
     std::cout << " ==== DARPA NMS CAMPUS NETWORK SIMULATION ====" << std::endl;
 
     // These are our scenario arguments
@@ -265,6 +152,11 @@ int main (int argc, char *argv[])
     // Char array for output strings
 	char buffer[250];
 
+    std::string eventScheduler = "map";
+    double progress = 10;
+    std::string progressFile = "";
+    std::string timings = "results/timings.jsonl";
+    bool cache = true;
     CommandLine cmd;
 	cmd.AddValue ("CN", "Number of total CNs [2]", nCN);
 	cmd.AddValue ("LAN", "Number of nodes per LAN [42]", nLANClients);
@@ -275,335 +167,53 @@ int main (int argc, char *argv[])
 	cmd.AddValue ("servers", "Total number of servers in the network", servers);
 	cmd.AddValue ("networks", "Number of networks in the simulation", networks);
 	cmd.AddValue ("results", "Directory to place results", results);
+	cmd.AddValue ("scheduler", "Event scheduler: map|list|heap|calendar|ladder [map]", eventScheduler);
+	cmd.AddValue ("progress", "Wall-clock seconds between progress reports, 0 to disable [10]", progress);
+	cmd.AddValue ("progressFile", "Progress time series file [none]", progressFile);
+	cmd.AddValue ("timings", "File the phase timings of the run are appended to, empty for none [results/timings.jsonl]", timings);
+	cmd.AddValue ("cache", "Skip the run if results/run-cache.txt has its results [true]", cache);
 	cmd.Parse (argc,argv);
 
-    std::cout << "Number of CNs: " << nCN << ", LAN nodes: " << nLANClients << std::endl;
-    
-    // NodeContainer Vectors
-	Array2D<NodeContainer> nodes_net0(nCN, 3);
-	Array2D<NodeContainer> nodes_net1(nCN, 6);
-	NodeContainer* nodes_netLR = new NodeContainer[nCN];
-	Array2D<NodeContainer> nodes_net2(nCN, 14);
-	Array3D<NodeContainer> nodes_net2LAN(nCN, 7, nLANClients);
-	Array2D<NodeContainer> nodes_net3(nCN, 9);
-	Array3D<NodeContainer> nodes_net3LAN(nCN, 5, nLANClients);
-
-    // P2PHelper
-	PointToPointHelper p2p_2gb200ms, p2p_1gb5ms, p2p_100mb1ms;
-    
-    // StackHelper	
-    InternetStackHelper stack;
-	
-    // InterfaceContainer
-    Ipv4InterfaceContainer ifs;
-	Array2D<Ipv4InterfaceContainer> ifs0(nCN, 3);
-	Array2D<Ipv4InterfaceContainer> ifs1(nCN, 6);
-	Array2D<Ipv4InterfaceContainer> ifs2(nCN, 14);
-	Array2D<Ipv4InterfaceContainer> ifs3(nCN, 9);
-	Array3D<Ipv4InterfaceContainer> ifs2LAN(nCN, 7, nLANClients);
-	Array3D<Ipv4InterfaceContainer> ifs3LAN(nCN, 5, nLANClients);
-
-	// Ipv4AddressHelper
-    Ipv4AddressHelper address;
-	std::ostringstream oss;
-	p2p_1gb5ms.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
-	p2p_1gb5ms.SetChannelAttribute ("Delay", StringValue ("5ms"));
-	p2p_2gb200ms.SetDeviceAttribute ("DataRate", StringValue ("2Gbps"));
-	p2p_2gb200ms.SetChannelAttribute ("Delay", StringValue ("200ms"));
-	p2p_100mb1ms.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
-	p2p_100mb1ms.SetChannelAttribute ("Delay", StringValue ("1ms"));
-
-    // Setup NixVector Routing
-	Ipv4NixVectorHelper nixRouting;
-	Ipv4StaticRoutingHelper staticRouting;
-
-	Ipv4ListRoutingHelper list;
-	list.Add (staticRouting, 0);
-	list.Add (nixRouting, 10);
-
-	if (nix)
+	// Count events for the progress reports, over the chosen scheduler
+	ObjectFactory scheduler;
+	scheduler.SetTypeId ("ns3::CountingScheduler");
+	TypeId schedulerType;
+	if (!CountingScheduler::LookupScheduler (eventScheduler, &schedulerType))
 	{
-		stack.SetRoutingHelper (list); // has effect on the next Install ()
+		std::cout << "Unknown scheduler: " << eventScheduler << std::endl;
+		return 1;
 	}
-
-
-    // Create Campus Networks
-	for (int z = 0; z < nCN; ++z)
+	scheduler.Set ("Scheduler", TypeIdValue (schedulerType));
+	Simulator::SetScheduler (scheduler);
+
+	// Runs with the same configuration and binary give the same results
+	RunCache runCache ("disaster-ccn-scenario1_zl", argc, argv);
+	const char *ignored[] = { "progress", "progressFile", "timings", "scheduler", "cache" };
+	for (uint32_t i = 0; i < sizeof (ignored) / sizeof (ignored[0]); i++)
+		runCache.Ignore (ignored[i]);
+	if (cache && runCache.Lookup ())
 	{
-		std::cout << "Creating Campus Network " << z << ":" << std::endl;
-		// Create SubNet0
-		std::cout << "  SubNet [ 0"; //0
-		for (int i = 0; i < 3; ++i)
-		{
-			nodes_net0[z][i].Create (1);
-			stack.Install (nodes_net0[z][i]);
-		}
-
-		nodes_net0[z][0].Add (nodes_net0[z][1].Get (0));
-		nodes_net0[z][1].Add (nodes_net0[z][2].Get (0));
-		nodes_net0[z][2].Add (nodes_net0[z][0].Get (0));
-		NetDeviceContainer ndc0[3];
-
-		for (int i = 0; i < 3; ++i)
-		{
-			ndc0[i] = p2p_1gb5ms.Install (nodes_net0[z][i]);
-		}
-
-		// Create SubNet1
-		std::cout << " 1";//1
-		for (int i = 0; i < 6; ++i)
-		{
-			nodes_net1[z][i].Create (1);
-			stack.Install(nodes_net1[z][i]);
-		}
-
-		nodes_net1[z][0].Add (nodes_net1[z][1].Get (0));
-		nodes_net1[z][2].Add (nodes_net1[z][0].Get (0));
-		nodes_net1[z][3].Add (nodes_net1[z][0].Get (0));
-		nodes_net1[z][4].Add (nodes_net1[z][1].Get (0));
-		nodes_net1[z][5].Add (nodes_net1[z][1].Get (0));
-		NetDeviceContainer ndc1[6];
-
-		for (int i = 0; i < 6; ++i)
-		{
-			if (i == 1)
-			{
-				continue;
-			}
-
-			ndc1[i] = p2p_1gb5ms.Install (nodes_net1[z][i]);
-		}
-
-		// Connect SubNet0 <-> SubNet1
-		NodeContainer net0_1;
-		net0_1.Add (nodes_net0[z][2].Get (0));
-		net0_1.Add (nodes_net1[z][0].Get (0));
-		NetDeviceContainer ndc0_1;
-		ndc0_1 = p2p_1gb5ms.Install(net0_1);
-		oss.str ("");
-		oss << 10 + z << ".1.252.0";
-		address.SetBase(oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign(ndc0_1);
-
-		// Create SubNet2
-		std::cout << " 2";//2
-		for (int i = 0; i < 14; ++i)
-		{
-			nodes_net2[z][i].Create (1);
-			stack.Install(nodes_net2[z][i]);
-		}
-
-		nodes_net2[z][0].Add (nodes_net2[z][1].Get (0));
-		nodes_net2[z][2].Add (nodes_net2[z][0].Get (0));
-		nodes_net2[z][1].Add (nodes_net2[z][3].Get (0));
-		nodes_net2[z][3].Add (nodes_net2[z][2].Get (0));
-		nodes_net2[z][4].Add (nodes_net2[z][2].Get (0));
-		nodes_net2[z][5].Add (nodes_net2[z][3].Get (0));
-		nodes_net2[z][6].Add (nodes_net2[z][5].Get (0));
-		nodes_net2[z][7].Add (nodes_net2[z][2].Get (0));
-		nodes_net2[z][8].Add (nodes_net2[z][3].Get (0));
-		nodes_net2[z][9].Add (nodes_net2[z][4].Get (0));
-		nodes_net2[z][10].Add (nodes_net2[z][5].Get (0));
-		nodes_net2[z][11].Add (nodes_net2[z][6].Get (0));
-		nodes_net2[z][12].Add (nodes_net2[z][6].Get (0));
-		nodes_net2[z][13].Add (nodes_net2[z][6].Get (0));
-		NetDeviceContainer ndc2[14];
-
-        for (int i = 0; i < 14; ++i)
-		{
-			ndc2[i] = p2p_1gb5ms.Install (nodes_net2[z][i]);
-		}
-		
-        ///      NetDeviceContainer ndc2LAN[7][nLANClients];
-		Array2D<NetDeviceContainer> ndc2LAN(7, nLANClients);
-		for (int i = 0; i < 7; ++i)
-		{
-			oss.str ("");
-			oss << 10 + z << ".4." << 15 + i << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-			for (int j = 0; j < nLANClients; ++j)
-			{
-				nodes_net2LAN[z][i][j].Create (1);
-				stack.Install (nodes_net2LAN[z][i][j]);
-				nodes_net2LAN[z][i][j].Add (nodes_net2[z][i+7].Get (0));
-				ndc2LAN[i][j] = p2p_100mb1ms.Install (nodes_net2LAN[z][i][j]);
-				ifs2LAN[z][i][j] = address.Assign (ndc2LAN[i][j]);
-			}
-		}
-
-		// Create SubNet3
-		std::cout << " 3 ]" << std::endl;//3
-		for (int i = 0; i < 9; ++i)
-		{
-			nodes_net3[z][i].Create (1);
-			stack.Install (nodes_net3[z][i]);
-		}
-
-		nodes_net3[z][0].Add (nodes_net3[z][1].Get (0));
-		nodes_net3[z][1].Add (nodes_net3[z][2].Get (0));
-		nodes_net3[z][2].Add (nodes_net3[z][3].Get (0));
-		nodes_net3[z][3].Add (nodes_net3[z][1].Get (0));
-		nodes_net3[z][4].Add (nodes_net3[z][0].Get (0));
-		nodes_net3[z][5].Add (nodes_net3[z][0].Get (0));
-		nodes_net3[z][6].Add (nodes_net3[z][2].Get (0));
-		nodes_net3[z][7].Add (nodes_net3[z][3].Get (0));
-		nodes_net3[z][8].Add (nodes_net3[z][3].Get (0));
-		NetDeviceContainer ndc3[9];
-		for (int i = 0; i < 9; ++i)
-		{
-			ndc3[i] = p2p_1gb5ms.Install (nodes_net3[z][i]);
-		}
-		
-        ///      NetDeviceContainer ndc3LAN[5][nLANClients];
-		Array2D<NetDeviceContainer> ndc3LAN(5, nLANClients);
-		for (int i = 0; i < 5; ++i)
-		{
-			oss.str ("");
-			oss << 10 + z << ".5." << 10 + i << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.255");
-			for (int j = 0; j < nLANClients; ++j)
-			{
-				nodes_net3LAN[z][i][j].Create (1);
-				stack.Install (nodes_net3LAN[z][i][j]);
-				nodes_net3LAN[z][i][j].Add (nodes_net3[z][i+4].Get (0));
-				ndc3LAN[i][j] = p2p_100mb1ms.Install (nodes_net3LAN[z][i][j]);
-				ifs3LAN[z][i][j] = address.Assign (ndc3LAN[i][j]);
-			}
-		}
-
-		std::cout << "  Connecting Subnets..." << std::endl;
-
-		// Create Lone Routers (Node 4 & 5)
-		nodes_netLR[z].Create (2);
-		stack.Install (nodes_netLR[z]);
-		NetDeviceContainer ndcLR;
-		ndcLR = p2p_1gb5ms.Install (nodes_netLR[z]);
-
-		// Connect Net2/Net3 through Lone Routers to Net0
-		NodeContainer net0_4, net0_5, net2_4a, net2_4b, net3_5a, net3_5b;
-		net0_4.Add (nodes_netLR[z].Get (0));
-		net0_4.Add (nodes_net0[z][0].Get (0));
-		net0_5.Add (nodes_netLR[z].Get  (1));
-		net0_5.Add (nodes_net0[z][1].Get (0));
-		net2_4a.Add (nodes_netLR[z].Get (0));
-		net2_4a.Add (nodes_net2[z][0].Get (0));
-		net2_4b.Add (nodes_netLR[z].Get (1));
-		net2_4b.Add (nodes_net2[z][1].Get (0));
-		net3_5a.Add (nodes_netLR[z].Get (1));
-		net3_5a.Add (nodes_net3[z][0].Get (0));
-		net3_5b.Add (nodes_netLR[z].Get (1));
-		net3_5b.Add (nodes_net3[z][1].Get (0));
-
-        NetDeviceContainer ndc0_4, ndc0_5, ndc2_4a, ndc2_4b, ndc3_5a, ndc3_5b;
-		ndc0_4 = p2p_1gb5ms.Install (net0_4);
-		oss.str ("");
-		oss << 10 + z << ".1.253.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndc0_4);
-		ndc0_5 = p2p_1gb5ms.Install (net0_5);
-		oss.str ("");
-		oss << 10 + z << ".1.254.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndc0_5);
-		ndc2_4a = p2p_1gb5ms.Install (net2_4a);
-		oss.str ("");
-		oss << 10 + z << ".4.253.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndc2_4a);
-		ndc2_4b = p2p_1gb5ms.Install (net2_4b);
-		oss.str ("");
-		oss << 10 + z << ".4.254.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndc2_4b);
-		ndc3_5a = p2p_1gb5ms.Install (net3_5a);
-		oss.str ("");
-		oss << 10 + z << ".5.253.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndc3_5a);
-		ndc3_5b = p2p_1gb5ms.Install (net3_5b);
-		oss.str ("");
-		oss << 10 + z << ".5.254.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndc3_5b);
-		
-        // Assign IP addresses
-		std::cout << "  Assigning IP addresses..." << std::endl;
-
-        for (int i = 0; i < 3; ++i)
-		{
-			oss.str ("");
-			oss << 10 + z << ".1." << 1 + i << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-			ifs0[z][i] = address.Assign (ndc0[i]);
-		}
-
-		for (int i = 0; i < 6; ++i)
-		{
-			if (i == 1)
-			{
-				continue;
-			}
-			oss.str ("");
-			oss << 10 + z << ".2." << 1 + i << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-			ifs1[z][i] = address.Assign (ndc1[i]);
-		}
-
-		oss.str ("");
-		oss << 10 + z << ".3.1.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndcLR);
-
-		for (int i = 0; i < 14; ++i)
-		{
-			oss.str ("");
-			oss << 10 + z << ".4." << 1 + i << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-			ifs2[z][i] = address.Assign (ndc2[i]);
-		}
-
-		for (int i = 0; i < 9; ++i)
-		{
-			oss.str ("");
-			oss << 10 + z << ".5." << 1 + i << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-			ifs3[z][i] = address.Assign (ndc3[i]);
-		}
+		runCache.PrintHit (std::cout);
+		return 0;
 	}
+
+    std::cout << "Number of CNs: " << nCN << ", LAN nodes: " << nLANClients << std::endl;
     
-    // Create Ring Links
-	if (nCN > 1)
-	{
-		std::cout << "Forming Ring Topology..." << std::endl;
-		NodeContainer* nodes_ring = new NodeContainer[nCN];
-		for (int z = 0; z < nCN-1; ++z)
-		{
-			nodes_ring[z].Add (nodes_net0[z][0].Get (0));
-			nodes_ring[z].Add (nodes_net0[z+1][0].Get (0));
-		}
-		nodes_ring[nCN-1].Add (nodes_net0[nCN-1][0].Get (0));
-		nodes_ring[nCN-1].Add (nodes_net0[0][0].Get (0));
-		NetDeviceContainer* ndc_ring = new NetDeviceContainer[nCN];
-		for (int z = 0; z < nCN; ++z)
-		{
-			ndc_ring[z] = p2p_2gb200ms.Install (nodes_ring[z]);
-			oss.str ("");
-			oss << "254.1." << z + 1 << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-			ifs = address.Assign (ndc_ring[z]);
-		}
-		delete[] ndc_ring;
-		delete[] nodes_ring;
-	}
+    // NodeContainer Vectors
+	CampusTopologyBuilder topology;
+	topology.SetLanSize (nLANClients);
+	topology.SetNixVectorRouting (nix);
+	// NDN traffic only, IPv4 is left to the TCP scenarios
+	topology.SetInternetStack (false);
+	timer.Start ("topology");
+	topology.Build (nCN);
 
-    // Make sure to seed our random
-	gen.seed(std::time(0));
 
     // With the network assigned, time to randomly obtain clients 
 	NS_LOG_INFO ("Obtaining the clients");
 	// Obtain the random lists of clients
 	//tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > t = assignClientsandServers(clients, servers);
-    tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > t = assignClientsandServers(clients, 0);
+    tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > t = assignClientsandServers (topology, clients, 0);
 	// Separate the tuple into clients and servers
 	std::vector<Ptr<Node> > clientVector = t.get<0> ();
 	std::vector<Ptr<Node> > serverVector = t.get<1> ();
@@ -629,24 +239,30 @@ int main (int argc, char *argv[])
 		}
 
     // server NodeContainer
-    Ptr<Node> server_tmp = nodes_net1[0][5].Get (0);
+    Ptr<Node> server_tmp = topology.GetCampus (0).Net1 (5);
     uint32_t server_nodeNum = server_tmp->GetId();
 	
     serverNodes.Add(server_tmp);
 	serverNodeIds.push_back(server_nodeNum);
 
    
+    memory.Mark ("topology");
+    timer.Start ("ndn-stack");
     ndn::StackHelper ndnHelper;
     // Install Content Store    
     ndnHelper.SetContentStore("ns3::ndn::cs::Freshness::Lru","MaxSize","3072");// 30% of whole contents
 	ndnHelper.InstallAll ();
 	
+    memory.Mark ("ndn-stack");
+    timer.Start ("routing");
     ndn::GlobalRoutingHelper ndnGlobalRoutingHelper1;
 	ndnGlobalRoutingHelper1.InstallAll ();
 	ndnGlobalRoutingHelper1.AddOrigins ("/Dinfo/tokyo/shinjuku/waseda-u/waseda", serverNodes);
 	ndn::GlobalRoutingHelper::CalculateRoutes ();    
     
+    memory.Mark ("routing");
     // Consumer
+    timer.Start ("apps");
     ndn::AppHelper consumerHelper ("ns3::ndn::ConsumerCbr");
 	// Consumer will request /prefix/0, /prefix/1, ...
 	consumerHelper.SetPrefix ("/Dinfo/tokyo/shinjuku/waseda-u/waseda/subnet");
@@ -670,7 +286,9 @@ int main (int argc, char *argv[])
 	producerHelper.Install (serverNodes.Get(0));
 
 
+	memory.Mark ("apps");
     // Obtain metrics
+	timer.Start ("tracers");
 	char filename[250];
 
 	// Print server nodes to file
@@ -683,6 +301,7 @@ int main (int argc, char *argv[])
 		serverFile << serverNodeIds[i] << std::endl;
 	}
 	serverFile.close();
+	runCache.AddOutput (filename);
     
 
 	sprintf(filename, "%s/disaster1-ccn-clients-%02d-%03d-%03d-%0*d.txt", results, networks, servers, clients, 12, contentsize);
@@ -693,31 +312,68 @@ int main (int argc, char *argv[])
 		clientFile << clientNodeIds[i] << std::endl;
 	}
 	clientFile.close();
+	runCache.AddOutput (filename);
 
 	sprintf (filename, "%s/disaster1-ccn-aggregate-trace-%02d-%03d-%03d-%0*d.txt", results, networks, servers, clients, 12, contentsize);
 	ndn::L3AggregateTracer::InstallAll(filename, Seconds (1.0));
+	runCache.AddOutput (filename);
 
 	sprintf (filename, "%s/disaster1-ccn-rate-trace-%02d-%03d-%03d-%0*d.txt", results, networks, servers, clients, 12, contentsize);
 	ndn::L3RateTracer::InstallAll (filename, Seconds (1.0));
+	runCache.AddOutput (filename);
 
 	sprintf (filename, "%s/disaster1-ccn-app-delays-trace-%02d-%03d-%03d-%0*d.txt", results, networks, servers, clients, 12, contentsize);
 	ndn::AppDelayTracer::InstallAll (filename);
+	runCache.AddOutput (filename);
 
 	sprintf (filename, "%s/disaster1-ccn-drop-trace-%02d-%03d-%03d-%0*d.txt", results, networks, servers, clients, 12, contentsize);
 	L2RateTracer::InstallAll (filename, Seconds (0.5));
+	runCache.AddOutput (filename);
 
 	sprintf (filename, "%s/disaster1-ccn-cs-trace-%02d-%03d-%03d-%0*d.txt", results, networks, servers, clients, 12, contentsize);
 	
     ndn::CsTracer::InstallAll (filename, Seconds (0.1));
+    runCache.AddOutput (filename);
 
-	//p2p_1gb5ms.EnablePcap ("results/ccn_test0.pcap", nodes_net1[0][5].Get (0)->GetId (), true,true);
+	//topology.GetCampusLinkHelper ().EnablePcap ("results/ccn_test0.pcap", topology.GetCampus (0).Net1 (5)->GetId (), true,true);
     sprintf (filename, "%s/ccn_server-%02d-%03d-%03d-%0*d.pcap", results, networks, servers, clients, 12, contentsize);
-    p2p_1gb5ms.EnablePcap (filename, 8, true,true);
-	//p2p_1gb5ms.EnablePcap ("results/tcp_test1.pcap", serverNodes.Get(1)->GetId (), true,true);
+    topology.GetCampusLinkHelper ().EnablePcap (filename, 8, true,true);
+    runCache.AddOutput (PcapHelper ().GetFilenameFromDevice (filename, NodeList::GetNode (8)->GetDevice (1)));
+	//topology.GetCampusLinkHelper ().EnablePcap ("results/tcp_test1.pcap", serverNodes.Get(1)->GetId (), true,true);
 	
     Simulator::Stop (Seconds (90.0));
+	ProgressReporter reporter;
+	reporter.SetInterval (progress);
+	reporter.SetOutput (progressFile);
+	reporter.Start (Seconds (90.0));
+	memory.Mark ("tracers");
+	timer.Start ("run");
 	Simulator::Run ();
+	CountingScheduler::Finish ();
+	reporter.Stop ();
+	memory.Mark ("run");
+	// The tables are gone once the simulator is destroyed
+	memory.EstimateTables (NodeContainer::GetGlobal ());
+	timer.Start ("teardown");
 	Simulator::Destroy ();
+	timer.Stop ();
+	memory.Mark ("teardown");
+	sprintf (filename, "%s/disaster1-ccn-memory-%02d-%03d-%03d-%0*d.txt", results, networks, servers, clients, 12, contentsize);
+	memory.Write (filename);
+	memory.Print (std::cout);
+	runCache.AddOutput (filename);
+	// The tracers close their files only when destroyed, before the sizes
+	// of the files go to the manifest
+	ndn::L3AggregateTracer::Destroy ();
+	ndn::L3RateTracer::Destroy ();
+	ndn::AppDelayTracer::Destroy ();
+	ndn::CsTracer::Destroy ();
+	L2RateTracer::Destroy ();
+	runCache.Commit ();
+	std::cout << "Run cached as " << runCache.GetKeyString () << std::endl;
+	if (!timings.empty ())
+		timer.Write (timings);
+	timer.Print (std::cout);
 	return 0;
 }
 
@@ -42,6 +42,7 @@
 #include <ctime>
 #include <fstream>
 #include <iterator>
+#include <sstream>
 #include <string>
 #include <sys/time.h>
 #include <vector>
@@ -64,6 +65,7 @@
 #include <ns3-dev/ns3/ipv4-list-routing-helper.h>
 #include <ns3-dev/ns3/ipv4-nix-vector-helper.h>
 #include <ns3-dev/ns3/ipv4-static-routing-helper.h>
+#include <ns3-dev/ns3/mpi-interface.h>
 #include <ns3-dev/ns3/network-module.h>
 #include <ns3-dev/ns3/onoff-application.h>
 #include <ns3-dev/ns3/packet-sink.h>
@@ -74,157 +76,93 @@
 #include <ns3-dev/ns3/ndnSIM/utils/tracers/ipv4-rate-l3-tracer.h>
 #include <ns3-dev/ns3/ndnSIM/utils/tracers/ipv4-seqs-app-tracer.h>
 
+#include "campus-consumer-cbr.h"
+#include "campus-placement.h"
+#include "campus-topology-builder.h"
+#include "consumer-zipf-alias.h"
+#include "counting-scheduler.h"
+#include "memory-accounting.h"
+#include "memory-usage.h"
+#include "phase-timer.h"
+#include "progress-reporter.h"
+#include "run-cache.h"
+#include "scenario-random.h"
+#include "seed-forker.h"
+#include "steady-state-detector.h"
+#include "wall-clock-budget.h"
+
 using namespace ns3;
 using namespace boost;
 using namespace std;
 
 namespace br = boost::random;
 
-typedef struct timeval TIMER_TYPE;
-#define TIMER_NOW(_t) gettimeofday (&_t,NULL);
-#define TIMER_SECONDS(_t) ((double)(_t).tv_sec + (_t).tv_usec*1e-6)
-#define TIMER_DIFF(_t1, _t2) (TIMER_SECONDS (_t1)-TIMER_SECONDS (_t2))
-
 NS_LOG_COMPONENT_DEFINE ("CampusNetworkModel");
 
-// Number generator
-br::mt19937_64 gen;
-
-// Obtains a random number from a uniform distribution between min and max.
-// Must seed number generator to ensure randomness at runtime.
-int obtain_Num(int min, int max) {
-    br::uniform_int_distribution<> dist(min, max);
-    return dist(gen);
-}
-
-// Obtains a random list of clients and servers. Must be run once all nodes have been
-// created to function correctly
-tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > assignClientsandServers(int num_clients, int num_servers) {
-
-	char buffer[250];
-
-	// Obtain the global list of Nodes in the simulation
-	NodeContainer global = NodeContainer::GetGlobal ();
-
-	// Get the number of nodes in the simulation
-	uint32_t size = global.GetN ();
-
-	sprintf(buffer, "assignClientsandServers, we have %d nodes", size);
-
-	NS_LOG_INFO (buffer);
-
-	sprintf(buffer, "assignClientsandServers, %d clients, %d servers", num_clients, num_servers);
+// Random draws of the scenario, set by --RngSeed and --RngRun
+ScenarioRandom rng;
 
-	// Check that we haven't asked for a scenario where we don't have enough Nodes to fufill
-	// the requirements
-	if (num_clients + num_servers > size) {
-		return tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > ();
-	}
-
-	std::vector<Ptr<Node> > globalmutable;
+// Draws random clients among the LAN hosts and servers among the Net1 routers,
+// from the placement substream. Must be run once the topology is built
+tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > assignClientsandServers(const CampusTopologyBuilder &topology, int num_clients, int num_servers, CampusPlacement::Strata strata) {
 
-	// Copy the global list into a mutable vector
-	for (uint32_t i = 0; i < size; i++) {
-		globalmutable.push_back (global.Get(i));
-	}
+	CampusPlacement placement (topology.GetIndex ());
+	placement.SetStrata (strata);
+	std::vector<uint32_t> clientIds = placement.Sample (CampusPlacement::LAN_HOST, num_clients, rng.Get (ScenarioRandom::PLACEMENT));
+	std::vector<uint32_t> serverIds = placement.Sample (CampusPlacement::NET1_ROUTER, num_servers, rng.Get (ScenarioRandom::PLACEMENT));
 
-	uint32_t clientMin = size - num_clients - 1;
-	uint32_t serverMin = clientMin - num_servers;
+	NS_LOG_INFO ("assignClientsandServers, " << num_clients << " clients, " << num_servers << " servers");
 
 	std::vector<Ptr<Node> > ClientContainer;
 	std::vector<Ptr<Node> > ServerContainer;
 
-	// Apply Fisher-Yates shuffle - start with clients
-	for (uint32_t i = size-1; i > clientMin; i--) {
-		// Get a random number
-		int toSwap = obtain_Num (0, i);
-		// Push into the client container the number we got from the global vector
-		ClientContainer.push_back (globalmutable[toSwap]);
-		// Swap the obtained number with the last element
-		std::swap (globalmutable[toSwap], globalmutable[i]);
-	}
-
-	// Apply Fisher-Yates shuffle - servers
-	for (uint32_t i = clientMin; i > serverMin; i--) {
-		// Get a random number
-		int toSwap = obtain_Num(0, i);
-		// Push into the client container the number we got from the global vector
-		ServerContainer.push_back(globalmutable[toSwap]);
-		// Swap the obtained number with the last element
-		std::swap (globalmutable[toSwap], globalmutable[i]);
-	}
+	for (uint32_t i = 0; i < clientIds.size (); i++)
+		ClientContainer.push_back (topology.GetNode (clientIds[i]));
+	for (uint32_t i = 0; i < serverIds.size (); i++)
+		ServerContainer.push_back (topology.GetNode (serverIds[i]));
 
 	return tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > (ClientContainer,ServerContainer);
 }
 
-void Progress ()
-{
-	Simulator::Schedule (Seconds (0.1), Progress);
-}
-
-template <typename T>
-class Array2D
-{
-public:
-	Array2D (const size_t x, const size_t y) : p (new T*[x]), m_xMax (x)
-	{
-		for (size_t i = 0; i < m_xMax; i++)
-			p[i] = new T[y];
-	}
+// Reads back the clients that an earlier run on the same topology wrote to
+// file, returns no clients if they are not num_clients LAN hosts
+std::vector<Ptr<Node> > loadClients(const CampusTopologyBuilder &topology, const std::string &file, uint32_t num_clients) {
 
-	~Array2D (void)
-	{
-		for (size_t i = 0; i < m_xMax; i++)
-			delete[] p[i];
-		delete p;
-		p = 0;
-	}
-
-	T* operator[] (const size_t i)
-	{
-		return p[i];
+	CampusPlacement placement (topology.GetIndex ());
+	std::vector<uint32_t> ids;
+	std::vector<Ptr<Node> > ClientContainer;
+	if (!CampusPlacement::ReadNodeIds (file, &ids) || ids.size () != num_clients)
+		return ClientContainer;
+
+	// The builder creates every node, so node IDs are its dense indexes
+	for (uint32_t i = 0; i < ids.size (); i++) {
+		if (!placement.IsEligible (CampusPlacement::LAN_HOST, ids[i]) || topology.GetNode (ids[i])->GetId () != ids[i])
+			return std::vector<Ptr<Node> > ();
+		ClientContainer.push_back (topology.GetNode (ids[i]));
 	}
+	return ClientContainer;
+}
 
-private:
-	T** p;
-	const size_t m_xMax;
-};
-
-template <typename T>
-class Array3D
+// Prefix served by Net1 router 5 of campus z
+std::string campusPrefix (uint32_t z)
 {
-public:
-	Array3D (const size_t x, const size_t y, const size_t z) : p (new Array2D<T>*[x]), m_xMax (x)
-	{
-		for (size_t i = 0; i < m_xMax; i++)
-			p[i] = new Array2D<T> (y, z);
-	}
-
-	~Array3D (void)
-	{
-		for (size_t i = 0; i < m_xMax; i++)
-		{
-			delete p[i];
-			p[i] = 0;
-		}
-		delete[] p;
-		p = 0;
-	}
-
-	Array2D<T>& operator[] (const size_t i)
-	{
-		return *(p[i]);
-	}
-
-private:
-	Array2D<T>** p;
-	const size_t m_xMax;
-};
+	// The first campuses keep the names used in earlier results
+	static const char *names[] = { "wasedau", "nishiwasedau", "toyamawasedau" };
+	std::ostringstream oss;
+	oss << "/Dinfo/tokyo/shinjuku/";
+	if (z < sizeof (names) / sizeof (names[0]))
+		oss << names[z];
+	else
+		oss << "campus" << z;
+	oss << "/net1/server/";
+	return oss.str ();
+}
 
 int main (int argc, char *argv[])
 {
-	TIMER_TYPE t0, t1, t2;
-	TIMER_NOW (t0);
+	PhaseTimer timer ("disaster-ccn-scenario1v1", argc, argv);
+	// Memory at each phase boundary, written next to the traces
+	MemoryAccounting memory;
 	std::cout << " ==== DARPA NMS CAMPUS NETWORK SIMULATION ====" << std::endl;
 
 	// These are our scenario arguments
@@ -232,27 +170,113 @@ int main (int argc, char *argv[])
 	uint32_t clients = 300; // Number of clients in the network
 	uint32_t servers = 2; // Number of servers in the network
 	uint32_t networks = 2; // Number of additional nodes in the network
+	uint32_t clientsPerCampus = 250; // Clients asking for the content of each campus
+	double stopTime = 60.0;
 
 	char results[250] = "results";
 
 	int nCN = 3, nLANClients = 42; 
 	bool nix = true;
+	bool ip = false;
+	std::string snapshot = "";
+	std::string backbone = "ring";
+	std::string ndnStack = "all";
+	bool mpi = false;
+	uint32_t partitions = 1;
+	bool profile = false;
+	uint32_t seeds = 0;
+	uint32_t jobs = 0;
+	double wallBudget = 0;
+	std::string timings = "results/timings.jsonl";
+	std::string placementFile = "";
+	double steadyState = 0;
+	double startJitter = 0;
+	bool cache = true;
+	std::string placement = "none";
+	uint32_t catalog = 0;
+	double zipfQ = 0.7;
+	double zipfS = 0.7;
 	
 	// Char array for output strings
 	char buffer[250];
 
 
 	
+	std::string eventScheduler = "map";
+	double progress = 10;
+	std::string progressFile = "";
 	CommandLine cmd;
 	cmd.AddValue ("CN", "Number of total CNs [2]", nCN);
 	cmd.AddValue ("LAN", "Number of nodes per LAN [42]", nLANClients);
 	cmd.AddValue ("NIX", "Toggle nix-vector routing", nix);
+	cmd.AddValue ("ip", "Install the unused IPv4 stack too, for comparisons [false]", ip);
 	cmd.AddValue ("contentsize",
 				"Total number of bytes for application to send", contentsize);
 	cmd.AddValue ("clients", "Total number of clients in the network", clients);
 	cmd.AddValue ("servers", "Total number of servers in the network", servers);
 	cmd.AddValue ("networks", "Number of networks in the simulation", networks);
+	cmd.AddValue ("clientsPerCampus", "Clients asking for the content of each campus [250]", clientsPerCampus);
+	cmd.AddValue ("stopTime", "Simulated seconds [60]", stopTime);
+	cmd.AddValue ("backbone", "Inter-campus backbone: ring|mesh|star|tree|torus [ring]", backbone);
+	cmd.AddValue ("ndnStack", "NDN stack on LAN hosts: all|selective (minimal stack on idle hosts) [all]", ndnStack);
+	cmd.AddValue ("snapshot", "Topology and FIB snapshot file, written if missing or stale", snapshot);
+	cmd.AddValue ("mpi", "One campus per MPI rank, set by waf --mpi [false]", mpi);
+	cmd.AddValue ("partitions", "Campus partitions for ns3::CampusParallelSimulatorImpl [1]", partitions);
+	cmd.AddValue ("scheduler", "Event scheduler: map|list|heap|calendar|ladder [map]", eventScheduler);
+	cmd.AddValue ("progress", "Wall-clock seconds between progress reports, 0 to disable [10]", progress);
+	cmd.AddValue ("progressFile", "Progress time series file [none]", progressFile);
+	cmd.AddValue ("profile", "Print the wall time of the events by origin at the end [false]", profile);
+	cmd.AddValue ("seeds", "Build once, then run once per RngRun from --RngRun in forked processes, 0 to run in place [0]", seeds);
+	cmd.AddValue ("jobs", "Forked runs at the same time, 0 for one per processor [0]", jobs);
+	cmd.AddValue ("wallBudget", "Wall-clock seconds after which the simulation stops cleanly, 0 for no limit [0]", wallBudget);
+	cmd.AddValue ("steadyState", "Stop once the consumer metrics are known within that relative precision, 0 to run until stopTime [0]", steadyState);
+	cmd.AddValue ("placement", "Clients spread over the LAN hosts: none (uniform)|campus|lan, in proportion to their hosts [none]", placement);
+	cmd.AddValue ("catalog", "Contents per campus, asked for with Zipf-Mandelbrot popularity, 0 for one random name per client [0]", catalog);
+	cmd.AddValue ("zipfQ", "Plateau q of the Zipf-Mandelbrot popularity [0.7]", zipfQ);
+	cmd.AddValue ("zipfS", "Exponent s of the Zipf-Mandelbrot popularity [0.7]", zipfS);
+	cmd.AddValue ("startJitter", "Clients start at a random time in [0, startJitter) seconds [0]", startJitter);
+	cmd.AddValue ("placementFile", "Clients file (*-clients-*.txt) of an earlier run to reuse, e.g. of the other protocol, instead of drawing clients [none]", placementFile);
+	cmd.AddValue ("timings", "File the phase timings of the run are appended to, empty for none [results/timings.jsonl]", timings);
+	cmd.AddValue ("cache", "Skip the run if results/run-cache.txt has its results, not with MPI [true]", cache);
 	cmd.Parse (argc,argv);
+
+	if (servers > networks)
+	{
+		cout << "Too many servers: " << servers << " for " << networks << " networks" << endl;
+		return 1;
+	}
+	if (clientsPerCampus == 0 || clients > clientsPerCampus * networks)
+	{
+		cout << "Too many clients: " << clients << " for " << networks << " networks of "
+				<< clientsPerCampus << " clients" << endl;
+		return 1;
+	}
+
+	// Must come before the first use of the simulator, which creates the
+	// DistributedSimulatorImpl selected on the command line
+	uint32_t rank = 0, nRanks = 1;
+	char rankSuffix[32] = "";
+	if (mpi)
+	{
+		MpiInterface::Enable (&argc, &argv);
+		rank = MpiInterface::GetSystemId ();
+		nRanks = MpiInterface::GetSize ();
+		sprintf (rankSuffix, ".rank%u", rank);
+		std::cout << "MPI rank " << rank << " of " << nRanks << std::endl;
+	}
+
+	// Count events for the runtime stats
+	ObjectFactory scheduler;
+	scheduler.SetTypeId ("ns3::CountingScheduler");
+	TypeId schedulerType;
+	if (!CountingScheduler::LookupScheduler (eventScheduler, &schedulerType))
+	{
+		std::cout << "Unknown scheduler: " << eventScheduler << std::endl;
+		return 1;
+	}
+	scheduler.Set ("Scheduler", TypeIdValue (schedulerType));
+	scheduler.Set ("Profile", BooleanValue (profile));
+	Simulator::SetScheduler (scheduler);
 	/*if (nCN < 2)
 	{
 		std::cout << "Number of total CNs (" << nCN << ") lower than minimum of 2"
@@ -266,323 +290,113 @@ int main (int argc, char *argv[])
 	
     std::cout << "Number of CNs: " << nCN << ", LAN nodes: " << nLANClients << std::endl;
 
-	Array2D<NodeContainer> nodes_net0(nCN, 3);
-	Array2D<NodeContainer> nodes_net1(nCN, 6);
-	NodeContainer* nodes_netLR = new NodeContainer[nCN];
-	Array2D<NodeContainer> nodes_net2(nCN, 14);
-	Array3D<NodeContainer> nodes_net2LAN(nCN, 7, nLANClients);
-	Array2D<NodeContainer> nodes_net3(nCN, 9);
-	Array3D<NodeContainer> nodes_net3LAN(nCN, 5, nLANClients);
-
-	PointToPointHelper p2p_2gb200ms, p2p_1gb5ms, p2p_100mb1ms;
-	InternetStackHelper stack;
-	Ipv4InterfaceContainer ifs;
-	Array2D<Ipv4InterfaceContainer> ifs0(nCN, 3);
-	Array2D<Ipv4InterfaceContainer> ifs1(nCN, 6);
-	Array2D<Ipv4InterfaceContainer> ifs2(nCN, 14);
-	Array2D<Ipv4InterfaceContainer> ifs3(nCN, 9);
-	Array3D<Ipv4InterfaceContainer> ifs2LAN(nCN, 7, nLANClients);
-	Array3D<Ipv4InterfaceContainer> ifs3LAN(nCN, 5, nLANClients);
-
-	Ipv4AddressHelper address;
-	std::ostringstream oss;
-	p2p_1gb5ms.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
-	p2p_1gb5ms.SetChannelAttribute ("Delay", StringValue ("5ms"));
-	p2p_2gb200ms.SetDeviceAttribute ("DataRate", StringValue ("2Gbps"));
-	p2p_2gb200ms.SetChannelAttribute ("Delay", StringValue ("200ms"));
-	p2p_100mb1ms.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
-	p2p_100mb1ms.SetChannelAttribute ("Delay", StringValue ("1ms"));
-
-	// Setup NixVector Routing
-	Ipv4NixVectorHelper nixRouting;
-	Ipv4StaticRoutingHelper staticRouting;
-
-	Ipv4ListRoutingHelper list;
-	list.Add (staticRouting, 0);
-	list.Add (nixRouting, 10);
-
-	if (nix)
+	CampusTopologyBuilder topology;
+	topology.SetLanSize (nLANClients);
+	topology.SetNixVectorRouting (nix);
+	topology.SetInternetStack (ip);
+	// Campuses are spread over the MPI ranks or the simulator partitions
+	topology.SetSystemCount (mpi ? nRanks : partitions);
+	if (backbone == "mesh")
+		topology.SetBackbone (CampusTopologyBuilder::BACKBONE_MESH);
+	else if (backbone == "star")
+		topology.SetBackbone (CampusTopologyBuilder::BACKBONE_STAR);
+	else if (backbone == "tree")
+		topology.SetBackbone (CampusTopologyBuilder::BACKBONE_TREE);
+	else if (backbone == "torus")
+		topology.SetBackbone (CampusTopologyBuilder::BACKBONE_TORUS);
+	else if (backbone != "ring")
 	{
-		stack.SetRoutingHelper (list); // has effect on the next Install ()
+		std::cout << "Unknown backbone " << backbone << std::endl;
+		return 1;
 	}
-
-	// Create Campus Networks
-	for (int z = 0; z < nCN; ++z)
+	CampusPlacement::Strata strata;
+	if (!CampusPlacement::LookupStrata (placement, &strata))
 	{
-		std::cout << "Creating Campus Network " << z << ":" << std::endl;
-		// Create Net0
-		std::cout << "  SubNet [ 0"; //0
-		for (int i = 0; i < 3; ++i)
-		{
-			nodes_net0[z][i].Create (1);
-			stack.Install (nodes_net0[z][i]);
-		}
-
-		nodes_net0[z][0].Add (nodes_net0[z][1].Get (0));
-		nodes_net0[z][1].Add (nodes_net0[z][2].Get (0));
-		nodes_net0[z][2].Add (nodes_net0[z][0].Get (0));
-		NetDeviceContainer ndc0[3];
-
-		for (int i = 0; i < 3; ++i)
-		{
-			ndc0[i] = p2p_1gb5ms.Install (nodes_net0[z][i]);
-		}
-
-		// Create Net1
-		std::cout << " 1";//1
-		for (int i = 0; i < 6; ++i)
-		{
-			nodes_net1[z][i].Create (1);
-			stack.Install(nodes_net1[z][i]);
-		}
-
-		nodes_net1[z][0].Add (nodes_net1[z][1].Get (0));
-		nodes_net1[z][2].Add (nodes_net1[z][0].Get (0));
-		nodes_net1[z][3].Add (nodes_net1[z][0].Get (0));
-		nodes_net1[z][4].Add (nodes_net1[z][1].Get (0));
-		nodes_net1[z][5].Add (nodes_net1[z][1].Get (0));
-		NetDeviceContainer ndc1[6];
-
-		for (int i = 0; i < 6; ++i)
-		{
-			if (i == 1)
-			{
-				continue;
-			}
-
-			ndc1[i] = p2p_1gb5ms.Install (nodes_net1[z][i]);
-		}
-
-		// Connect Net0 <-> Net1
-		NodeContainer net0_1;
-		net0_1.Add (nodes_net0[z][2].Get (0));
-		net0_1.Add (nodes_net1[z][0].Get (0));
-		NetDeviceContainer ndc0_1;
-		ndc0_1 = p2p_1gb5ms.Install(net0_1);
-		oss.str ("");
-		oss << 10 + z << ".1.252.0";
-		address.SetBase(oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign(ndc0_1);
-
-		// Create Net2
-		std::cout << " 2";//2
-		for (int i = 0; i < 14; ++i)
-		{
-			nodes_net2[z][i].Create (1);
-			stack.Install(nodes_net2[z][i]);
-		}
-
-		nodes_net2[z][0].Add (nodes_net2[z][1].Get (0));
-		nodes_net2[z][2].Add (nodes_net2[z][0].Get (0));
-		nodes_net2[z][1].Add (nodes_net2[z][3].Get (0));
-		nodes_net2[z][3].Add (nodes_net2[z][2].Get (0));
-		nodes_net2[z][4].Add (nodes_net2[z][2].Get (0));
-		nodes_net2[z][5].Add (nodes_net2[z][3].Get (0));
-		nodes_net2[z][6].Add (nodes_net2[z][5].Get (0));
-		nodes_net2[z][7].Add (nodes_net2[z][2].Get (0));
-		nodes_net2[z][8].Add (nodes_net2[z][3].Get (0));
-		nodes_net2[z][9].Add (nodes_net2[z][4].Get (0));
-		nodes_net2[z][10].Add (nodes_net2[z][5].Get (0));
-		nodes_net2[z][11].Add (nodes_net2[z][6].Get (0));
-		nodes_net2[z][12].Add (nodes_net2[z][6].Get (0));
-		nodes_net2[z][13].Add (nodes_net2[z][6].Get (0));
-		NetDeviceContainer ndc2[14];
-
-		for (int i = 0; i < 14; ++i)
-		{
-			ndc2[i] = p2p_1gb5ms.Install (nodes_net2[z][i]);
-		}
-		///      NetDeviceContainer ndc2LAN[7][nLANClients];
-
-		Array2D<NetDeviceContainer> ndc2LAN(7, nLANClients);
-		for (int i = 0; i < 7; ++i)
-		{
-			oss.str ("");
-			oss << 10 + z << ".4." << 15 + i << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-			for (int j = 0; j < nLANClients; ++j)
-			{
-				nodes_net2LAN[z][i][j].Create (1);
-				stack.Install (nodes_net2LAN[z][i][j]);
-				nodes_net2LAN[z][i][j].Add (nodes_net2[z][i+7].Get (0));
-				ndc2LAN[i][j] = p2p_100mb1ms.Install (nodes_net2LAN[z][i][j]);
-				ifs2LAN[z][i][j] = address.Assign (ndc2LAN[i][j]);
-			}
-		}
-
-		// Create Net3
-		std::cout << " 3 ]" << std::endl;//3
-		for (int i = 0; i < 9; ++i)
-		{
-			nodes_net3[z][i].Create (1);
-			stack.Install (nodes_net3[z][i]);
-		}
-
-		nodes_net3[z][0].Add (nodes_net3[z][1].Get (0));
-		nodes_net3[z][1].Add (nodes_net3[z][2].Get (0));
-		nodes_net3[z][2].Add (nodes_net3[z][3].Get (0));
-		nodes_net3[z][3].Add (nodes_net3[z][1].Get (0));
-		nodes_net3[z][4].Add (nodes_net3[z][0].Get (0));
-		nodes_net3[z][5].Add (nodes_net3[z][0].Get (0));
-		nodes_net3[z][6].Add (nodes_net3[z][2].Get (0));
-		nodes_net3[z][7].Add (nodes_net3[z][3].Get (0));
-		nodes_net3[z][8].Add (nodes_net3[z][3].Get (0));
-		NetDeviceContainer ndc3[9];
-		for (int i = 0; i < 9; ++i)
-		{
-			ndc3[i] = p2p_1gb5ms.Install (nodes_net3[z][i]);
-		}
-		///      NetDeviceContainer ndc3LAN[5][nLANClients];
-		Array2D<NetDeviceContainer> ndc3LAN(5, nLANClients);
-		for (int i = 0; i < 5; ++i)
-		{
-			oss.str ("");
-			oss << 10 + z << ".5." << 10 + i << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.255");
-			for (int j = 0; j < nLANClients; ++j)
-			{
-				nodes_net3LAN[z][i][j].Create (1);
-				stack.Install (nodes_net3LAN[z][i][j]);
-				nodes_net3LAN[z][i][j].Add (nodes_net3[z][i+4].Get (0));
-				ndc3LAN[i][j] = p2p_100mb1ms.Install (nodes_net3LAN[z][i][j]);
-				ifs3LAN[z][i][j] = address.Assign (ndc3LAN[i][j]);
-			}
-		}
-
-		std::cout << "  Connecting Subnets..." << std::endl;
-		// Create Lone Routers (Node 4 & 5)
-		nodes_netLR[z].Create (2);
-		stack.Install (nodes_netLR[z]);
-		NetDeviceContainer ndcLR;
-		ndcLR = p2p_1gb5ms.Install (nodes_netLR[z]);
-		// Connect Net2/Net3 through Lone Routers to Net0
-		NodeContainer net0_4, net0_5, net2_4a, net2_4b, net3_5a, net3_5b;
-		net0_4.Add (nodes_netLR[z].Get (0));
-		net0_4.Add (nodes_net0[z][0].Get (0));
-		net0_5.Add (nodes_netLR[z].Get  (1));
-		net0_5.Add (nodes_net0[z][1].Get (0));
-		net2_4a.Add (nodes_netLR[z].Get (0));
-		net2_4a.Add (nodes_net2[z][0].Get (0));
-		net2_4b.Add (nodes_netLR[z].Get (1));
-		net2_4b.Add (nodes_net2[z][1].Get (0));
-		net3_5a.Add (nodes_netLR[z].Get (1));
-		net3_5a.Add (nodes_net3[z][0].Get (0));
-		net3_5b.Add (nodes_netLR[z].Get (1));
-		net3_5b.Add (nodes_net3[z][1].Get (0));
-		NetDeviceContainer ndc0_4, ndc0_5, ndc2_4a, ndc2_4b, ndc3_5a, ndc3_5b;
-		ndc0_4 = p2p_1gb5ms.Install (net0_4);
-		oss.str ("");
-		oss << 10 + z << ".1.253.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndc0_4);
-		ndc0_5 = p2p_1gb5ms.Install (net0_5);
-		oss.str ("");
-		oss << 10 + z << ".1.254.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndc0_5);
-		ndc2_4a = p2p_1gb5ms.Install (net2_4a);
-		oss.str ("");
-		oss << 10 + z << ".4.253.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndc2_4a);
-		ndc2_4b = p2p_1gb5ms.Install (net2_4b);
-		oss.str ("");
-		oss << 10 + z << ".4.254.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndc2_4b);
-		ndc3_5a = p2p_1gb5ms.Install (net3_5a);
-		oss.str ("");
-		oss << 10 + z << ".5.253.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndc3_5a);
-		ndc3_5b = p2p_1gb5ms.Install (net3_5b);
-		oss.str ("");
-		oss << 10 + z << ".5.254.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndc3_5b);
-		// Assign IP addresses
-		std::cout << "  Assigning IP addresses..." << std::endl;
-
-		for (int i = 0; i < 3; ++i)
-		{
-			oss.str ("");
-			oss << 10 + z << ".1." << 1 + i << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-			ifs0[z][i] = address.Assign (ndc0[i]);
-		}
+		std::cout << "Unknown placement " << placement << std::endl;
+		return 1;
+	}
+	if (ndnStack != "all" && ndnStack != "selective")
+	{
+		std::cout << "Unknown NDN stack mode " << ndnStack << std::endl;
+		return 1;
+	}
+	// Forked runs draw new clients, which need a full stack already
+	if (seeds > 0 && (mpi || ndnStack != "all"))
+	{
+		std::cout << "--seeds needs --ndnStack=all and no MPI" << std::endl;
+		return 1;
+	}
+	// Ranks would stop at different times and wait for each other forever
+	if (wallBudget > 0 && mpi)
+	{
+		std::cout << "--wallBudget cannot be used with MPI" << std::endl;
+		return 1;
+	}
+	// The detector sees the consumers of its own rank or partition only
+	if (steadyState > 0 && (mpi || partitions > 1))
+	{
+		std::cout << "--steadyState cannot be used with MPI or partitions" << std::endl;
+		return 1;
+	}
 
-		for (int i = 0; i < 6; ++i)
+	// Runs with the same configuration and binary give the same results
+	RunCache runCache ("disaster-ccn-scenario1v1", argc, argv);
+	const char *ignored[] = { "progress", "progressFile", "profile", "jobs", "seeds",
+			"wallBudget", "snapshot", "timings", "scheduler", "cache" };
+	for (uint32_t i = 0; i < sizeof (ignored) / sizeof (ignored[0]); i++)
+		runCache.Ignore (ignored[i]);
+	if (!placementFile.empty ())
+		runCache.AddInput (placementFile);
+	// Each rank would have to agree on the cache, and on its own files
+	bool useCache = !mpi;
+	if (cache && useCache)
+	{
+		uint32_t firstRun = RngSeedManager::GetRun ();
+		uint32_t cached = 0;
+		for (uint32_t i = 0; i < std::max (seeds, 1u); i++)
 		{
-			if (i == 1)
+			RngSeedManager::SetRun (firstRun + i);
+			if (runCache.Lookup ())
 			{
-				continue;
+				runCache.PrintHit (std::cout);
+				cached++;
 			}
-			oss.str ("");
-			oss << 10 + z << ".2." << 1 + i << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-			ifs1[z][i] = address.Assign (ndc1[i]);
 		}
-
-		oss.str ("");
-		oss << 10 + z << ".3.1.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndcLR);
-
-		for (int i = 0; i < 14; ++i)
-		{
-			oss.str ("");
-			oss << 10 + z << ".4." << 1 + i << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-			ifs2[z][i] = address.Assign (ndc2[i]);
-		}
-
-		for (int i = 0; i < 9; ++i)
-		{
-			oss.str ("");
-			oss << 10 + z << ".5." << 1 + i << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-			ifs3[z][i] = address.Assign (ndc3[i]);
-		}
-	}
-	// Create Ring Links
-	if (nCN > 1)
-	{
-		std::cout << "Forming Ring Topology..." << std::endl;
-		NodeContainer* nodes_ring = new NodeContainer[nCN];
-		for (int z = 0; z < nCN-1; ++z)
-		{
-			nodes_ring[z].Add (nodes_net0[z][0].Get (0));
-			nodes_ring[z].Add (nodes_net0[z+1][0].Get (0));
-		}
-		nodes_ring[nCN-1].Add (nodes_net0[nCN-1][0].Get (0));
-		nodes_ring[nCN-1].Add (nodes_net0[0][0].Get (0));
-		NetDeviceContainer* ndc_ring = new NetDeviceContainer[nCN];
-		for (int z = 0; z < nCN; ++z)
-		{
-			ndc_ring[z] = p2p_2gb200ms.Install (nodes_ring[z]);
-			oss.str ("");
-			oss << "254.1." << z + 1 << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-			ifs = address.Assign (ndc_ring[z]);
-		}
-		delete[] ndc_ring;
-		delete[] nodes_ring;
+		RngSeedManager::SetRun (firstRun);
+		if (cached == std::max (seeds, 1u))
+			return 0;
 	}
 
-	// Make sure to seed our random
-	gen.seed(std::time(0));
-	
+	// Reuse the address plan and the routes of an earlier run when possible
+	timer.Start ("topology");
+	bool fromSnapshot = !snapshot.empty () && topology.LoadSnapshot (snapshot, nCN);
+	if (!fromSnapshot)
+		topology.Build (nCN);
+	memory.Mark ("topology");
+
+	// Every MPI rank draws the same clients and content names: rng only
+	// depends on --RngSeed and --RngRun, and every draw is made on all ranks
 	// With the network assigned, time to randomly obtain clients and servers
 	NS_LOG_INFO ("Obtaining the clients and servers");
 
 	// Obtain the random lists of server and clients
     // fixed location for server in scenario1
         //tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > t = assignClientsandServers(clients, servers);	
-    tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > t = assignClientsandServers(clients, 0);
+    tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > t = assignClientsandServers (topology, clients, 0, strata);
 
 
 	// Separate the tuple into clients and servers
 	std::vector<Ptr<Node> > clientVector = t.get<0> ();
+	if (!placementFile.empty ())
+	{
+		// Paired runs of both protocols share their clients
+		clientVector = loadClients (topology, placementFile, clients);
+		if (clientVector.size () != clients)
+		{
+			std::cout << "No " << clients << " LAN hosts of this topology in " << placementFile << std::endl;
+			return 1;
+		}
+	}
 	std::vector<Ptr<Node> > serverVector = t.get<1> ();
 
 	NodeContainer clientNodes;
@@ -605,294 +419,196 @@ int main (int argc, char *argv[])
 	//Set forwarding strategy
 	ndnHelper.SetForwardingStrategy ("ns3::ndn::fw::BestRoute");
 
-	ndnHelper.InstallAll ();
+	timer.Start ("ndn-stack");
+	if (ndnStack == "all")
+	{
+		ndnHelper.InstallAll ();
+	}
+	else
+	{
+		// Full stack on the routers (servers are Net1 routers) and on the clients
+		NodeContainer routers = topology.GetRouters ();
+		ndnHelper.Install (routers);
+		uint32_t nFull = routers.GetN ();
+		for (uint32_t i = 0; i < clients; i++)
+		{
+			if (clientVector[i]->GetObject<ndn::L3Protocol> () == 0)
+			{
+				ndnHelper.Install (clientVector[i]);
+				nFull++;
+			}
+		}
+
+		// Idle hosts only need faces, so that the global routing can walk
+		// past them: no content store, and their PIT and FIB stay empty
+		NodeContainer hosts = topology.GetLanHosts ();
+		NodeContainer idle;
+		for (uint32_t i = 0; i < hosts.GetN (); i++)
+			if (hosts.Get (i)->GetObject<ndn::L3Protocol> () == 0)
+				idle.Add (hosts.Get (i));
+		ndn::StackHelper idleHelper;
+		idleHelper.SetContentStore ("ns3::ndn::cs::Nocache");
+		idleHelper.SetForwardingStrategy ("ns3::ndn::fw::BestRoute");
+		idleHelper.Install (idle);
+		std::cout << "NDN stack: full on " << nFull << " nodes, minimal on " << idle.GetN ()
+				<< " idle hosts" << std::endl;
+	}
+	timer.Stop ();
+	std::cout << "NDN stack install took " << timer.GetWall ("ndn-stack") << " s, RSS "
+			<< MemoryUsage::GetCurrentRss () / 1048576.0 << " MB" << std::endl;
+	memory.Mark ("ndn-stack");
 	
 	ndn::GlobalRoutingHelper ndnGlobalRoutingHelper;
 	ndnGlobalRoutingHelper.InstallAll ();
-	if (networks == 1){
-		ndnGlobalRoutingHelper.AddOrigins ("/Dinfo/tokyo/shinjuku/wasedau/net1/server/", nodes_net1[0][5].Get (0));
-	}
-	else if (networks == 2){
-		ndnGlobalRoutingHelper.AddOrigins ("/Dinfo/tokyo/shinjuku/wasedau/net1/server/", nodes_net1[0][5].Get (0));
-		ndnGlobalRoutingHelper.AddOrigins ("/Dinfo/tokyo/shinjuku/nishiwasedau/net1/server/", nodes_net1[1][5].Get (0));
+	for (uint32_t z = 0; z < networks; z++)
+		ndnGlobalRoutingHelper.AddOrigins (campusPrefix (z), topology.GetCampus (z).Net1 (5));
+
+	timer.Start ("routing");
+	if (fromSnapshot)
+	{
+		topology.LoadRoutes ();
 	}
-	else if(networks == 3){
-		ndnGlobalRoutingHelper.AddOrigins ("/Dinfo/tokyo/shinjuku/wasedau/net1/server/", nodes_net1[0][5].Get (0));
-		ndnGlobalRoutingHelper.AddOrigins ("/Dinfo/tokyo/shinjuku/nishiwasedau/net1/server/", nodes_net1[1][5].Get (0));
-		ndnGlobalRoutingHelper.AddOrigins ("/Dinfo/tokyo/shinjuku/toyamawasedau/net1/server/", nodes_net1[2][5].Get (0));
+	else
+	{
+		ndn::GlobalRoutingHelper::CalculateRoutes ();
 	}
-	else{
-		cout<< "Too many networks, bro!"<< endl;
+	timer.Stop ();
+	memory.Mark ("routing");
+	std::cout << "Startup (" << (fromSnapshot ? "snapshot" : "build") << "): topology "
+			<< topology.GetBuildTime () << " s, routes " << timer.GetWall ("routing")
+			<< " s, total " << timer.GetElapsed () << " s" << std::endl;
+	if (!fromSnapshot && !snapshot.empty () && rank == 0)
+		topology.SaveSnapshot (snapshot);
+
+	// Built once for every consumer, and before the forks below so that
+	// the seed runs share it
+	if (catalog > 0)
+		ZipfAliasTable::Get (catalog, zipfQ, zipfS);
+
+	// With --seeds, everything above is shared by copy-on-write copies of
+	// this process, one per RngRun, which only draw their own clients
+	// and content names and run
+	char seedSuffix[32] = "";
+	if (seeds > 0)
+	{
+		SeedForker forker;
+		if (jobs > 0)
+			forker.SetJobs (jobs);
+		sprintf (buffer, "%s/disaster1-ccn-run-%02d-%03d-%03d-%0*d", results, networks, servers, clients, 12, contentsize);
+		forker.SetLogPrefix (buffer);
+		if (!forker.Fork (seeds))
+			return forker.GetNFailed () > 0 ? 1 : 0;
+
+		RngSeedManager::SetRun (RngSeedManager::GetRun () + forker.GetIndex ());
+		rng.Reset ();
+		if (placementFile.empty ())
+		{
+			t = assignClientsandServers (topology, clients, 0, strata);
+			clientVector = t.get<0> ();
+		}
+		sprintf (seedSuffix, ".seed%u", forker.GetIndex ());
+		std::cout << "Seed run " << forker.GetIndex () << ", RngRun " << RngSeedManager::GetRun () << std::endl;
+		if (cache && useCache && runCache.Lookup ())
+		{
+			runCache.PrintHit (std::cout);
+			return 0;
+		}
 	}
 
-	ndn::GlobalRoutingHelper::CalculateRoutes ();
-
 	
+	timer.Start ("apps");
 	//ApplicationContainer apps;
 	ndn::AppHelper producerHelper ("ns3::ndn::Producer");
-	srand((int)time(NULL)); 
     
-    // server NodeContainer
-    if (servers == 1){
-        Ptr<Node> server_tmp = nodes_net1[0][5].Get (0);
-        uint32_t server_nodeNum = server_tmp->GetId();
-	
-        serverNodes.Add(server_tmp);
-	    serverNodeIds.push_back(server_nodeNum);
-    }
-    else if (servers == 2){
-            Ptr<Node> server_tmp = nodes_net1[0][5].Get (0);
-            uint32_t server_nodeNum = server_tmp->GetId();
-            serverNodes.Add(server_tmp);
-	        serverNodeIds.push_back(server_nodeNum);
-
-            Ptr<Node> server_tmp1 = nodes_net1[1][5].Get (0);
-            uint32_t server_nodeNum1 = server_tmp1->GetId();
-            serverNodes.Add(server_tmp1);
-	        serverNodeIds.push_back(server_nodeNum1);
-        }
-    else if(servers == 3){
-            Ptr<Node> server_tmp = nodes_net1[0][5].Get (0);
-            uint32_t server_nodeNum = server_tmp->GetId();
-            serverNodes.Add(server_tmp);
-	        serverNodeIds.push_back(server_nodeNum);
-
-            Ptr<Node> server_tmp1 = nodes_net1[1][5].Get (0);
-            uint32_t server_nodeNum1 = server_tmp1->GetId();
-            serverNodes.Add(server_tmp1);
-	        serverNodeIds.push_back(server_nodeNum1);
-
-            Ptr<Node> server_tmp2 = nodes_net1[2][5].Get (0);
-            uint32_t server_nodeNum2 = server_tmp2->GetId();
-            serverNodes.Add(server_tmp2);
-	        serverNodeIds.push_back(server_nodeNum2);
-        }
-    else {
-    	cout<< "Too many servers, bro!" << endl;
-    }
-    	
-
-    //clients [1,250] [251,500] [501,750]
-    //clientNodes [0,249] [250,499] [500,749]
-	
-    // 1 campus
-    if (clients<=250){
-		for (uint32_t i = 0; i < clients; i++){
-			Ptr<Node> tmp = clientVector[i];
-
-			uint32_t nodeNum = tmp->GetId();
-
-			sprintf (buffer, "Adding client node: %d", nodeNum);
-			NS_LOG_INFO (buffer);
-
-			clientNodes.Add(tmp);
-			clientNodeIds.push_back(nodeNum);
-			
-			int r = rand()%clients; //generate a random number [1,clients]
-			
-			char   newprefix[64]="/Dinfo/tokyo/shinjuku/wasedau/net1/server/";
-			//std::string prefix = "/Dinfo/tokyo/shinjuku/wasedau/net1/server/";
-			sprintf (newprefix, "%s%d", newprefix,r);
-			
-			ndn::AppHelper consumerHelper ("ns3::ndn::ConsumerCbr");
-			consumerHelper.SetAttribute ("Frequency", StringValue ("100")); 
+    // server NodeContainer, one server per campus
+	for (uint32_t z = 0; z < servers; z++){
+		Ptr<Node> server_tmp = topology.GetCampus (z).Net1 (5);
+		serverNodes.Add(server_tmp);
+		serverNodeIds.push_back(server_tmp->GetId());
+	}
+
+	// Clients [0,clientsPerCampus) ask campus 0, the next block campus 1, ...
+	for (uint32_t i = 0; i < clients; i++){
+		uint32_t z = i / clientsPerCampus;
+		Ptr<Node> tmp = clientVector[i];
+
+		uint32_t nodeNum = tmp->GetId();
+
+		sprintf (buffer, "Adding client node: %d", nodeNum);
+		NS_LOG_INFO (buffer);
+
+		clientNodes.Add(tmp);
+		clientNodeIds.push_back(nodeNum);
+
+		double start = startJitter > 0 ? rng.Uniform (ScenarioRandom::JITTER, 0, startJitter) : 0;
+
+		std::ostringstream newprefix;
+		if (catalog > 0)
+			newprefix << campusPrefix (z) << "catalog";
+		else
+			newprefix << campusPrefix (z) << rng.Integer (ScenarioRandom::POPULARITY, 0, clients - 1); //generate a random number [0,clients)
+
+		// With a catalog, each Interest asks for a content drawn from the
+		// popularity of its campus, else every client fetches its own name
+		ndn::AppHelper consumerHelper (catalog > 0 ? "ns3::ConsumerZipfAlias" : "ns3::CampusConsumerCbr");
+		consumerHelper.SetAttribute ("Frequency", StringValue ("100"));
+		if (catalog > 0)
+		{
+			consumerHelper.SetAttribute ("NumberOfContents", UintegerValue (catalog));
+			consumerHelper.SetAttribute ("q", DoubleValue (zipfQ));
+			consumerHelper.SetAttribute ("s", DoubleValue (zipfS));
+		}
+		else
 			consumerHelper.SetAttribute ("MaxSeq", IntegerValue (10240));
-			consumerHelper.SetAttribute ("Randomize", StringValue ("exponential"));
-			consumerHelper.SetPrefix (newprefix);
-			consumerHelper.Install (clientNodes.Get (i));// let every client ask for different content(maybe the same)
-				
-			producerHelper.SetPrefix (newprefix);
-			producerHelper.SetAttribute ("PayloadSize", StringValue("1024"));
-			producerHelper.SetAttribute ("Freshness", TimeValue (Seconds(0)));
-			producerHelper.Install (nodes_net1[0][5].Get (0));
-         }
+		consumerHelper.SetAttribute ("Randomize", StringValue ("exponential"));
+		consumerHelper.SetPrefix (newprefix.str ());
+		// Applications only run on the rank that owns their node
+		if (!mpi || tmp->GetSystemId () == rank)
+		{
+			ApplicationContainer consumer = consumerHelper.Install (tmp);
+			consumer.Start (Seconds (start));// let every client ask for different content(maybe the same)
+			// Streams of the client, whatever order the consumers first draw in,
+			// so that the partitions of CampusParallelSimulatorImpl draw what
+			// DefaultSimulatorImpl would
+			DynamicCast<CampusConsumerCbr> (consumer.Get (0))->AssignStreams (ScenarioRandom::GetAppStream (i));
+		}
+
+		// The catalog of a campus has one producer
+		if (catalog > 0 && i % clientsPerCampus != 0)
+			continue;
+		producerHelper.SetPrefix (newprefix.str ());
+		producerHelper.SetAttribute ("PayloadSize", StringValue("1024"));
+		producerHelper.SetAttribute ("Freshness", TimeValue (Seconds(0)));
+		if (!mpi || topology.GetSystemId (z) == rank)
+			producerHelper.Install (topology.GetCampus (z).Net1 (5));
 	}
-    // 2 campus
-    else if(clients > 250 && clients <= 500) {
-            for (uint32_t i = 0; i < 250 ; i++){
-			    Ptr<Node> tmp = clientVector[i];
-
-			    uint32_t nodeNum = tmp->GetId();
-
-			    sprintf (buffer, "Adding client node: %d", nodeNum);
-			    NS_LOG_INFO (buffer);
-
-			    clientNodes.Add(tmp);
-			    clientNodeIds.push_back(nodeNum);
-			
-			
-
-			    int r = rand()%clients; //generate a random number [1,clients]
-			
-			    char   newprefix[64]="/Dinfo/tokyo/shinjuku/wasedau/net1/server/";
-			    //std::string prefix = "/Dinfo/tokyo/shinjuku/wasedau/net1/server/";
-			    sprintf (newprefix, "%s%d", newprefix,r);
-			
-			
-			    ndn::AppHelper consumerHelper ("ns3::ndn::ConsumerCbr");
-			    consumerHelper.SetAttribute ("Frequency", StringValue ("100")); 
-			    consumerHelper.SetAttribute ("MaxSeq", IntegerValue (10240));
-			    consumerHelper.SetAttribute ("Randomize", StringValue ("exponential"));
-			    consumerHelper.SetPrefix (newprefix);
-			    consumerHelper.Install (clientNodes.Get (i));// let every client ask for different content(maybe the same)
-				
-			    producerHelper.SetPrefix (newprefix);
-			    producerHelper.SetAttribute ("PayloadSize", StringValue("1024"));
-			    producerHelper.SetAttribute ("Freshness", TimeValue (Seconds(0)));
-			    producerHelper.Install (nodes_net1[0][5].Get (0));
-            }
-
-            for (uint32_t i = 250; i < clients ; i++){
-			    Ptr<Node> tmp = clientVector[i];
-
-			    uint32_t nodeNum = tmp->GetId();
-
-			    sprintf (buffer, "Adding client node: %d", nodeNum);
-			    NS_LOG_INFO (buffer);
-
-			    clientNodes.Add(tmp);
-			    clientNodeIds.push_back(nodeNum);
-			
-			    int r = rand()%clients; //generate a random number [1,clients]
-			
-			    char   newprefix1[64]="/Dinfo/tokyo/shinjuku/nishiwasedau/net1/server/";
-			    //std::string prefix = "/Dinfo/tokyo/shinjuku/wasedau/net1/server/";
-			    sprintf (newprefix1, "%s%d", newprefix1,r);
-				
-			    ndn::AppHelper consumerHelper ("ns3::ndn::ConsumerCbr");
-			    consumerHelper.SetAttribute ("Frequency", StringValue ("100")); 
-			    consumerHelper.SetAttribute ("MaxSeq", IntegerValue (10240));
-			    consumerHelper.SetAttribute ("Randomize", StringValue ("exponential"));
-			    consumerHelper.SetPrefix (newprefix1);
-			    consumerHelper.Install (clientNodes.Get (i));// let every client ask for different content(maybe the same)
-				
-			    producerHelper.SetPrefix (newprefix1);
-			    producerHelper.SetAttribute ("PayloadSize", StringValue("1024"));
-			    producerHelper.SetAttribute ("Freshness", TimeValue (Seconds(0)));
-			    producerHelper.Install (nodes_net1[1][5].Get (0));
-            }
-     }
-     else if(clients > 500 && clients <= 750){
-         for (uint32_t i = 0; i < 250 ; i++){
-			    Ptr<Node> tmp = clientVector[i];
-
-			    uint32_t nodeNum = tmp->GetId();
-
-			    sprintf (buffer, "Adding client node: %d", nodeNum);
-			    NS_LOG_INFO (buffer);
-
-			    clientNodes.Add(tmp);
-			    clientNodeIds.push_back(nodeNum);
-			
-			
-
-			    int r = rand()%clients; //generate a random number [1,clients]
-			
-			    char   newprefix0[64]="/Dinfo/tokyo/shinjuku/wasedau/net1/server/";
-			    //std::string prefix = "/Dinfo/tokyo/shinjuku/wasedau/net1/server/";
-			    sprintf (newprefix0, "%s%d", newprefix0,r);
-			
-			
-			    ndn::AppHelper consumerHelper ("ns3::ndn::ConsumerCbr");
-			    consumerHelper.SetAttribute ("Frequency", StringValue ("100")); 
-			    consumerHelper.SetAttribute ("MaxSeq", IntegerValue (10240));
-			    consumerHelper.SetAttribute ("Randomize", StringValue ("exponential"));
-			    consumerHelper.SetPrefix (newprefix0);
-			    consumerHelper.Install (clientNodes.Get (i));// let every client ask for different content(maybe the same)
-				
-			    producerHelper.SetPrefix (newprefix0);
-			    producerHelper.SetAttribute ("PayloadSize", StringValue("1024"));
-			    producerHelper.SetAttribute ("Freshness", TimeValue (Seconds(0)));
-			    producerHelper.Install (nodes_net1[0][5].Get (0));
-            }
-
-            for (uint32_t i = 250; i < 500 ; i++){
-			    Ptr<Node> tmp = clientVector[i];
-
-			    uint32_t nodeNum = tmp->GetId();
-
-			    sprintf (buffer, "Adding client node: %d", nodeNum);
-			    NS_LOG_INFO (buffer);
-
-			    clientNodes.Add(tmp);
-			    clientNodeIds.push_back(nodeNum);
-			
-			
-
-			    int r = rand()%clients; //generate a random number [1,clients]
-			
-			    char   newprefix1[64]="/Dinfo/tokyo/shinjuku/nishiwasedau/net1/server/";
-			    //std::string prefix = "/Dinfo/tokyo/shinjuku/wasedau/net1/server/";
-			    sprintf (newprefix1, "%s%d", newprefix1,r);
-			
-			
-			    ndn::AppHelper consumerHelper ("ns3::ndn::ConsumerCbr");
-			    consumerHelper.SetAttribute ("Frequency", StringValue ("100")); 
-			    consumerHelper.SetAttribute ("MaxSeq", IntegerValue (10240));
-			    consumerHelper.SetAttribute ("Randomize", StringValue ("exponential"));
-			    consumerHelper.SetPrefix (newprefix1);
-			    consumerHelper.Install (clientNodes.Get (i));// let every client ask for different content(maybe the same)
-				
-			    producerHelper.SetPrefix (newprefix1);
-			    producerHelper.SetAttribute ("PayloadSize", StringValue("1024"));
-			    producerHelper.SetAttribute ("Freshness", TimeValue (Seconds(0)));
-			    producerHelper.Install (nodes_net1[1][5].Get (0));
-            } 
-            
-            for (uint32_t i = 500; i < clients ; i++){
-			    Ptr<Node> tmp = clientVector[i];
-
-			    uint32_t nodeNum = tmp->GetId();
-
-			    sprintf (buffer, "Adding client node: %d", nodeNum);
-			    NS_LOG_INFO (buffer);
-
-			    clientNodes.Add(tmp);
-			    clientNodeIds.push_back(nodeNum);
-			
-			
-
-			    int r = rand()%clients; //generate a random number [1,clients]
-			
-			    char   newprefix2[64]="/Dinfo/tokyo/shinjuku/toyamawasedau/net1/server/";
-			    //std::string prefix = "/Dinfo/tokyo/shinjuku/wasedau/net1/server/";
-			    sprintf (newprefix2, "%s%d", newprefix2,r);
-			
-			
-			    ndn::AppHelper consumerHelper ("ns3::ndn::ConsumerCbr");
-			    consumerHelper.SetAttribute ("Frequency", StringValue ("100")); 
-			    consumerHelper.SetAttribute ("MaxSeq", IntegerValue (10240));
-			    consumerHelper.SetAttribute ("Randomize", StringValue ("exponential"));
-			    consumerHelper.SetPrefix (newprefix2);
-			    consumerHelper.Install (clientNodes.Get (i));// let every client ask for different content(maybe the same)
-				
-			    producerHelper.SetPrefix (newprefix2);
-			    producerHelper.SetAttribute ("PayloadSize", StringValue("1024"));
-			    producerHelper.SetAttribute ("Freshness", TimeValue (Seconds(0)));
-			    producerHelper.Install (nodes_net1[2][5].Get (0));
-            }
-     }
-     else {
-    	 cout << "Too many clients,bro!" << endl;
-     }
-    	 
-    
+	memory.Mark ("apps");
+	timer.Start ("tracers");
+
+	// Nodes traced by this rank, run.py merges the per-rank traces
+	NodeContainer localNodes;
+	for (uint32_t i = 0; i < topology.GetNodes ().GetN (); i++)
+		if (!mpi || topology.GetNode (i)->GetSystemId () == rank)
+			localNodes.Add (topology.GetNode (i));
+
     // Obtain metrics
 	char filename[250];
 
 	// Print server nodes to file
-	sprintf(filename, "%s/disaster1-ccn-servers-%02d-%03d-%03d-%0*d.txt", results, networks, servers, clients, 12, contentsize);
+	sprintf(filename, "%s/disaster1-ccn-servers-%02d-%03d-%03d-%0*d%s.txt", results, networks, servers, clients, 12, contentsize, seedSuffix);
 
 	NS_LOG_INFO ("Printing node files");
+	if (rank == 0) {
     std::ofstream serverFile;
 	serverFile.open (filename);
 	for (int i = 0; i < serverNodeIds.size(); i++) {
 		serverFile << serverNodeIds[i] << std::endl;
 	}
 	serverFile.close();
+	runCache.AddOutput (filename);
     
 
-	sprintf(filename, "%s/disaster1-ccn-clients-%02d-%03d-%03d-%0*d.txt", results, networks, servers, clients, 12, contentsize);
+	sprintf(filename, "%s/disaster1-ccn-clients-%02d-%03d-%03d-%0*d%s.txt", results, networks, servers, clients, 12, contentsize, seedSuffix);
 
 	std::ofstream clientFile;
 	clientFile.open (filename);
@@ -900,30 +616,131 @@ int main (int argc, char *argv[])
 		clientFile << clientNodeIds[i] << std::endl;
 	}
 	clientFile.close();
+	runCache.AddOutput (filename);
+	}
 
-	sprintf (filename, "%s/disaster1-ccn-aggregate-trace-%02d-%03d-%03d-%0*d.txt", results, networks, servers, clients, 12, contentsize);
-	ndn::L3AggregateTracer::InstallAll(filename, Seconds (1.0));
+	sprintf (filename, "%s/disaster1-ccn-aggregate-trace-%02d-%03d-%03d-%0*d%s%s.txt", results, networks, servers, clients, 12, contentsize, seedSuffix, rankSuffix);
+	ndn::L3AggregateTracer::Install (localNodes, filename, Seconds (1.0));
+	runCache.AddOutput (filename);
 
-	sprintf (filename, "%s/disaster1-ccn-rate-trace-%02d-%03d-%03d-%0*d.txt", results, networks, servers, clients, 12, contentsize);
-	ndn::L3RateTracer::InstallAll (filename, Seconds (1.0));
+	sprintf (filename, "%s/disaster1-ccn-rate-trace-%02d-%03d-%03d-%0*d%s%s.txt", results, networks, servers, clients, 12, contentsize, seedSuffix, rankSuffix);
+	ndn::L3RateTracer::Install (localNodes, filename, Seconds (1.0));
+	runCache.AddOutput (filename);
 
-	sprintf (filename, "%s/disaster1-ccn-app-delays-trace-%02d-%03d-%03d-%0*d.txt", results, networks, servers, clients, 12, contentsize);
-	ndn::AppDelayTracer::InstallAll (filename);
+	// AppDelayTracer writes as the consumers get their Data: with
+	// partitions, one file each keeps the partitions of
+	// CampusParallelSimulatorImpl apart, and run.py merges them
+	if (!mpi && partitions > 1)
+	{
+		for (uint32_t p = 0; p < partitions; p++)
+		{
+			NodeContainer partitionNodes;
+			for (uint32_t i = 0; i < localNodes.GetN (); i++)
+				if (localNodes.Get (i)->GetSystemId () == p)
+					partitionNodes.Add (localNodes.Get (i));
+			sprintf (filename, "%s/disaster1-ccn-app-delays-trace-%02d-%03d-%03d-%0*d%s.part%u.txt", results, networks, servers, clients, 12, contentsize, seedSuffix, p);
+			ndn::AppDelayTracer::Install (partitionNodes, filename);
+			runCache.AddOutput (filename);
+		}
+	}
+	else
+	{
+		sprintf (filename, "%s/disaster1-ccn-app-delays-trace-%02d-%03d-%03d-%0*d%s%s.txt", results, networks, servers, clients, 12, contentsize, seedSuffix, rankSuffix);
+		ndn::AppDelayTracer::Install (localNodes, filename);
+		runCache.AddOutput (filename);
+	}
 
-	sprintf (filename, "%s/disaster1-ccn-drop-trace-%02d-%03d-%03d-%0*d.txt", results, networks, servers, clients, 12, contentsize);
+	// L2RateTracer has no per-node install: remote nodes show up with zero
+	// counters, which the merge adds up
+	sprintf (filename, "%s/disaster1-ccn-drop-trace-%02d-%03d-%03d-%0*d%s%s.txt", results, networks, servers, clients, 12, contentsize, seedSuffix, rankSuffix);
 	L2RateTracer::InstallAll (filename, Seconds (0.5));
+	runCache.AddOutput (filename);
 
-	sprintf (filename, "%s/disaster1-ccn-cs-trace-%02d-%03d-%03d-%0*d.txt", results, networks, servers, clients, 12, contentsize);
+	sprintf (filename, "%s/disaster1-ccn-cs-trace-%02d-%03d-%03d-%0*d%s%s.txt", results, networks, servers, clients, 12, contentsize, seedSuffix, rankSuffix);
 	
-    ndn::CsTracer::InstallAll (filename, Seconds (0.1));
-
-	//p2p_1gb5ms.EnablePcap ("results/ccn_test0.pcap", nodes_net1[0][5].Get (0)->GetId (), true,true);
-    sprintf (filename, "%s/ccn_server-%02d-%03d-%03d-%0*d.pcap", results, networks, servers, clients, 12, contentsize);
-    p2p_1gb5ms.EnablePcap (filename, 8, true,true);
-	//p2p_1gb5ms.EnablePcap ("results/tcp_test1.pcap", serverNodes.Get(1)->GetId (), true,true);
+    ndn::CsTracer::Install (localNodes, filename, Seconds (0.1));
+	runCache.AddOutput (filename);
+	memory.Mark ("tracers");
+
+	//topology.GetCampusLinkHelper ().EnablePcap ("results/ccn_test0.pcap", topology.GetCampus (0).Net1 (5)->GetId (), true,true);
+    sprintf (filename, "%s/ccn_server-%02d-%03d-%03d-%0*d%s.pcap", results, networks, servers, clients, 12, contentsize, seedSuffix);
+    if (!mpi || topology.GetNode (8)->GetSystemId () == rank)
+    topology.GetCampusLinkHelper ().EnablePcap (filename, 8, true,true);
+	//topology.GetCampusLinkHelper ().EnablePcap ("results/tcp_test1.pcap", serverNodes.Get(1)->GetId (), true,true);
 	
-    Simulator::Stop (Seconds (60.0));
+	double d1 = timer.GetElapsed ();
+	timer.Start ("run");
+	Simulator::Stop (Seconds (stopTime));
+	// stopTime becomes an upper bound
+	SteadyStateDetector steady;
+	if (steadyState > 0)
+	{
+		steady.SetPrecision (steadyState);
+		steady.Install ();
+	}
+	ProgressReporter reporter;
+	reporter.SetInterval (progress);
+	reporter.SetOutput (progressFile);
+	reporter.Start (Seconds (stopTime));
+	// Stops cleanly on --wallBudget or SIGINT/SIGTERM, so that the tracer
+	// files are complete up to the time reached
+	WallClockBudget budget;
+	budget.SetCatchSignals (!mpi);
+	budget.Start (wallBudget);
 	Simulator::Run ();
+	CountingScheduler::Finish ();
+	budget.Stop ();
+	reporter.Stop ();
+	timer.Stop ();
+	memory.Mark ("run");
+	double reached = Simulator::Now ().GetSeconds ();
+	if (budget.IsExhausted ())
+	{
+		sprintf (filename, "%s/disaster1-ccn-incomplete-%02d-%03d-%03d-%0*d%s.txt", results, networks, servers, clients, 12, contentsize, seedSuffix);
+		budget.WriteMarker (filename, Seconds (reached));
+		std::cout << "Simulation stopped by " << budget.GetReason () << " at " << reached << " s of "
+				<< stopTime << " s, see " << filename << std::endl;
+	}
+	if (steadyState > 0)
+		steady.Print (std::cout);
+	// The tables are gone once the simulator is destroyed
+	memory.EstimateTables (localNodes);
+	timer.Start ("teardown");
 	Simulator::Destroy ();
+	if (mpi)
+		MpiInterface::Disable ();
+	timer.Stop ();
+	memory.Mark ("teardown");
+	sprintf (filename, "%s/disaster1-ccn-memory-%02d-%03d-%03d-%0*d%s%s.txt", results, networks, servers, clients, 12, contentsize, seedSuffix, rankSuffix);
+	memory.Write (filename);
+	memory.Print (std::cout);
+	runCache.AddOutput (filename);
+	// Runs stopped by the wall-clock budget have incomplete results; the
+	// tracers close their files only when destroyed, before the sizes of
+	// the files go to the manifest
+	if (useCache && !budget.IsExhausted ())
+	{
+		ndn::L3AggregateTracer::Destroy ();
+		ndn::L3RateTracer::Destroy ();
+		ndn::AppDelayTracer::Destroy ();
+		ndn::CsTracer::Destroy ();
+		L2RateTracer::Destroy ();
+		runCache.Commit ();
+		std::cout << "Run cached as " << runCache.GetKeyString () << std::endl;
+	}
+
+	if (!timings.empty () && rank == 0)
+		timer.Write (timings);
+	timer.Print (std::cout);
+
+	double d2 = timer.GetWall ("run");
+	uint64_t events = CountingScheduler::GetNExecuted ();
+	std::cout << "-----" << std::endl << "Runtime Stats:" << std::endl;
+	std::cout << "Simulator init time: " << d1 << std::endl;
+	std::cout << "Simulator run time: " << d2 << std::endl;
+	std::cout << "Simulated time reached: " << reached << std::endl;
+	std::cout << "Events: " << events << std::endl;
+	std::cout << "Events per second: " << (d2 > 0 ? events / d2 : 0) << std::endl;
+	std::cout << "Peak RSS (MB): " << MemoryUsage::GetPeakRss () / 1048576.0 << std::endl;
 	return 0;		
 }
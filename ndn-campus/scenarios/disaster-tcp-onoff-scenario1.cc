@@ -74,160 +74,77 @@
 #include <ns3-dev/ns3/ndnSIM/utils/tracers/ipv4-rate-l3-tracer.h>
 #include <ns3-dev/ns3/ndnSIM/utils/tracers/ipv4-seqs-app-tracer.h>
 
+#include "campus-placement.h"
+#include "campus-topology-builder.h"
+#include "counting-scheduler.h"
+#include "memory-accounting.h"
+#include "phase-timer.h"
+#include "progress-reporter.h"
+#include "run-cache.h"
+#include "scenario-random.h"
+
 using namespace ns3;
 using namespace boost;
 
 namespace br = boost::random;
 
-typedef struct timeval TIMER_TYPE;
-#define TIMER_NOW(_t) gettimeofday (&_t,NULL);
-#define TIMER_SECONDS(_t) ((double)(_t).tv_sec + (_t).tv_usec*1e-6)
-#define TIMER_DIFF(_t1, _t2) (TIMER_SECONDS (_t1)-TIMER_SECONDS (_t2))
-
 NS_LOG_COMPONENT_DEFINE ("CampusNetworkModel");
 
-// Number generator
-br::mt19937_64 gen;
+// Random draws of the scenario, set by --RngSeed and --RngRun
+ScenarioRandom rng;
 
-// Obtains a random number from a uniform distribution between min and max.
-// Must seed number generator to ensure randomness at runtime.
+// Obtains a random number from a uniform distribution between min and max,
+// from the placement substream
 int obtain_Num(int min, int max) {
-    br::uniform_int_distribution<> dist(min, max);
-    return dist(gen);
+    return rng.Integer (ScenarioRandom::PLACEMENT, min, max);
 }
 
-// Obtains a random list of clients and servers. Must be run once all nodes have been
-// created to function correctly
-tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > assignClientsandServers(int num_clients, int num_servers) {
-
-	char buffer[250];
-
-	// Obtain the global list of Nodes in the simulation
-	NodeContainer global = NodeContainer::GetGlobal ();
-
-	// Get the number of nodes in the simulation
-	uint32_t size = global.GetN ();
-
-	sprintf(buffer, "assignClientsandServers, we have %d nodes", size);
-
-	NS_LOG_INFO (buffer);
-
-	sprintf(buffer, "assignClientsandServers, %d clients, %d servers", num_clients, num_servers);
+// Draws random clients among the LAN hosts and servers among the Net1 routers,
+// from the placement substream. Must be run once the topology is built
+tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > assignClientsandServers(const CampusTopologyBuilder &topology, int num_clients, int num_servers) {
 
-	// Check that we haven't asked for a scenario where we don't have enough Nodes to fufill
-	// the requirements
-	if (num_clients + num_servers > size) {
-		return tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > ();
-	}
-
-	std::vector<Ptr<Node> > globalmutable;
+	CampusPlacement placement (topology.GetIndex ());
+	std::vector<uint32_t> clientIds = placement.Sample (CampusPlacement::LAN_HOST, num_clients, rng.Get (ScenarioRandom::PLACEMENT));
+	std::vector<uint32_t> serverIds = placement.Sample (CampusPlacement::NET1_ROUTER, num_servers, rng.Get (ScenarioRandom::PLACEMENT));
 
-	// Copy the global list into a mutable vector
-	for (uint32_t i = 0; i < size; i++) {
-		globalmutable.push_back (global.Get(i));
-	}
-
-	uint32_t clientMin = size - num_clients - 1;
-	uint32_t serverMin = clientMin - num_servers;
+	NS_LOG_INFO ("assignClientsandServers, " << num_clients << " clients, " << num_servers << " servers");
 
 	std::vector<Ptr<Node> > ClientContainer;
 	std::vector<Ptr<Node> > ServerContainer;
 
-	// Apply Fisher-Yates shuffle - start with clients
-	for (uint32_t i = size-1; i > clientMin; i--) {
-		// Get a random number
-		int toSwap = obtain_Num (0, i);
-		// Push into the client container the number we got from the global vector
-		ClientContainer.push_back (globalmutable[toSwap]);
-		// Swap the obtained number with the last element
-		std::swap (globalmutable[toSwap], globalmutable[i]);
-	}
-
-	// Apply Fisher-Yates shuffle - servers
-	for (uint32_t i = clientMin; i > serverMin; i--) {
-		// Get a random number
-		int toSwap = obtain_Num(0, i);
-		// Push into the client container the number we got from the global vector
-		ServerContainer.push_back(globalmutable[toSwap]);
-		// Swap the obtained number with the last element
-		std::swap (globalmutable[toSwap], globalmutable[i]);
-	}
+	for (uint32_t i = 0; i < clientIds.size (); i++)
+		ClientContainer.push_back (topology.GetNode (clientIds[i]));
+	for (uint32_t i = 0; i < serverIds.size (); i++)
+		ServerContainer.push_back (topology.GetNode (serverIds[i]));
 
 	return tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > (ClientContainer,ServerContainer);
 }
 
-void Progress ()
-{
-	Simulator::Schedule (Seconds (0.1), Progress);
-}
-
-template <typename T>
-class Array2D
-{
-public:
-	Array2D (const size_t x, const size_t y) : p (new T*[x]), m_xMax (x)
-    {
-		for (size_t i = 0; i < m_xMax; i++)
-			p[i] = new T[y];
-    }
-
-	~Array2D (void)
-	{
-		for (size_t i = 0; i < m_xMax; i++)
-			delete[] p[i];
+// Reads back the clients that an earlier run on the same topology wrote to
+// file, returns no clients if they are not num_clients LAN hosts
+std::vector<Ptr<Node> > loadClients(const CampusTopologyBuilder &topology, const std::string &file, uint32_t num_clients) {
 
-		delete p;
-		p = 0;
+	CampusPlacement placement (topology.GetIndex ());
+	std::vector<uint32_t> ids;
+	std::vector<Ptr<Node> > ClientContainer;
+	if (!CampusPlacement::ReadNodeIds (file, &ids) || ids.size () != num_clients)
+		return ClientContainer;
+
+	// The builder creates every node, so node IDs are its dense indexes
+	for (uint32_t i = 0; i < ids.size (); i++) {
+		if (!placement.IsEligible (CampusPlacement::LAN_HOST, ids[i]) || topology.GetNode (ids[i])->GetId () != ids[i])
+			return std::vector<Ptr<Node> > ();
+		ClientContainer.push_back (topology.GetNode (ids[i]));
 	}
-
-    T* operator[] (const size_t i)
-    {
-    	return p[i];
-    }
-
-private:
-    T** p;
-    const size_t m_xMax;
-};
-
-template <typename T>
-class Array3D
-{
-public:
-	Array3D (const size_t x, const size_t y, const size_t z)
-		: p (new Array2D<T>*[x]), m_xMax (x)
-    {
-		for (size_t i = 0; i < m_xMax; i++)
-			p[i] = new Array2D<T> (y, z);
-    }
-
-    ~Array3D (void)
-    {
-    	for (size_t i = 0; i < m_xMax; i++)
-    	{
-    		delete p[i];
-    		p[i] = 0;
-    	}
-        delete[] p;
-        p = 0;
-    }
-
-    Array2D<T>& operator[] (const size_t i)
-    {
-    	return *(p[i]);
-    }
-
-private:
-    Array2D<T>** p;
-    const size_t m_xMax;
-};
+	return ClientContainer;
+}
 
 
 
 int main (int argc, char *argv[])
 {
-	TIMER_TYPE t0, t1, t2;
-	TIMER_NOW (t0);
+	PhaseTimer timer ("disaster-tcp-onoff-scenario1", argc, argv);
+	MemoryAccounting memory;
 	std::cout << " ==== DARPA NMS CAMPUS NETWORK SIMULATION - TCP Bulk run====" << std::endl;
 	//LogComponentEnable ("OnOffApplication", LOG_LEVEL_INFO);
 
@@ -244,6 +161,12 @@ int main (int argc, char *argv[])
 	uint32_t networks = 1; // Number of additional nodes in the network
 	char results[250] = "results";
 
+	std::string eventScheduler = "map";
+	double progress = 10;
+	std::string progressFile = "";
+	std::string timings = "results/timings.jsonl";
+	std::string placementFile = "";
+	bool cache = true;
 	CommandLine cmd;
 	cmd.AddValue ("CN", "Number of total CNs [2]", nCN);
 	cmd.AddValue ("LAN", "Number of nodes per LAN [42]", nLANClients);
@@ -254,8 +177,39 @@ int main (int argc, char *argv[])
 	cmd.AddValue ("servers", "Total number of servers in the network", servers);
 	cmd.AddValue ("networks", "Number of networks in the simulation", networks);
 	cmd.AddValue ("results", "Directory to place results", results);
+	cmd.AddValue ("scheduler", "Event scheduler: map|list|heap|calendar|ladder [map]", eventScheduler);
+	cmd.AddValue ("progress", "Wall-clock seconds between progress reports, 0 to disable [10]", progress);
+	cmd.AddValue ("progressFile", "Progress time series file [none]", progressFile);
+	cmd.AddValue ("placementFile", "Clients file (*-clients-*.txt) of an earlier run to reuse, e.g. of the other protocol, instead of drawing clients [none]", placementFile);
+	cmd.AddValue ("timings", "File the phase timings of the run are appended to, empty for none [results/timings.jsonl]", timings);
+	cmd.AddValue ("cache", "Skip the run if results/run-cache.txt has its results [true]", cache);
 	cmd.Parse (argc,argv);
 
+	// Count events for the progress reports, over the chosen scheduler
+	ObjectFactory scheduler;
+	scheduler.SetTypeId ("ns3::CountingScheduler");
+	TypeId schedulerType;
+	if (!CountingScheduler::LookupScheduler (eventScheduler, &schedulerType))
+	{
+		std::cout << "Unknown scheduler: " << eventScheduler << std::endl;
+		return 1;
+	}
+	scheduler.Set ("Scheduler", TypeIdValue (schedulerType));
+	Simulator::SetScheduler (scheduler);
+
+	// Runs with the same configuration and binary give the same results
+	RunCache runCache ("disaster-tcp-onoff-scenario1", argc, argv);
+	const char *ignored[] = { "progress", "progressFile", "timings", "scheduler", "cache" };
+	for (uint32_t i = 0; i < sizeof (ignored) / sizeof (ignored[0]); i++)
+		runCache.Ignore (ignored[i]);
+	if (!placementFile.empty ())
+		runCache.AddInput (placementFile);
+	if (cache && runCache.Lookup ())
+	{
+		runCache.PrintHit (std::cout);
+		return 0;
+	}
+
 	/*if (nCN < 2)
 	{
 		std::cout << "Number of total CNs (" << nCN << ") lower than minimum of 2"
@@ -268,300 +222,31 @@ int main (int argc, char *argv[])
 
 	std::cout << "Number of CNs: " << nCN << ", LAN nodes: " << nLANClients << std::endl;
 
-	Array2D<NodeContainer> nodes_net0(nCN, 3);
-	Array2D<NodeContainer> nodes_net1(nCN, 6);
-	NodeContainer* nodes_netLR = new NodeContainer[nCN];
-	Array2D<NodeContainer> nodes_net2(nCN, 14);
-	Array3D<NodeContainer> nodes_net2LAN(nCN, 7, nLANClients);
-	Array2D<NodeContainer> nodes_net3(nCN, 9);
-	Array3D<NodeContainer> nodes_net3LAN(nCN, 5, nLANClients);
-
-	PointToPointHelper p2p_2gb200ms, p2p_1gb5ms, p2p_100mb1ms;
-	InternetStackHelper stack;
-	Ipv4InterfaceContainer ifs;
-	Array2D<Ipv4InterfaceContainer> ifs0(nCN, 3);
-	Array2D<Ipv4InterfaceContainer> ifs1(nCN, 6);
-	Array2D<Ipv4InterfaceContainer> ifs2(nCN, 14);
-	Array2D<Ipv4InterfaceContainer> ifs3(nCN, 9);
-	Array3D<Ipv4InterfaceContainer> ifs2LAN(nCN, 7, nLANClients);
-	Array3D<Ipv4InterfaceContainer> ifs3LAN(nCN, 5, nLANClients);
-
-	Ipv4AddressHelper address;
-	std::ostringstream oss;
-	p2p_1gb5ms.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
-	p2p_1gb5ms.SetChannelAttribute ("Delay", StringValue ("5ms"));
-	p2p_2gb200ms.SetDeviceAttribute ("DataRate", StringValue ("2Gbps"));
-	p2p_2gb200ms.SetChannelAttribute ("Delay", StringValue ("200ms"));
-	p2p_100mb1ms.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
-	p2p_100mb1ms.SetChannelAttribute ("Delay", StringValue ("1ms"));
-
-	// Setup NixVector Routing
-	Ipv4NixVectorHelper nixRouting;
-	Ipv4StaticRoutingHelper staticRouting;
-
-	Ipv4ListRoutingHelper list;
-	list.Add (staticRouting, 0);
-	list.Add (nixRouting, 10);
-
-	if (nix)
-	{
-		stack.SetRoutingHelper (list); // has effect on the next Install ()
-	}
+	CampusTopologyBuilder topology;
+	topology.SetLanSize (nLANClients);
+	topology.SetNixVectorRouting (nix);
+	topology.SetCorrectedUplinks (true);
+	timer.Start ("topology");
+	topology.Build (nCN);
 
-	// Create Campus Networks
-	for (int z = 0; z < nCN; ++z)
-	{
-		std::cout << "Creating Campus Network " << z << ":" << std::endl;
-		// Create Net0
-		std::cout << "  SubNet [ 0"; //0
-		for (int i = 0; i < 3; ++i)
-		{
-			nodes_net0[z][i].Create (1);
-			stack.Install (nodes_net0[z][i]);
-		}
-		nodes_net0[z][0].Add (nodes_net0[z][1].Get (0));
-		nodes_net0[z][1].Add (nodes_net0[z][2].Get (0));
-		nodes_net0[z][2].Add (nodes_net0[z][0].Get (0));
-		NetDeviceContainer ndc0[3];
-		for (int i = 0; i < 3; ++i)
-		{
-			ndc0[i] = p2p_1gb5ms.Install (nodes_net0[z][i]);
-		}
-		// Create Net1
-		std::cout << " 1";//1
-		for (int i = 0; i < 6; ++i)
-		{
-			nodes_net1[z][i].Create (1);
-			stack.Install (nodes_net1[z][i]);
-		}
-		nodes_net1[z][0].Add (nodes_net1[z][1].Get (0));
-		nodes_net1[z][2].Add (nodes_net1[z][0].Get (0));
-		nodes_net1[z][3].Add (nodes_net1[z][0].Get (0));
-		nodes_net1[z][4].Add (nodes_net1[z][1].Get (0));
-		nodes_net1[z][5].Add (nodes_net1[z][1].Get (0));
-		NetDeviceContainer ndc1[6];
-		for (int i = 0; i < 6; ++i)
-		{
-			if (i == 1)
-			{
-				continue;
-			}
-			ndc1[i] = p2p_1gb5ms.Install (nodes_net1[z][i]);
-		}
-		// Connect Net0 <-> Net1
-		NodeContainer net0_1;
-		net0_1.Add (nodes_net0[z][1].Get (0));//bug nodes_net0[z][1] to nodes_net0[z][0]
-		net0_1.Add (nodes_net1[z][0].Get (0));// nodes_net0[z][0]
-		NetDeviceContainer ndc0_1;
-		ndc0_1 = p2p_1gb5ms.Install (net0_1);
-		oss.str ("");
-		oss << 10 + z << ".1.252.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndc0_1);
-		// Create Net2
-		std::cout << " 2";//2
-		for (int i = 0; i < 14; ++i)
-		{
-			nodes_net2[z][i].Create (1);
-			stack.Install (nodes_net2[z][i]);
-		}
-		nodes_net2[z][0].Add (nodes_net2[z][1].Get (0));
-		nodes_net2[z][2].Add (nodes_net2[z][0].Get (0));
-		nodes_net2[z][1].Add (nodes_net2[z][3].Get (0));
-		nodes_net2[z][3].Add (nodes_net2[z][2].Get (0));
-		nodes_net2[z][4].Add (nodes_net2[z][2].Get (0));
-		nodes_net2[z][5].Add (nodes_net2[z][3].Get (0));
-		nodes_net2[z][6].Add (nodes_net2[z][5].Get (0));
-		nodes_net2[z][7].Add (nodes_net2[z][2].Get (0));
-		nodes_net2[z][8].Add (nodes_net2[z][3].Get (0));
-		nodes_net2[z][9].Add (nodes_net2[z][4].Get (0));
-		nodes_net2[z][10].Add (nodes_net2[z][5].Get (0));
-		nodes_net2[z][11].Add (nodes_net2[z][6].Get (0));
-		nodes_net2[z][12].Add (nodes_net2[z][6].Get (0));
-		nodes_net2[z][13].Add (nodes_net2[z][6].Get (0));
-		NetDeviceContainer ndc2[14];
-		for (int i = 0; i < 14; ++i)
-		{
-			ndc2[i] = p2p_1gb5ms.Install (nodes_net2[z][i]);
-		}
-		///      NetDeviceContainer ndc2LAN[7][nLANClients];
-		Array2D<NetDeviceContainer> ndc2LAN(7, nLANClients);
-		for (int i = 0; i < 7; ++i)
-		{
-			oss.str ("");
-			oss << 10 + z << ".4." << 15 + i << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-			for (int j = 0; j < nLANClients; ++j)
-			{
-				nodes_net2LAN[z][i][j].Create (1);
-				stack.Install (nodes_net2LAN[z][i][j]);
-				nodes_net2LAN[z][i][j].Add (nodes_net2[z][i+7].Get (0));
-				ndc2LAN[i][j] = p2p_100mb1ms.Install (nodes_net2LAN[z][i][j]);
-				ifs2LAN[z][i][j] = address.Assign (ndc2LAN[i][j]);
-			}
-		}
-		// Create Net3
-		std::cout << " 3 ]" << std::endl;//3
-		for (int i = 0; i < 9; ++i)
-		{
-			nodes_net3[z][i].Create (1);
-			stack.Install (nodes_net3[z][i]);
-		}
-		nodes_net3[z][0].Add (nodes_net3[z][1].Get (0));
-		nodes_net3[z][1].Add (nodes_net3[z][2].Get (0));
-		nodes_net3[z][2].Add (nodes_net3[z][3].Get (0));
-		nodes_net3[z][3].Add (nodes_net3[z][1].Get (0));
-		nodes_net3[z][4].Add (nodes_net3[z][0].Get (0));
-		nodes_net3[z][5].Add (nodes_net3[z][0].Get (0));
-		nodes_net3[z][6].Add (nodes_net3[z][2].Get (0));
-		nodes_net3[z][7].Add (nodes_net3[z][3].Get (0));
-		nodes_net3[z][8].Add (nodes_net3[z][3].Get (0));
-		NetDeviceContainer ndc3[9];
-		for (int i = 0; i < 9; ++i)
-		{
-			ndc3[i] = p2p_1gb5ms.Install (nodes_net3[z][i]);
-		}
-		///      NetDeviceContainer ndc3LAN[5][nLANClients];
-		Array2D<NetDeviceContainer> ndc3LAN(5, nLANClients);
-		for (int i = 0; i < 5; ++i)
-		{
-			oss.str ("");
-			oss << 10 + z << ".5." << 10 + i << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.255");
-			for (int j = 0; j < nLANClients; ++j)
-			{
-				nodes_net3LAN[z][i][j].Create (1);
-				stack.Install (nodes_net3LAN[z][i][j]);
-				nodes_net3LAN[z][i][j].Add (nodes_net3[z][i+4].Get (0));
-				ndc3LAN[i][j] = p2p_100mb1ms.Install (nodes_net3LAN[z][i][j]);
-				ifs3LAN[z][i][j] = address.Assign (ndc3LAN[i][j]);
-			}
-		}
-		std::cout << "  Connecting Subnets..." << std::endl;
-		// Create Lone Routers (Node 4 & 5)
-		nodes_netLR[z].Create (2);
-		stack.Install (nodes_netLR[z]);
-		NetDeviceContainer ndcLR;
-		ndcLR = p2p_1gb5ms.Install (nodes_netLR[z]);
-		// Connect Net2/Net3 through Lone Routers to Net0
-		NodeContainer net0_4, net0_5, net2_4a, net2_4b, net3_5a, net3_5b;
-		net0_4.Add (nodes_netLR[z].Get (0));
-		net0_4.Add (nodes_net0[z][0].Get (0));
-		net0_5.Add (nodes_netLR[z].Get  (1));
-		net0_5.Add (nodes_net0[z][2].Get (0));//bug!! net0[z][2] not net0[z][1]
-		net2_4a.Add (nodes_netLR[z].Get (0));
-		net2_4a.Add (nodes_net2[z][0].Get (0));
-		net2_4b.Add (nodes_netLR[z].Get (0));//bug!! nodes_netLR[z].Get (0) not nodes_netLR[z].Get (1)
-		net2_4b.Add (nodes_net2[z][1].Get (0));
-		net3_5a.Add (nodes_netLR[z].Get (1));
-		net3_5a.Add (nodes_net3[z][0].Get (0));
-		net3_5b.Add (nodes_netLR[z].Get (1));
-		net3_5b.Add (nodes_net3[z][1].Get (0));
-		NetDeviceContainer ndc0_4, ndc0_5, ndc2_4a, ndc2_4b, ndc3_5a, ndc3_5b;
-		ndc0_4 = p2p_1gb5ms.Install (net0_4);
-		oss.str ("");
-		oss << 10 + z << ".1.253.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndc0_4);
-		ndc0_5 = p2p_1gb5ms.Install (net0_5);
-		oss.str ("");
-		oss << 10 + z << ".1.254.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndc0_5);
-		ndc2_4a = p2p_1gb5ms.Install (net2_4a);
-		oss.str ("");
-		oss << 10 + z << ".4.253.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndc2_4a);
-		ndc2_4b = p2p_1gb5ms.Install (net2_4b);
-		oss.str ("");
-		oss << 10 + z << ".4.254.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndc2_4b);
-		ndc3_5a = p2p_1gb5ms.Install (net3_5a);
-		oss.str ("");
-		oss << 10 + z << ".5.253.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndc3_5a);
-		ndc3_5b = p2p_1gb5ms.Install (net3_5b);
-		oss.str ("");
-		oss << 10 + z << ".5.254.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndc3_5b);
-		// Assign IP addresses
-		std::cout << "  Assigning IP addresses..." << std::endl;
-		for (int i = 0; i < 3; ++i)
-		{
-			oss.str ("");
-			oss << 10 + z << ".1." << 1 + i << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-			ifs0[z][i] = address.Assign (ndc0[i]);
-		}
-		for (int i = 0; i < 6; ++i)
-		{
-			if (i == 1)
-			{
-				continue;
-			}
-			oss.str ("");
-			oss << 10 + z << ".2." << 1 + i << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-			ifs1[z][i] = address.Assign (ndc1[i]);
-		}
-		oss.str ("");
-		oss << 10 + z << ".3.1.0";
-		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-		ifs = address.Assign (ndcLR);
-		for (int i = 0; i < 14; ++i)
-		{
-			oss.str ("");
-			oss << 10 + z << ".4." << 1 + i << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-			ifs2[z][i] = address.Assign (ndc2[i]);
-		}
-		for (int i = 0; i < 9; ++i)
-		{
-			oss.str ("");
-			oss << 10 + z << ".5." << 1 + i << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-			ifs3[z][i] = address.Assign (ndc3[i]);
-		}
-	}
-	// Create Ring Links
-	if (nCN > 1)
-	{
-		std::cout << "Forming Ring Topology..." << std::endl;
-		NodeContainer* nodes_ring = new NodeContainer[nCN];
-		for (int z = 0; z < nCN-1; ++z)
-		{
-			nodes_ring[z].Add (nodes_net0[z][0].Get (0));
-			nodes_ring[z].Add (nodes_net0[z+1][0].Get (0));
-		}
-		nodes_ring[nCN-1].Add (nodes_net0[nCN-1][0].Get (0));
-		nodes_ring[nCN-1].Add (nodes_net0[0][0].Get (0));
-		NetDeviceContainer* ndc_ring = new NetDeviceContainer[nCN];
-		for (int z = 0; z < nCN; ++z)
-		{
-			ndc_ring[z] = p2p_2gb200ms.Install (nodes_ring[z]);
-			oss.str ("");
-			oss << "254.1." << z + 1 << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-			ifs = address.Assign (ndc_ring[z]);
-		}
-		delete[] ndc_ring;
-		delete[] nodes_ring;
-	}
-
-	// Make sure to seed our random
-	gen.seed(std::time(0));
     
 	// With the network assigned, time to randomly obtain clients and servers
 	NS_LOG_INFO ("Obtaining the clients and servers");
 	// Obtain the random lists of server and clients
-	tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > t = assignClientsandServers(clients, 0);
+	tuple<std::vector<Ptr<Node> >, std::vector<Ptr<Node> > > t = assignClientsandServers (topology, clients, 0);
 
 	// Separate the tuple into clients and servers
 	std::vector<Ptr<Node> > clientVector = t.get<0> ();
+	if (!placementFile.empty ())
+	{
+		// Paired runs of both protocols share their clients
+		clientVector = loadClients (topology, placementFile, clients);
+		if (clientVector.size () != clients)
+		{
+			std::cout << "No " << clients << " LAN hosts of this topology in " << placementFile << std::endl;
+			return 1;
+		}
+	}
 	std::vector<Ptr<Node> > serverVector = t.get<1> ();
 
 	NodeContainer clientNodes;
@@ -608,7 +293,9 @@ int main (int argc, char *argv[])
 	// We don't really care which IP the clients are using, so we get one of their
 	// interfaces at random and make the send applications to that destination
 
+	memory.Mark ("topology");
 	// Port for communication
+	timer.Start ("apps");
 	uint16_t port = 1027;
 
 	NS_LOG_INFO ("Create OnOff application");
@@ -707,31 +394,18 @@ int main (int argc, char *argv[])
 
 
 	/*
-	TIMER_TYPE routingEnd;
-	TIMER_NOW (routingEnd);
-	std::cout << "Routing tables population took "
-			<< TIMER_DIFF (routingEnd, routingStart) << std::endl;
-
-	Simulator::ScheduleNow (Progress);
 	std::cout << "Running simulator..." << std::endl;
-	TIMER_NOW (t1);
 	Simulator::Stop (Seconds (100.0));
 	Simulator::Run ();
-	TIMER_NOW (t2);
 	std::cout << "Simulator finished." << std::endl;
 	Simulator::Destroy ();
 
-	double d1 = TIMER_DIFF (t1, t0), d2 = TIMER_DIFF (t2, t1);
-	std::cout << "-----" << std::endl << "Runtime Stats:" << std::endl;
-	std::cout << "Simulator init time: " << d1 << std::endl;
-	std::cout << "Simulator run time: " << d2 << std::endl;
-	std::cout << "Total elapsed time: " << d1+d2 << std::endl;
-
-	delete[] nodes_netLR;
 
 	//////////////////////////////////////////
 */
 
+	memory.Mark ("apps");
+	timer.Start ("tracers");
 	char filename[250];
 
 	// Print server nodes to file
@@ -744,6 +418,7 @@ int main (int argc, char *argv[])
 		serverFile << serverNodeIds[i] << std::endl;
 	}
 	serverFile.close();
+	runCache.AddOutput (filename);
 
 	sprintf(filename, "%s/disaster-tcp-clients-%02d-%03d-%03d-%0*d.txt", results, networks, servers, clients, 12, contentsize);
 
@@ -753,29 +428,59 @@ int main (int argc, char *argv[])
 		clientFile << clientNodeIds[i] << std::endl;
 	}
 	clientFile.close();
+	runCache.AddOutput (filename);
 
 	sprintf (filename, "%s/disaster-tcp-rate-trace-%02d-%03d-%03d-%0*d.txt", results, networks, servers, clients, 12, contentsize);
 
 	NS_LOG_INFO ("Printing IPv4 L3 Tracer");
 	// Install the ndnSIM tracers for IPv4
 	tuple< boost::shared_ptr<std::ostream>, std::list<Ptr<Ipv4RateL3Tracer> > > rateTracers = Ipv4RateL3Tracer::InstallAll (filename, Seconds (1.0));
+	runCache.AddOutput (filename);
 
 	sprintf (filename, "%s/disaster-tcp-app-delays-trace-%02d-%03d-%03d-%0*d.txt", results, networks, servers, clients, 12, contentsize);
 
 	NS_LOG_INFO ("Printing IPv4 Seq Apps Tracer");
 	tuple< boost::shared_ptr<std::ostream>, std::list<Ptr<Ipv4SeqsAppTracer> > > seqApps = Ipv4SeqsAppTracer::InstallAll(filename);
+	runCache.AddOutput (filename);
 
 	sprintf (filename, "%s/disaster-tcp-drop-trace-%02d-%03d-%03d-%0*d.txt", results, networks, servers, clients, 12, contentsize);
 	NS_LOG_INFO ("Printing L2 Drop Tracer");
 	L2RateTracer::InstallAll (filename, Seconds (0.5));
+	runCache.AddOutput (filename);
 
     sprintf (filename, "%s/tcp_server-%02d-%03d-%03d-%0*d.pcap", results, networks, servers, clients, 12, contentsize);
-    p2p_1gb5ms.EnablePcap (filename, 8, true,true);
-    //p2p_1gb5ms.EnablePcap ("results/tcp_server.pcap", 8, true,true);
+    topology.GetCampusLinkHelper ().EnablePcap (filename, 8, true,true);
+    runCache.AddOutput (PcapHelper ().GetFilenameFromDevice (filename, NodeList::GetNode (8)->GetDevice (1)));
+    //topology.GetCampusLinkHelper ().EnablePcap ("results/tcp_server.pcap", 8, true,true);
 
 	Simulator::Stop (Seconds (100.0));
+	ProgressReporter reporter;
+	reporter.SetInterval (progress);
+	reporter.SetOutput (progressFile);
+	reporter.Start (Seconds (100.0));
+	memory.Mark ("tracers");
+	timer.Start ("run");
 	Simulator::Run ();
+	CountingScheduler::Finish ();
+	reporter.Stop ();
+	memory.Mark ("run");
+	timer.Start ("teardown");
 	Simulator::Destroy ();
+	timer.Stop ();
+	memory.Mark ("teardown");
+	sprintf (filename, "%s/disaster-tcp-memory-%02d-%03d-%03d-%0*d.txt", results, networks, servers, clients, 12, contentsize);
+	memory.Write (filename);
+	memory.Print (std::cout);
+	runCache.AddOutput (filename);
+	// Flush or close the trace files before their sizes go to the manifest
+	rateTracers.get<0> ()->flush ();
+	seqApps.get<0> ()->flush ();
+	L2RateTracer::Destroy ();
+	runCache.Commit ();
+	std::cout << "Run cached as " << runCache.GetKeyString () << std::endl;
+	if (!timings.empty ())
+		timer.Write (timings);
+	timer.Print (std::cout);
 
 	return 0;
 }
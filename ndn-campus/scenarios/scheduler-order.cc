@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Checks an event scheduler against ns3::MapScheduler, then times both
+// with the hold model:
+//
+// - order: random inserts, RemoveNext () and Remove () of pending events,
+//   with many events at the same time, must dequeue the same events in the
+//   same order from both schedulers
+// - hold: with --pending events queued, each step removes the next event
+//   and inserts one at an exponential delay after it
+//
+// Exits with 1 if the orders differ.
+
+#include <sys/time.h>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include <ns3-dev/ns3/core-module.h>
+#include <ns3-dev/ns3/map-scheduler.h>
+#include <ns3-dev/ns3/scheduler.h>
+
+#include "counting-scheduler.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("SchedulerOrder");
+
+static double
+WallTime ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static Ptr<Scheduler>
+CreateScheduler (TypeId tid)
+{
+	ObjectFactory factory;
+	factory.SetTypeId (tid);
+	return factory.Create<Scheduler> ();
+}
+
+static Scheduler::Event
+MakeEvent (uint64_t ts, uint32_t uid)
+{
+	Scheduler::Event ev;
+	// Schedulers only compare keys
+	ev.impl = 0;
+	ev.key.m_ts = ts;
+	ev.key.m_uid = uid;
+	ev.key.m_context = 0;
+	return ev;
+}
+
+// Number of the operation where the two orders first differ, 0 if they match
+static uint32_t
+CompareOrder (Ptr<Scheduler> tested, uint32_t operations)
+{
+	Ptr<Scheduler> reference = CreateScheduler (MapScheduler::GetTypeId ());
+	Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+
+	std::vector<Scheduler::Event> pending;
+	std::map<uint32_t, uint32_t> index; // uid -> position in pending
+	uint64_t now = 0;
+	uint32_t uid = 0;
+	for (uint32_t op = 1; op <= operations || !pending.empty (); op++) {
+		// Then drain the schedulers
+		double what = op > operations ? 0.5 : random->GetValue ();
+		if (what < 0.5) {
+			// Ties at now, near events, far ones, and periodic ones sharing a time
+			double delay = random->GetValue ();
+			uint64_t ts = now;
+			if (delay < 0.4)
+				ts += random->GetInteger (0, 100);
+			else if (delay < 0.7)
+				ts += random->GetInteger (0, 1000000000);
+			else if (delay < 0.9)
+				ts += 1000000 - now % 1000000;
+			Scheduler::Event ev = MakeEvent (ts, uid++);
+			reference->Insert (ev);
+			tested->Insert (ev);
+			index[ev.key.m_uid] = pending.size ();
+			pending.push_back (ev);
+		}
+		else if (pending.empty ())
+			continue;
+		else {
+			Scheduler::Event ev;
+			if (what < 0.85) {
+				ev = reference->RemoveNext ();
+				Scheduler::Event next = tested->RemoveNext ();
+				if (next.key.m_ts != ev.key.m_ts || next.key.m_uid != ev.key.m_uid) {
+					std::cerr << "Operation " << op << ": expected event " << ev.key.m_uid << " at " << ev.key.m_ts
+						<< ", got " << next.key.m_uid << " at " << next.key.m_ts << std::endl;
+					return op;
+				}
+				now = ev.key.m_ts;
+			}
+			else {
+				ev = pending[random->GetInteger (0, pending.size () - 1)];
+				reference->Remove (ev);
+				tested->Remove (ev);
+			}
+			uint32_t i = index[ev.key.m_uid];
+			pending[i] = pending.back ();
+			index[pending[i].key.m_uid] = i;
+			pending.pop_back ();
+			index.erase (ev.key.m_uid);
+		}
+		if (reference->IsEmpty () != tested->IsEmpty ()) {
+			std::cerr << "Operation " << op << ": expected " << (reference->IsEmpty () ? "an empty" : "a non-empty")
+				<< " scheduler" << std::endl;
+			return op;
+		}
+	}
+	return 0;
+}
+
+// Hold steps per second with @p pending events queued
+static double
+Hold (Ptr<Scheduler> scheduler, uint32_t pending, uint32_t steps)
+{
+	// Exponential delays of mean 1 ms, in ns-3 time steps
+	Ptr<ExponentialRandomVariable> delay = CreateObject<ExponentialRandomVariable> ();
+	delay->SetAttribute ("Mean", DoubleValue (1e6));
+
+	uint32_t uid = 0;
+	for (uint32_t i = 0; i < pending; i++)
+		scheduler->Insert (MakeEvent (delay->GetInteger (), uid++));
+
+	double start = WallTime ();
+	for (uint32_t i = 0; i < steps; i++) {
+		Scheduler::Event ev = scheduler->RemoveNext ();
+		scheduler->Insert (MakeEvent (ev.key.m_ts + delay->GetInteger (), uid++));
+	}
+	double elapsed = WallTime () - start;
+
+	while (!scheduler->IsEmpty ())
+		scheduler->RemoveNext ();
+	return steps / elapsed;
+}
+
+int main (int argc, char *argv[])
+{
+	std::string scheduler = "ladder";
+	uint32_t operations = 1000000;
+	uint32_t pending = 1000000;
+	uint32_t steps = 10000000;
+
+	CommandLine cmd;
+	cmd.AddValue ("scheduler", "Scheduler to check: map, list, heap, calendar, ladder or a TypeId name", scheduler);
+	cmd.AddValue ("operations", "Random operations of the order check", operations);
+	cmd.AddValue ("pending", "Events queued in the hold model, 0 for no timing", pending);
+	cmd.AddValue ("steps", "Hold steps timed", steps);
+	cmd.Parse (argc, argv);
+
+	TypeId tid;
+	if (!CountingScheduler::LookupScheduler (scheduler, &tid)) {
+		std::cerr << "Unknown scheduler " << scheduler << std::endl;
+		return 2;
+	}
+
+	uint32_t failed = CompareOrder (CreateScheduler (tid), operations);
+	std::cout << tid.GetName () << " order: " << (failed ? "different" : "identical") << std::endl;
+
+	if (pending > 0) {
+		double rate = Hold (CreateScheduler (tid), pending, steps);
+		double mapRate = Hold (CreateScheduler (MapScheduler::GetTypeId ()), pending, steps);
+		std::cout << tid.GetName () << " hold: " << rate << " steps/s, ns3::MapScheduler "
+			<< mapRate << " steps/s, " << rate / mapRate << "x" << std::endl;
+	}
+	return failed ? 1 : 0;
+}
@@ -74,84 +74,22 @@
 #include <ns3-dev/ns3/ndnSIM/utils/tracers/ipv4-rate-l3-tracer.h>
 #include <ns3-dev/ns3/ndnSIM/utils/tracers/ipv4-seqs-app-tracer.h>
 
+#include "campus-topology-builder.h"
+#include "counting-scheduler.h"
+#include "memory-accounting.h"
+#include "phase-timer.h"
+#include "progress-reporter.h"
+#include "run-cache.h"
+
 using namespace ns3;
 using namespace std;
 
-typedef struct timeval TIMER_TYPE;
-#define TIMER_NOW(_t) gettimeofday (&_t,NULL);
-#define TIMER_SECONDS(_t) ((double)(_t).tv_sec + (_t).tv_usec*1e-6)
-#define TIMER_DIFF(_t1, _t2) (TIMER_SECONDS (_t1)-TIMER_SECONDS (_t2))
-
 NS_LOG_COMPONENT_DEFINE ("CampusNetworkModel");
 
-void Progress ()
-{
-	Simulator::Schedule (Seconds (0.1), Progress);
-}
-
-template <typename T>
-class Array2D
-{
-public:
-	Array2D (const size_t x, const size_t y) : p (new T*[x]), m_xMax (x)
-	{
-		for (size_t i = 0; i < m_xMax; i++)
-			p[i] = new T[y];
-	}
-
-	~Array2D (void)
-	{
-		for (size_t i = 0; i < m_xMax; i++)
-			delete[] p[i];
-		delete p;
-		p = 0;
-	}
-
-	T* operator[] (const size_t i)
-	{
-		return p[i];
-	}
-
-private:
-	T** p;
-	const size_t m_xMax;
-};
-
-template <typename T>
-class Array3D
-{
-public:
-	Array3D (const size_t x, const size_t y, const size_t z) : p (new Array2D<T>*[x]), m_xMax (x)
-	{
-		for (size_t i = 0; i < m_xMax; i++)
-			p[i] = new Array2D<T> (y, z);
-	}
-
-	~Array3D (void)
-	{
-		for (size_t i = 0; i < m_xMax; i++)
-		{
-			delete p[i];
-			p[i] = 0;
-		}
-		delete[] p;
-		p = 0;
-	}
-
-	Array2D<T>& operator[] (const size_t i)
-	{
-		return *(p[i]);
-	}
-
-private:
-	Array2D<T>** p;
-	const size_t m_xMax;
-};
-
 int main (int argc, char *argv[])
 {
-	TIMER_TYPE t0, t1, t2;
-	TIMER_NOW (t0);
+	PhaseTimer timer ("smart-grid-campus-ccn", argc, argv);
+	MemoryAccounting memory;
 	std::cout << " ==== DARPA NMS CAMPUS NETWORK SIMULATION ====" << std::endl;
 	LogComponentEnable ("OnOffApplication", LOG_LEVEL_INFO);
     
@@ -165,329 +103,55 @@ int main (int argc, char *argv[])
 	int nCN = 1, nLANClients = 100;
 	bool nix = true;
 
+	std::string eventScheduler = "map";
+	double progress = 10;
+	std::string progressFile = "";
+	std::string timings = "results/timings.jsonl";
+	bool cache = true;
 	CommandLine cmd;
 	cmd.AddValue ("CN", "Number of total CNs [1]", nCN);
 	cmd.AddValue ("LAN", "Number of nodes per LAN [20]", nLANClients);
 	cmd.AddValue ("NIX", "Toggle nix-vector routing", nix);
+	cmd.AddValue ("scheduler", "Event scheduler: map|list|heap|calendar|ladder [map]", eventScheduler);
+	cmd.AddValue ("progress", "Wall-clock seconds between progress reports, 0 to disable [10]", progress);
+	cmd.AddValue ("progressFile", "Progress time series file [none]", progressFile);
+	cmd.AddValue ("timings", "File the phase timings of the run are appended to, empty for none [results/timings.jsonl]", timings);
+	cmd.AddValue ("cache", "Skip the run if results/run-cache.txt has its results [true]", cache);
 	cmd.Parse (argc,argv);
 
-
-	std::cout << "Number of CNs: " << nCN << ", LAN nodes: " << nLANClients << std::endl;
-
-	Array2D<NodeContainer> nodes_net0(nCN, 3);
-	Array2D<NodeContainer> nodes_net1(nCN, 6);
-	NodeContainer* nodes_netLR = new NodeContainer[nCN];
-	Array2D<NodeContainer> nodes_net2(nCN, 14);
-	Array3D<NodeContainer> nodes_net2LAN(nCN, 7, nLANClients);
-	Array2D<NodeContainer> nodes_net3(nCN, 9);
-	Array3D<NodeContainer> nodes_net3LAN(nCN, 5, nLANClients);
-
-	PointToPointHelper p2p_1gb5ms, p2p_2gb200ms, p2p_100mb1ms;
-    //;
-	InternetStackHelper stack;
-	
-	Ipv4InterfaceContainer ifs;
-	Array2D<Ipv4InterfaceContainer> ifs0(nCN, 3);
-	Array2D<Ipv4InterfaceContainer> ifs1(nCN, 6);
-	Array2D<Ipv4InterfaceContainer> ifs2(nCN, 14);
-	Array2D<Ipv4InterfaceContainer> ifs3(nCN, 9);
-	Array3D<Ipv4InterfaceContainer> ifs2LAN(nCN, 7, nLANClients);
-	Array3D<Ipv4InterfaceContainer> ifs3LAN(nCN, 5, nLANClients);
-
-	Ipv4AddressHelper address;
-	std::ostringstream oss;
-	p2p_1gb5ms.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
-	p2p_1gb5ms.SetChannelAttribute ("Delay", StringValue ("5ms"));
-	p2p_2gb200ms.SetDeviceAttribute ("DataRate", StringValue ("2Gbps"));
-	p2p_2gb200ms.SetChannelAttribute ("Delay", StringValue ("200ms"));
-	p2p_100mb1ms.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
-	p2p_100mb1ms.SetChannelAttribute ("Delay", StringValue ("1ms"));
-
-	// Setup NixVector Routing
-	Ipv4NixVectorHelper nixRouting;
-	Ipv4StaticRoutingHelper staticRouting;
-
-	Ipv4ListRoutingHelper list;
-	list.Add (staticRouting, 0);
-	list.Add (nixRouting, 10);
-
-	if (nix)
+	// Count events for the progress reports, over the chosen scheduler
+	ObjectFactory scheduler;
+	scheduler.SetTypeId ("ns3::CountingScheduler");
+	TypeId schedulerType;
+	if (!CountingScheduler::LookupScheduler (eventScheduler, &schedulerType))
 	{
-		stack.SetRoutingHelper (list); // has effect on the next Install ()
+		std::cout << "Unknown scheduler: " << eventScheduler << std::endl;
+		return 1;
 	}
-
-	// Create Campus Networks
-	for (int z = 0; z < nCN; ++z)
+	scheduler.Set ("Scheduler", TypeIdValue (schedulerType));
+	Simulator::SetScheduler (scheduler);
+
+	// Runs with the same configuration and binary give the same results
+	RunCache runCache ("smart-grid-campus-ccn", argc, argv);
+	const char *ignored[] = { "progress", "progressFile", "timings", "scheduler", "cache" };
+	for (uint32_t i = 0; i < sizeof (ignored) / sizeof (ignored[0]); i++)
+		runCache.Ignore (ignored[i]);
+	if (cache && runCache.Lookup ())
 	{
-        std::cout << "Creating Campus Network " << z << ":" << std::endl;
-        		// Create SubNet0
-        		std::cout << "  SubNet [ 0"; //0
-        		for (int i = 0; i < 3; ++i)
-        		{
-        			nodes_net0[z][i].Create (1);
-        			stack.Install (nodes_net0[z][i]);
-        		}
-
-        		nodes_net0[z][0].Add (nodes_net0[z][1].Get (0));
-        		nodes_net0[z][1].Add (nodes_net0[z][2].Get (0));
-        		nodes_net0[z][2].Add (nodes_net0[z][0].Get (0));
-        		NetDeviceContainer ndc0[3];
-
-        		for (int i = 0; i < 3; ++i)
-        		{
-        			ndc0[i] = p2p_1gb5ms.Install (nodes_net0[z][i]);
-        		}
-
-        		// Create SubNet1
-        		std::cout << " 1";//1
-        		for (int i = 0; i < 6; ++i)
-        		{
-        			nodes_net1[z][i].Create (1);
-        			stack.Install(nodes_net1[z][i]);
-        		}
-
-        		nodes_net1[z][0].Add (nodes_net1[z][1].Get (0));
-        		nodes_net1[z][2].Add (nodes_net1[z][0].Get (0));
-        		nodes_net1[z][3].Add (nodes_net1[z][0].Get (0));
-        		nodes_net1[z][4].Add (nodes_net1[z][1].Get (0));
-        		nodes_net1[z][5].Add (nodes_net1[z][1].Get (0));
-        		NetDeviceContainer ndc1[6];
-
-        		for (int i = 0; i < 6; ++i)
-        		{
-        			if (i == 1)
-        			{
-        				continue;
-        			}
-
-        			ndc1[i] = p2p_1gb5ms.Install (nodes_net1[z][i]);
-        		}
-
-        		// Connect SubNet0 <-> SubNet1
-        		NodeContainer net0_1;
-        		net0_1.Add (nodes_net0[z][2].Get (0));
-        		net0_1.Add (nodes_net1[z][0].Get (0));
-        		NetDeviceContainer ndc0_1;
-        		ndc0_1 = p2p_1gb5ms.Install(net0_1);
-        		oss.str ("");
-        		oss << 10 + z << ".1.252.0";
-        		address.SetBase(oss.str ().c_str (), "255.255.255.0");
-        		ifs = address.Assign(ndc0_1);
-
-        		// Create SubNet2
-        		std::cout << " 2";//2
-        		for (int i = 0; i < 14; ++i)
-        		{
-        			nodes_net2[z][i].Create (1);
-        			stack.Install(nodes_net2[z][i]);
-        		}
-
-        		nodes_net2[z][0].Add (nodes_net2[z][1].Get (0));
-        		nodes_net2[z][2].Add (nodes_net2[z][0].Get (0));
-        		nodes_net2[z][1].Add (nodes_net2[z][3].Get (0));
-        		nodes_net2[z][3].Add (nodes_net2[z][2].Get (0));
-        		nodes_net2[z][4].Add (nodes_net2[z][2].Get (0));
-        		nodes_net2[z][5].Add (nodes_net2[z][3].Get (0));
-        		nodes_net2[z][6].Add (nodes_net2[z][5].Get (0));
-        		nodes_net2[z][7].Add (nodes_net2[z][2].Get (0));
-        		nodes_net2[z][8].Add (nodes_net2[z][3].Get (0));
-        		nodes_net2[z][9].Add (nodes_net2[z][4].Get (0));
-        		nodes_net2[z][10].Add (nodes_net2[z][5].Get (0));
-        		nodes_net2[z][11].Add (nodes_net2[z][6].Get (0));
-        		nodes_net2[z][12].Add (nodes_net2[z][6].Get (0));
-        		nodes_net2[z][13].Add (nodes_net2[z][6].Get (0));
-        		NetDeviceContainer ndc2[14];
-
-                for (int i = 0; i < 14; ++i)
-        		{
-        			ndc2[i] = p2p_1gb5ms.Install (nodes_net2[z][i]);
-        		}
-        		
-                ///      NetDeviceContainer ndc2LAN[7][nLANClients];
-        		Array2D<NetDeviceContainer> ndc2LAN(7, nLANClients);
-        		for (int i = 0; i < 7; ++i)
-        		{
-        			oss.str ("");
-        			oss << 10 + z << ".4." << 15 + i << ".0";
-        			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-        			for (int j = 0; j < nLANClients; ++j)
-        			{
-        				nodes_net2LAN[z][i][j].Create (1);
-        				stack.Install (nodes_net2LAN[z][i][j]);
-        				nodes_net2LAN[z][i][j].Add (nodes_net2[z][i+7].Get (0));
-        				ndc2LAN[i][j] = p2p_100mb1ms.Install (nodes_net2LAN[z][i][j]);
-        				ifs2LAN[z][i][j] = address.Assign (ndc2LAN[i][j]);
-        			}
-        		}
-
-        		// Create SubNet3
-        		std::cout << " 3 ]" << std::endl;//3
-        		for (int i = 0; i < 9; ++i)
-        		{
-        			nodes_net3[z][i].Create (1);
-        			stack.Install (nodes_net3[z][i]);
-        		}
-
-        		nodes_net3[z][0].Add (nodes_net3[z][1].Get (0));
-        		nodes_net3[z][1].Add (nodes_net3[z][2].Get (0));
-        		nodes_net3[z][2].Add (nodes_net3[z][3].Get (0));
-        		nodes_net3[z][3].Add (nodes_net3[z][1].Get (0));
-        		nodes_net3[z][4].Add (nodes_net3[z][0].Get (0));
-        		nodes_net3[z][5].Add (nodes_net3[z][0].Get (0));
-        		nodes_net3[z][6].Add (nodes_net3[z][2].Get (0));
-        		nodes_net3[z][7].Add (nodes_net3[z][3].Get (0));
-        		nodes_net3[z][8].Add (nodes_net3[z][3].Get (0));
-        		NetDeviceContainer ndc3[9];
-        		for (int i = 0; i < 9; ++i)
-        		{
-        			ndc3[i] = p2p_1gb5ms.Install (nodes_net3[z][i]);
-        		}
-        		
-                ///      NetDeviceContainer ndc3LAN[5][nLANClients];
-        		Array2D<NetDeviceContainer> ndc3LAN(5, nLANClients);
-        		for (int i = 0; i < 5; ++i)
-        		{
-        			oss.str ("");
-        			oss << 10 + z << ".5." << 10 + i << ".0";
-        			address.SetBase (oss.str ().c_str (), "255.255.255.255");
-        			for (int j = 0; j < nLANClients; ++j)
-        			{
-        				nodes_net3LAN[z][i][j].Create (1);
-        				stack.Install (nodes_net3LAN[z][i][j]);
-        				nodes_net3LAN[z][i][j].Add (nodes_net3[z][i+4].Get (0));
-        				ndc3LAN[i][j] = p2p_100mb1ms.Install (nodes_net3LAN[z][i][j]);
-        				ifs3LAN[z][i][j] = address.Assign (ndc3LAN[i][j]);
-        			}
-        		}
-
-        		std::cout << "  Connecting Subnets..." << std::endl;
-
-        		// Create Lone Routers (Node 4 & 5)
-        		nodes_netLR[z].Create (2);
-        		stack.Install (nodes_netLR[z]);
-        		NetDeviceContainer ndcLR;
-        		ndcLR = p2p_1gb5ms.Install (nodes_netLR[z]);
+		runCache.PrintHit (std::cout);
+		return 0;
+	}
 
-        		// Connect Net2/Net3 through Lone Routers to Net0
-        		NodeContainer net0_4, net0_5, net2_4a, net2_4b, net3_5a, net3_5b;
-        		net0_4.Add (nodes_netLR[z].Get (0));
-        		net0_4.Add (nodes_net0[z][0].Get (0));
-        		net0_5.Add (nodes_netLR[z].Get  (1));
-        		net0_5.Add (nodes_net0[z][1].Get (0));
-        		net2_4a.Add (nodes_netLR[z].Get (0));
-        		net2_4a.Add (nodes_net2[z][0].Get (0));
-        		net2_4b.Add (nodes_netLR[z].Get (1));
-        		net2_4b.Add (nodes_net2[z][1].Get (0));
-        		net3_5a.Add (nodes_netLR[z].Get (1));
-        		net3_5a.Add (nodes_net3[z][0].Get (0));
-        		net3_5b.Add (nodes_netLR[z].Get (1));
-        		net3_5b.Add (nodes_net3[z][1].Get (0));
 
-                NetDeviceContainer ndc0_4, ndc0_5, ndc2_4a, ndc2_4b, ndc3_5a, ndc3_5b;
-        		ndc0_4 = p2p_1gb5ms.Install (net0_4);
-        		oss.str ("");
-        		oss << 10 + z << ".1.253.0";
-        		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-        		ifs = address.Assign (ndc0_4);
-        		ndc0_5 = p2p_1gb5ms.Install (net0_5);
-        		oss.str ("");
-        		oss << 10 + z << ".1.254.0";
-        		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-        		ifs = address.Assign (ndc0_5);
-        		ndc2_4a = p2p_1gb5ms.Install (net2_4a);
-        		oss.str ("");
-        		oss << 10 + z << ".4.253.0";
-        		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-        		ifs = address.Assign (ndc2_4a);
-        		ndc2_4b = p2p_1gb5ms.Install (net2_4b);
-        		oss.str ("");
-        		oss << 10 + z << ".4.254.0";
-        		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-        		ifs = address.Assign (ndc2_4b);
-        		ndc3_5a = p2p_1gb5ms.Install (net3_5a);
-        		oss.str ("");
-        		oss << 10 + z << ".5.253.0";
-        		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-        		ifs = address.Assign (ndc3_5a);
-        		ndc3_5b = p2p_1gb5ms.Install (net3_5b);
-        		oss.str ("");
-        		oss << 10 + z << ".5.254.0";
-        		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-        		ifs = address.Assign (ndc3_5b);
-        		
-                // Assign IP addresses
-        		std::cout << "  Assigning IP addresses..." << std::endl;
+	std::cout << "Number of CNs: " << nCN << ", LAN nodes: " << nLANClients << std::endl;
 
-                for (int i = 0; i < 3; ++i)
-        		{
-        			oss.str ("");
-        			oss << 10 + z << ".1." << 1 + i << ".0";
-        			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-        			ifs0[z][i] = address.Assign (ndc0[i]);
-        		}
-                std::cout << "  Net0 IP Addresses Assigned" << std::endl;
-                
-        		for (int i = 0; i < 6; ++i)
-        		{
-        			if (i == 1)
-        			{
-        				continue;
-        			}
-        			oss.str ("");
-        			oss << 10 + z << ".2." << 1 + i << ".0";
-        			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-        			ifs1[z][i] = address.Assign (ndc1[i]);
-        		}
-        		std::cout << "  Net1 IP Addresses Assigned" << std::endl;
-        		
-        		oss.str ("");
-        		oss << 10 + z << ".3.1.0";
-        		address.SetBase (oss.str ().c_str (), "255.255.255.0");
-        		ifs = address.Assign (ndcLR);
-        		std::cout << "  LoneRouters IP Addresses Assigned" << std::endl;
-        		for (int i = 0; i < 14; ++i)
-        		{
-        			oss.str ("");
-        			oss << 10 + z << ".4." << 1 + i << ".0";
-        			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-        			ifs2[z][i] = address.Assign (ndc2[i]);
-        		}
-        		std::cout << "  Net2 IP Addresses Assigned" << std::endl;
-        		
-        		for (int i = 0; i < 9; ++i)
-        		{
-        			oss.str ("");
-        			oss << 10 + z << ".5." << 1 + i << ".0";
-        			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-        			ifs3[z][i] = address.Assign (ndc3[i]);
-        		}
-        		std::cout << "  Net3 IP Addresses Assigned" << std::endl;
-	}    		
-	// Create Ring Links
-	
-	if (nCN > 1)
-	{
-		std::cout << "Forming Ring Topology..." << std::endl;
-		NodeContainer* nodes_ring = new NodeContainer[nCN];
-		for (int z = 0; z < nCN-1; ++z)
-		{
-			nodes_ring[z].Add (nodes_net0[z][0].Get (0));
-			nodes_ring[z].Add (nodes_net0[z+1][0].Get (0));
-		}
-		nodes_ring[nCN-1].Add (nodes_net0[nCN-1][0].Get (0));
-		nodes_ring[nCN-1].Add (nodes_net0[0][0].Get (0));
-		NetDeviceContainer* ndc_ring = new NetDeviceContainer[nCN];
-		for (int z = 0; z < nCN; ++z)
-		{
-			ndc_ring[z] = p2p_2gb200ms.Install (nodes_ring[z]);
-			oss.str ("");
-			oss << "254.1." << z + 1 << ".0";
-			address.SetBase (oss.str ().c_str (), "255.255.255.0");
-			ifs = address.Assign (ndc_ring[z]);
-		}
-		delete[] ndc_ring;
-		delete[] nodes_ring;
-	}
+	CampusTopologyBuilder topology;
+	topology.SetLanSize (nLANClients);
+	topology.SetNixVectorRouting (nix);
+	// NDN traffic only, IPv4 is left to the TCP scenarios
+	topology.SetInternetStack (false);
+	timer.Start ("topology");
+	topology.Build (nCN);
 	
 	NodeContainer global = NodeContainer::GetGlobal ();
 	//OperationDomainNodes
@@ -497,13 +161,13 @@ int main (int argc, char *argv[])
     NodeContainer cdNodes;
     std::vector<uint32_t> cdNodeIds;
     
-	odNodes.Add(nodes_net0[0][0].Get (0));
+	odNodes.Add(topology.GetCampus (0).Net0 (0));
 	//odNodeIds.push_back(server_nodeNum);
 	std::cout << "  Getinng odNodes" << std::endl; 
 	/*
 	for (uint32_t i=7; i<14; i++){
 	     for (uint32_t j=0; j<nLANClients;j++){
-	          Ptr<Node> tmp = nodes_net2LAN[0][i][j].Get(0);
+	          Ptr<Node> tmp = topology.GetCampus (0).Net2Lan (i, j);
 	          uint32_t nodeNum = tmp ->GetId();
 	          cdNodes.Add(tmp);
 	          cdNodeIds.push_back(nodeNum);
@@ -513,7 +177,7 @@ int main (int argc, char *argv[])
 	std::cout << "  Getinng net2LAN  Nodes into clientNodes" << std::endl;
 	for (uint32_t i=4; i<9; i++){
 	     for (uint32_t j=0; j<nLANClients;j++){
-	          Ptr<Node> tmp = nodes_net3LAN[0][i][j].Get(0);
+	          Ptr<Node> tmp = topology.GetCampus (0).Net3Lan (i, j);
 	          uint32_t nodeNum = tmp ->GetId();
 	          cdNodes.Add(tmp);
 	          cdNodeIds.push_back(nodeNum);
@@ -527,7 +191,7 @@ int main (int argc, char *argv[])
     /*
       for(uint32_t i = 7;i < 14;i++){
     	for (uint32_t j = 0;j < nLANClients; ++j){
-    		 uint32_t nodeNum =nodes_net2LAN[0][i][j].Get(0)->GetId();
+    		 uint32_t nodeNum =topology.GetCampus (0).Net2Lan (i, j)->GetId();
     		 std::cout << "  Getinng net2LAN & net3LAN Nodes into clientNodes" << std::endl;
     		 cdNodes.Add(global.Get(nodeNum));
     		 cdNodeIds.push_back(nodeNum);
@@ -537,7 +201,7 @@ int main (int argc, char *argv[])
     
     for(uint32_t i = 4;i < 9;i++){
     	for (uint32_t j = 0;j < nLANClients; ++j){
-    		 uint32_t nodeNum =nodes_net3LAN[0][i][j].Get(0)->GetId();
+    		 uint32_t nodeNum =topology.GetCampus (0).Net3Lan (i, j)->GetId();
     		 cdNodeIds.push_back(nodeNum);
     	}	
     }
@@ -553,10 +217,12 @@ int main (int argc, char *argv[])
 			cdNodeIds.push_back(nodeNum);
 	}
 	*/
-	//Ptr<Node> server_tmp = nodes_net0[0][0].Get (0);
+	//Ptr<Node> server_tmp = topology.GetCampus (0).Net0 (0);
 	        //uint32_t server_nodeNum = server_tmp->GetId();
 		
+		memory.Mark ("topology");
 	// Consumer1
+		timer.Start ("apps");
 		ndn::AppHelper consumerHelper1 ("ns3::ndn::ConsumerCbr");
 		// Consumer will request /prefix/0, /prefix/1, ...
 		consumerHelper1.SetPrefix ("/OD/CD");
@@ -565,12 +231,12 @@ int main (int argc, char *argv[])
 		//consumerHelper.Install (nodes.Get (12)); // first node
 		for(int i =0; i<7; i++){
 			for (int j=0; j <nLANClients; j++){
-				consumerHelper1.Install (nodes_net2LAN[0][i][j]);
+				consumerHelper1.Install (topology.GetCampus (0).Net2Lan (i, j));
 			}
 		}
 		for(int i =0; i<5; i++){
 					for (int j=0; j <nLANClients; j++){
-						consumerHelper1.Install (nodes_net3LAN[0][i][j]);
+						consumerHelper1.Install (topology.GetCampus (0).Net3Lan (i, j));
 					}
 				}
 		std::cout << "Install consumerHelper1" << std::endl;   
@@ -600,32 +266,36 @@ int main (int argc, char *argv[])
 		producerHelper2.SetAttribute ("PayloadSize", StringValue("1024"));
 		for(int i =0; i<7; i++){
 			for (int j=0; j <nLANClients; j++){
-						producerHelper2.Install (nodes_net2LAN[0][i][j]);
+						producerHelper2.Install (topology.GetCampus (0).Net2Lan (i, j));
 			}
 		}
 		for(int i =0; i<5; i++){
 			for (int j=0; j <nLANClients; j++){
-					producerHelper2.Install (nodes_net3LAN[0][i][j]);
+					producerHelper2.Install (topology.GetCampus (0).Net3Lan (i, j));
 			}
 		}
 		std::cout << "Install producerHelper2" << std::endl; 
 		
+	memory.Mark ("apps");
+	timer.Start ("ndn-stack");
 	ndn::StackHelper ndnHelper;
 	ndnHelper.SetContentStore("ns3::ndn::cs::Freshness::Lru","MaxSize","3072");// 30% of whole contents
 	ndnHelper.SetForwardingStrategy ("ns3::ndn::fw::BestRoute");
 	ndnHelper.InstallAll ();
+	memory.Mark ("ndn-stack");
+	timer.Start ("routing");
 	ndn::GlobalRoutingHelper ndnGlobalRoutingHelper;
 	ndnGlobalRoutingHelper.InstallAll ();
-	ndnGlobalRoutingHelper.AddOrigins ("/OD/CD", nodes_net0[0][0].Get (0));
+	ndnGlobalRoutingHelper.AddOrigins ("/OD/CD", topology.GetCampus (0).Net0 (0));
 	ndn::GlobalRoutingHelper::CalculateRoutes ();
 	for(int i =0; i<7; i++){
 		for (int j=0; j <nLANClients; j++){
-			ndnGlobalRoutingHelper.AddOrigins ("/CD/OD", nodes_net2LAN[0][i][j]);
+			ndnGlobalRoutingHelper.AddOrigins ("/CD/OD", topology.GetCampus (0).Net2Lan (i, j));
 		}
 	}
 	for(int i =0; i<5; i++){
 		for (int j=0; j <nLANClients; j++){
-			ndnGlobalRoutingHelper.AddOrigins ("/CD/OD", nodes_net3LAN[0][i][j]);
+			ndnGlobalRoutingHelper.AddOrigins ("/CD/OD", topology.GetCampus (0).Net3Lan (i, j));
 		}
 	}
 	std::cout << "  Global Routing " << std::endl;
@@ -635,27 +305,56 @@ int main (int argc, char *argv[])
 
 	// Obtain metrics
 	
+	memory.Mark ("routing");
+	timer.Start ("tracers");
 	char filename[250];
 	
 	sprintf (filename, "%s/smart-grid-ccn-rate-trace-1-1-%03d-102400.txt", results, clients);
 	ndn::L3RateTracer::InstallAll (filename, Seconds (1.0));
+	runCache.AddOutput (filename);
 	/*
 	 * sprintf (filename, "%s/smart-grid-ccn-cd-rate-trace-1-1-%03d-102400.txt", results, clients);
 	for(int i =0; i<7; i++){
 			for (int j=0; j <nLANClients; j++){
-				ndn::L3RateTracer::Install(nodes_net2LAN[0][i][j],filename, Seconds (0.5));
+				ndn::L3RateTracer::Install(topology.GetCampus (0).Net2Lan (i, j),filename, Seconds (0.5));
 			}
 		}
 		for(int i =0; i<5; i++){
 			for (int j=0; j <nLANClients; j++){
-				ndn::L3RateTracer::Install(nodes_net3LAN[0][i][j],filename, Seconds (0.5));
+				ndn::L3RateTracer::Install(topology.GetCampus (0).Net3Lan (i, j),filename, Seconds (0.5));
 			}
 		}
 	
 	 */
 	Simulator::Stop (Seconds (20.0));
 
+	ProgressReporter reporter;
+	reporter.SetInterval (progress);
+	reporter.SetOutput (progressFile);
+	reporter.Start (Seconds (20.0));
+	memory.Mark ("tracers");
+	timer.Start ("run");
 	Simulator::Run ();
+	CountingScheduler::Finish ();
+	reporter.Stop ();
+	memory.Mark ("run");
+	// The tables are gone once the simulator is destroyed
+	memory.EstimateTables (NodeContainer::GetGlobal ());
+	timer.Start ("teardown");
 	Simulator::Destroy ();
+	timer.Stop ();
+	memory.Mark ("teardown");
+	sprintf (filename, "%s/smart-grid-ccn-memory-1-1-%03d-102400.txt", results, clients);
+	memory.Write (filename);
+	memory.Print (std::cout);
+	runCache.AddOutput (filename);
+	// The tracers close their files only when destroyed, before the sizes
+	// of the files go to the manifest
+	ndn::L3RateTracer::Destroy ();
+	runCache.Commit ();
+	std::cout << "Run cached as " << runCache.GetKeyString () << std::endl;
+	if (!timings.empty ())
+		timer.Write (timings);
+	timer.Print (std::cout);
 	return 0;
 }
@@ -72,84 +72,23 @@
 #include <ns3-dev/ns3/ndnSIM/utils/tracers/ipv4-rate-l3-tracer.h>
 #include <ns3-dev/ns3/ndnSIM/utils/tracers/ipv4-seqs-app-tracer.h>
 
+#include "campus-topology-builder.h"
+#include "counting-scheduler.h"
+#include "memory-accounting.h"
+#include "phase-timer.h"
+#include "progress-reporter.h"
+#include "run-cache.h"
+
 using namespace ns3;
 using namespace boost;
 
-typedef struct timeval TIMER_TYPE;
-#define TIMER_NOW(_t) gettimeofday (&_t,NULL);
-#define TIMER_SECONDS(_t) ((double)(_t).tv_sec + (_t).tv_usec*1e-6)
-#define TIMER_DIFF(_t1, _t2) (TIMER_SECONDS (_t1)-TIMER_SECONDS (_t2))
-
 NS_LOG_COMPONENT_DEFINE ("CampusNetworkModel");
 
-void Progress ()
-{
-  Simulator::Schedule (Seconds (0.1), Progress);
-}
-
-template <typename T>
-class Array2D
-{
-  public:
-    Array2D (const size_t x, const size_t y) : p (new T*[x]), m_xMax (x) 
-      {
-        for (size_t i = 0; i < m_xMax; i++)
-          p[i] = new T[y];
-      }
-
-    ~Array2D (void)
-      {
-        for (size_t i = 0; i < m_xMax; i++)
-          delete[] p[i];
-        delete p;
-        p = 0;
-      }
-
-    T* operator[] (const size_t i)
-      {
-         return p[i];
-      }
-  private:
-    T** p;
-    const size_t m_xMax;
-};
-
-template <typename T>
-class Array3D
-{
-  public:
-    Array3D (const size_t x, const size_t y, const size_t z)
-      : p (new Array2D<T>*[x]), m_xMax (x)
-      {
-        for (size_t i = 0; i < m_xMax; i++)
-          p[i] = new Array2D<T> (y, z);
-      }
-
-    ~Array3D (void)
-      {
-        for (size_t i = 0; i < m_xMax; i++)
-          {
-            delete p[i];
-            p[i] = 0;
-          }
-        delete[] p;
-        p = 0;
-      }
-
-    Array2D<T>& operator[] (const size_t i)
-      {
-        return *(p[i]);
-      }
-  private:
-    Array2D<T>** p;
-    const size_t m_xMax;
-};
-
 int
 main (int argc, char *argv[])
 {
-  TIMER_TYPE t0, t1, t2;
-  TIMER_NOW (t0);
+  PhaseTimer timer ("smart-grid-campus-tcp", argc, argv);
+  MemoryAccounting memory;
   std::cout << " ==== DARPA NMS CAMPUS NETWORK SIMULATION ====" << std::endl;
   LogComponentEnable ("OnOffApplication", LOG_LEVEL_INFO);
 
@@ -162,299 +101,56 @@ main (int argc, char *argv[])
   int nCN = 1, nLANClients = 20;
   bool nix = true;
 
+  std::string eventScheduler = "map";
+  double progress = 10;
+  std::string progressFile = "";
+  std::string timings = "results/timings.jsonl";
+  bool cache = true;
   CommandLine cmd;
   cmd.AddValue ("CN", "Number of total CNs [2]", nCN);
   cmd.AddValue ("LAN", "Number of nodes per LAN [42]", nLANClients);
   cmd.AddValue ("NIX", "Toggle nix-vector routing", nix);
+  cmd.AddValue ("scheduler", "Event scheduler: map|list|heap|calendar|ladder [map]", eventScheduler);
+  cmd.AddValue ("progress", "Wall-clock seconds between progress reports, 0 to disable [10]", progress);
+  cmd.AddValue ("progressFile", "Progress time series file [none]", progressFile);
+  cmd.AddValue ("timings", "File the phase timings of the run are appended to, empty for none [results/timings.jsonl]", timings);
+  cmd.AddValue ("cache", "Skip the run if results/run-cache.txt has its results [true]", cache);
   cmd.Parse (argc,argv);
 
-  std::cout << "Number of CNs: " << nCN << ", LAN nodes: " << nLANClients << std::endl;
-
-  Array2D<NodeContainer> nodes_net0(nCN, 3);
-  Array2D<NodeContainer> nodes_net1(nCN, 6);
-  NodeContainer* nodes_netLR = new NodeContainer[nCN];
-  Array2D<NodeContainer> nodes_net2(nCN, 14);
-  Array3D<NodeContainer> nodes_net2LAN(nCN, 7, nLANClients);
-  Array2D<NodeContainer> nodes_net3(nCN, 9);
-  Array3D<NodeContainer> nodes_net3LAN(nCN, 5, nLANClients);
-
-  PointToPointHelper p2p_2gb200ms, p2p_1gb5ms, p2p_100mb1ms;
-  InternetStackHelper stack;
-  Ipv4InterfaceContainer ifs;
-  Array2D<Ipv4InterfaceContainer> ifs0(nCN, 3);
-  Array2D<Ipv4InterfaceContainer> ifs1(nCN, 6);
-  Array2D<Ipv4InterfaceContainer> ifs2(nCN, 14);
-  Array2D<Ipv4InterfaceContainer> ifs3(nCN, 9);
-  Array3D<Ipv4InterfaceContainer> ifs2LAN(nCN, 7, nLANClients);
-  Array3D<Ipv4InterfaceContainer> ifs3LAN(nCN, 5, nLANClients);
-
-  Ipv4AddressHelper address;
-  std::ostringstream oss;
-  p2p_1gb5ms.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
-  p2p_1gb5ms.SetChannelAttribute ("Delay", StringValue ("5ms"));
-  p2p_2gb200ms.SetDeviceAttribute ("DataRate", StringValue ("2Gbps"));
-  p2p_2gb200ms.SetChannelAttribute ("Delay", StringValue ("200ms"));
-  p2p_100mb1ms.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
-  p2p_100mb1ms.SetChannelAttribute ("Delay", StringValue ("1ms"));
-
-  // Setup NixVector Routing
-  Ipv4NixVectorHelper nixRouting;
-  Ipv4StaticRoutingHelper staticRouting;
-
-  Ipv4ListRoutingHelper list;
-  list.Add (staticRouting, 0);
-  list.Add (nixRouting, 10);
-
-  if (nix)
+  // Count events for the progress reports, over the chosen scheduler
+  ObjectFactory scheduler;
+  scheduler.SetTypeId ("ns3::CountingScheduler");
+  TypeId schedulerType;
+  if (!CountingScheduler::LookupScheduler (eventScheduler, &schedulerType))
     {
-      stack.SetRoutingHelper (list); // has effect on the next Install ()
+      std::cout << "Unknown scheduler: " << eventScheduler << std::endl;
+      return 1;
     }
-
-  // Create Campus Networks
-  for (int z = 0; z < nCN; ++z) 
+  scheduler.Set ("Scheduler", TypeIdValue (schedulerType));
+  Simulator::SetScheduler (scheduler);
+
+  // Runs with the same configuration and binary give the same results
+  RunCache runCache ("smart-grid-campus-tcp", argc, argv);
+  const char *ignored[] = { "progress", "progressFile", "timings", "scheduler", "cache" };
+  for (uint32_t i = 0; i < sizeof (ignored) / sizeof (ignored[0]); i++)
+    runCache.Ignore (ignored[i]);
+  if (cache && runCache.Lookup ())
     {
-      std::cout << "Creating Campus Network " << z << ":" << std::endl;
-      // Create Net0
-      std::cout << "  SubNet [ 0";
-      for (int i = 0; i < 3; ++i) 
-        {
-          nodes_net0[z][i].Create (1);
-          stack.Install (nodes_net0[z][i]);
-        }
-      nodes_net0[z][0].Add (nodes_net0[z][1].Get (0));
-      nodes_net0[z][1].Add (nodes_net0[z][2].Get (0));
-      nodes_net0[z][2].Add (nodes_net0[z][0].Get (0));
-      NetDeviceContainer ndc0[3];
-      for (int i = 0; i < 3; ++i) 
-        {
-          ndc0[i] = p2p_1gb5ms.Install (nodes_net0[z][i]);
-        }
-      // Create Net1
-      std::cout << " 1";
-      for (int i = 0; i < 6; ++i) 
-        {
-          nodes_net1[z][i].Create (1);
-          stack.Install (nodes_net1[z][i]);
-        }
-      nodes_net1[z][0].Add (nodes_net1[z][1].Get (0));
-      nodes_net1[z][2].Add (nodes_net1[z][0].Get (0));
-      nodes_net1[z][3].Add (nodes_net1[z][0].Get (0));
-      nodes_net1[z][4].Add (nodes_net1[z][1].Get (0));
-      nodes_net1[z][5].Add (nodes_net1[z][1].Get (0));
-      NetDeviceContainer ndc1[6];
-      for (int i = 0; i < 6; ++i) 
-        {
-          if (i == 1)
-            {
-              continue;
-            }
-          ndc1[i] = p2p_1gb5ms.Install (nodes_net1[z][i]);
-        }
-      // Connect Net0 <-> Net1
-      NodeContainer net0_1;
-      net0_1.Add (nodes_net0[z][2].Get (0));
-      net0_1.Add (nodes_net1[z][0].Get (0));
-      NetDeviceContainer ndc0_1;
-      ndc0_1 = p2p_1gb5ms.Install (net0_1);
-      oss.str ("");
-      oss << 10 + z << ".1.252.0";
-      address.SetBase (oss.str ().c_str (), "255.255.255.0");
-      ifs = address.Assign (ndc0_1);
-      // Create Net2
-      std::cout << " 2";
-      for (int i = 0; i < 14; ++i) 
-        {
-          nodes_net2[z][i].Create (1);
-          stack.Install (nodes_net2[z][i]);
-        }
-      nodes_net2[z][0].Add (nodes_net2[z][1].Get (0));
-      nodes_net2[z][2].Add (nodes_net2[z][0].Get (0));
-      nodes_net2[z][1].Add (nodes_net2[z][3].Get (0));
-      nodes_net2[z][3].Add (nodes_net2[z][2].Get (0));
-      nodes_net2[z][4].Add (nodes_net2[z][2].Get (0));
-      nodes_net2[z][5].Add (nodes_net2[z][3].Get (0));
-      nodes_net2[z][6].Add (nodes_net2[z][5].Get (0));
-      nodes_net2[z][7].Add (nodes_net2[z][2].Get (0));
-      nodes_net2[z][8].Add (nodes_net2[z][3].Get (0));
-      nodes_net2[z][9].Add (nodes_net2[z][4].Get (0));
-      nodes_net2[z][10].Add (nodes_net2[z][5].Get (0));
-      nodes_net2[z][11].Add (nodes_net2[z][6].Get (0));
-      nodes_net2[z][12].Add (nodes_net2[z][6].Get (0));
-      nodes_net2[z][13].Add (nodes_net2[z][6].Get (0));
-      NetDeviceContainer ndc2[14];
-      for (int i = 0; i < 14; ++i) 
-        {
-          ndc2[i] = p2p_1gb5ms.Install (nodes_net2[z][i]);
-        }
-///      NetDeviceContainer ndc2LAN[7][nLANClients];
-      Array2D<NetDeviceContainer> ndc2LAN(7, nLANClients);
-      for (int i = 0; i < 7; ++i) 
-        {
-          oss.str ("");
-          oss << 10 + z << ".4." << 15 + i << ".0";
-          address.SetBase (oss.str ().c_str (), "255.255.255.0");
-          for (int j = 0; j < nLANClients; ++j) 
-            {
-              nodes_net2LAN[z][i][j].Create (1);
-              stack.Install (nodes_net2LAN[z][i][j]);
-              nodes_net2LAN[z][i][j].Add (nodes_net2[z][i+7].Get (0));
-              ndc2LAN[i][j] = p2p_100mb1ms.Install (nodes_net2LAN[z][i][j]);
-              ifs2LAN[z][i][j] = address.Assign (ndc2LAN[i][j]);
-            }
-        }
-      // Create Net3
-      std::cout << " 3 ]" << std::endl;
-      for (int i = 0; i < 9; ++i) 
-        {
-          nodes_net3[z][i].Create (1);
-          stack.Install (nodes_net3[z][i]);
-        }
-      nodes_net3[z][0].Add (nodes_net3[z][1].Get (0));
-      nodes_net3[z][1].Add (nodes_net3[z][2].Get (0));
-      nodes_net3[z][2].Add (nodes_net3[z][3].Get (0));
-      nodes_net3[z][3].Add (nodes_net3[z][1].Get (0));
-      nodes_net3[z][4].Add (nodes_net3[z][0].Get (0));
-      nodes_net3[z][5].Add (nodes_net3[z][0].Get (0));
-      nodes_net3[z][6].Add (nodes_net3[z][2].Get (0));
-      nodes_net3[z][7].Add (nodes_net3[z][3].Get (0));
-      nodes_net3[z][8].Add (nodes_net3[z][3].Get (0));
-      NetDeviceContainer ndc3[9];
-      for (int i = 0; i < 9; ++i) 
-        {
-          ndc3[i] = p2p_1gb5ms.Install (nodes_net3[z][i]);
-        }
-///      NetDeviceContainer ndc3LAN[5][nLANClients];
-      Array2D<NetDeviceContainer> ndc3LAN(5, nLANClients);
-      for (int i = 0; i < 5; ++i) 
-        {
-          oss.str ("");
-          oss << 10 + z << ".5." << 10 + i << ".0";
-          address.SetBase (oss.str ().c_str (), "255.255.255.255");
-          for (int j = 0; j < nLANClients; ++j) 
-            {
-              nodes_net3LAN[z][i][j].Create (1);
-              stack.Install (nodes_net3LAN[z][i][j]);
-              nodes_net3LAN[z][i][j].Add (nodes_net3[z][i+4].Get (0));
-              ndc3LAN[i][j] = p2p_100mb1ms.Install (nodes_net3LAN[z][i][j]);
-              ifs3LAN[z][i][j] = address.Assign (ndc3LAN[i][j]);
-            }
-        }
-      std::cout << "  Connecting Subnets..." << std::endl;
-      // Create Lone Routers (Node 4 & 5) 
-      nodes_netLR[z].Create (2);
-      stack.Install (nodes_netLR[z]);
-      NetDeviceContainer ndcLR;
-      ndcLR = p2p_1gb5ms.Install (nodes_netLR[z]);
-      // Connect Net2/Net3 through Lone Routers to Net0
-      NodeContainer net0_4, net0_5, net2_4a, net2_4b, net3_5a, net3_5b;
-      net0_4.Add (nodes_netLR[z].Get (0));
-      net0_4.Add (nodes_net0[z][0].Get (0));
-      net0_5.Add (nodes_netLR[z].Get  (1));
-      net0_5.Add (nodes_net0[z][1].Get (0));
-      net2_4a.Add (nodes_netLR[z].Get (0));
-      net2_4a.Add (nodes_net2[z][0].Get (0));
-      net2_4b.Add (nodes_netLR[z].Get (1));
-      net2_4b.Add (nodes_net2[z][1].Get (0));
-      net3_5a.Add (nodes_netLR[z].Get (1));
-      net3_5a.Add (nodes_net3[z][0].Get (0));
-      net3_5b.Add (nodes_netLR[z].Get (1));
-      net3_5b.Add (nodes_net3[z][1].Get (0));
-      NetDeviceContainer ndc0_4, ndc0_5, ndc2_4a, ndc2_4b, ndc3_5a, ndc3_5b;
-      ndc0_4 = p2p_1gb5ms.Install (net0_4);
-      oss.str ("");
-      oss << 10 + z << ".1.253.0";
-      address.SetBase (oss.str ().c_str (), "255.255.255.0");
-      ifs = address.Assign (ndc0_4);
-      ndc0_5 = p2p_1gb5ms.Install (net0_5);
-      oss.str ("");
-      oss << 10 + z << ".1.254.0";
-      address.SetBase (oss.str ().c_str (), "255.255.255.0");
-      ifs = address.Assign (ndc0_5);
-      ndc2_4a = p2p_1gb5ms.Install (net2_4a);
-      oss.str ("");
-      oss << 10 + z << ".4.253.0";
-      address.SetBase (oss.str ().c_str (), "255.255.255.0");
-      ifs = address.Assign (ndc2_4a);
-      ndc2_4b = p2p_1gb5ms.Install (net2_4b);
-      oss.str ("");
-      oss << 10 + z << ".4.254.0";
-      address.SetBase (oss.str ().c_str (), "255.255.255.0");
-      ifs = address.Assign (ndc2_4b);
-      ndc3_5a = p2p_1gb5ms.Install (net3_5a);
-      oss.str ("");
-      oss << 10 + z << ".5.253.0";
-      address.SetBase (oss.str ().c_str (), "255.255.255.0");
-      ifs = address.Assign (ndc3_5a);
-      ndc3_5b = p2p_1gb5ms.Install (net3_5b);
-      oss.str ("");
-      oss << 10 + z << ".5.254.0";
-      address.SetBase (oss.str ().c_str (), "255.255.255.0");
-      ifs = address.Assign (ndc3_5b);
-      // Assign IP addresses
-      std::cout << "  Assigning IP addresses..." << std::endl;
-      for (int i = 0; i < 3; ++i) 
-        {
-          oss.str ("");
-          oss << 10 + z << ".1." << 1 + i << ".0";
-          address.SetBase (oss.str ().c_str (), "255.255.255.0");
-          ifs0[z][i] = address.Assign (ndc0[i]);
-        }
-      for (int i = 0; i < 6; ++i) 
-        {
-          if (i == 1) 
-            {
-              continue;
-            }
-          oss.str ("");
-          oss << 10 + z << ".2." << 1 + i << ".0";
-          address.SetBase (oss.str ().c_str (), "255.255.255.0");
-          ifs1[z][i] = address.Assign (ndc1[i]);
-        }
-      oss.str ("");
-      oss << 10 + z << ".3.1.0";
-      address.SetBase (oss.str ().c_str (), "255.255.255.0");
-      ifs = address.Assign (ndcLR);
-      for (int i = 0; i < 14; ++i) 
-        {
-          oss.str ("");
-          oss << 10 + z << ".4." << 1 + i << ".0";
-          address.SetBase (oss.str ().c_str (), "255.255.255.0");
-          ifs2[z][i] = address.Assign (ndc2[i]);
-        }
-      for (int i = 0; i < 9; ++i) 
-        {
-          oss.str ("");
-          oss << 10 + z << ".5." << 1 + i << ".0";
-          address.SetBase (oss.str ().c_str (), "255.255.255.0");
-          ifs3[z][i] = address.Assign (ndc3[i]);
-        }
-    }
-  // Create Ring Links
-  if (nCN > 1) 
-    {
-      std::cout << "Forming Ring Topology..." << std::endl;
-      NodeContainer* nodes_ring = new NodeContainer[nCN];
-      for (int z = 0; z < nCN-1; ++z) 
-        {
-          nodes_ring[z].Add (nodes_net0[z][0].Get (0));
-          nodes_ring[z].Add (nodes_net0[z+1][0].Get (0));
-        }
-      nodes_ring[nCN-1].Add (nodes_net0[nCN-1][0].Get (0));
-      nodes_ring[nCN-1].Add (nodes_net0[0][0].Get (0));
-      NetDeviceContainer* ndc_ring = new NetDeviceContainer[nCN];
-      for (int z = 0; z < nCN; ++z) 
-        {
-          ndc_ring[z] = p2p_2gb200ms.Install (nodes_ring[z]);
-          oss.str ("");
-          oss << "254.1." << z + 1 << ".0";
-          address.SetBase (oss.str ().c_str (), "255.255.255.0");
-          ifs = address.Assign (ndc_ring[z]);
-        }
-      delete[] ndc_ring;
-      delete[] nodes_ring;
+      runCache.PrintHit (std::cout);
+      return 0;
     }
 
+  std::cout << "Number of CNs: " << nCN << ", LAN nodes: " << nLANClients << std::endl;
+
+  CampusTopologyBuilder topology;
+  topology.SetLanSize (nLANClients);
+  topology.SetNixVectorRouting (nix);
+  timer.Start ("topology");
+  topology.Build (nCN);
+
+  memory.Mark ("topology");
   // Create Traffic Flows
+  timer.Start ("apps");
   std::cout << "Creating TCP Traffic Flows:" << std::endl;
   Config::SetDefault ("ns3::OnOffApplication::MaxBytes", UintegerValue (102400));
   Config::SetDefault ("ns3::OnOffApplication::OnTime",
@@ -476,15 +172,15 @@ main (int argc, char *argv[])
               PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory",
                                            InetSocketAddress (Ipv4Address::GetAny (), 9999));
               ApplicationContainer sinkApp = sinkHelper.Install (
-                  nodes_net2LAN[0][i][j].Get (0));
+                  topology.GetCampus (0).Net2Lan (i, j));
               sinkApp.Start (Seconds (0.0));
               // Sources on CustomerDomainNodes(net2LAN)
               OnOffHelper cd1 ("ns3::TcpSocketFactory", Address ());
               AddressValue remoteAddress2 (InetSocketAddress (
-                                            ifs0[0][0].GetAddress (0), 1111));
+                                            topology.GetCampus (0).Net0Interfaces (0).GetAddress (0), 1111));
               cd1.SetAttribute ("Remote", remoteAddress2);
               ApplicationContainer cd1App;
-              cd1App.Add (cd1.Install (nodes_net2LAN[0][i][j].Get (0)));
+              cd1App.Add (cd1.Install (topology.GetCampus (0).Net2Lan (i, j)));
               cd1App.Start (Seconds (0.0));
             }
         }
@@ -498,15 +194,15 @@ main (int argc, char *argv[])
               PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory",
                                            InetSocketAddress (Ipv4Address::GetAny (), 9999));
               ApplicationContainer sinkApp = sinkHelper.Install (
-                  nodes_net3LAN[0][i][j].Get (0));
+                  topology.GetCampus (0).Net3Lan (i, j));
               sinkApp.Start (Seconds (0.0));
               // Sources on CustomerDomainNodes(net3LAN)
               OnOffHelper cd2 ("ns3::TcpSocketFactory", Address ());
               AddressValue remoteAddress2 (InetSocketAddress (
-                                            ifs0[0][0].GetAddress (0), 2222));
+                                            topology.GetCampus (0).Net0Interfaces (0).GetAddress (0), 2222));
               cd2.SetAttribute ("Remote", remoteAddress2);
               ApplicationContainer cd2App;
-              cd2App.Add (cd2.Install (nodes_net3LAN[0][i][j].Get (0)));
+              cd2App.Add (cd2.Install (topology.GetCampus (0).Net3Lan (i, j)));
               cd2App.Start (Seconds (0.0));
             }
         }
@@ -521,10 +217,10 @@ main (int argc, char *argv[])
          {
            OnOffHelper od1 ("ns3::TcpSocketFactory", Address ());
            AddressValue remoteAddress (InetSocketAddress (
-                                         ifs2LAN[0][i][j].GetAddress (0), 9999));
+                                         topology.GetCampus (0).Net2LanInterfaces (i, j).GetAddress (0), 9999));
            od1.SetAttribute ("Remote", remoteAddress);
            ApplicationContainer od1App;
-           od1App.Add (od1.Install (nodes_net0[0][0].Get (0)));
+           od1App.Add (od1.Install (topology.GetCampus (0).Net0 (0)));
            od1App.Start (Seconds (0.0));
          }
      }
@@ -534,10 +230,10 @@ main (int argc, char *argv[])
          {
            OnOffHelper od2 ("ns3::TcpSocketFactory", Address ());
            AddressValue remoteAddress (InetSocketAddress (
-                                         ifs3LAN[0][i][j].GetAddress (0), 9999));
+                                         topology.GetCampus (0).Net3LanInterfaces (i, j).GetAddress (0), 9999));
            od2.SetAttribute ("Remote", remoteAddress);
            ApplicationContainer od2App;
-           od2App.Add (od2.Install (nodes_net0[0][0].Get (0)));
+           od2App.Add (od2.Install (topology.GetCampus (0).Net0 (0)));
            od2App.Start (Seconds (0.0));
          }
      }
@@ -547,32 +243,60 @@ main (int argc, char *argv[])
   // Sink on OperationDomainNode
   PacketSinkHelper sinkHelper1 ("ns3::TcpSocketFactory",
 		  	  	  	  	  	  	InetSocketAddress (Ipv4Address::GetAny (),1111));
-  ApplicationContainer sinkApp1 = sinkHelper1.Install (nodes_net0[0][0].Get(0));
+  ApplicationContainer sinkApp1 = sinkHelper1.Install (topology.GetCampus (0).Net0 (0));
   sinkApp1.Start(Seconds (0.0));
 
   PacketSinkHelper sinkHelper2 ("ns3::TcpSocketFactory",
 		  	  	  	  	  	  	InetSocketAddress (Ipv4Address::GetAny (),2222));
-  ApplicationContainer sinkApp2 = sinkHelper2.Install (nodes_net0[0][0].Get(0));
+  ApplicationContainer sinkApp2 = sinkHelper2.Install (topology.GetCampus (0).Net0 (0));
   sinkApp2.Start(Seconds (0.0));
 
   std::cout << "OD Sinks FINISHED" << std::endl;
   
   // Obtain metrics
   
+  memory.Mark ("apps");
+  timer.Start ("tracers");
   char filename[250];
   
   sprintf (filename, "%s/smart-grid-tcp-rate-trace-1-1-%03d-102400.txt", results, clients);
   NS_LOG_INFO ("Printing IPv4 L3 Tracer");
   // Install the ndnSIM tracers for IPv4
   tuple< boost::shared_ptr<std::ostream>, std::list<Ptr<Ipv4RateL3Tracer> > > rateTracers = Ipv4RateL3Tracer::InstallAll (filename, Seconds (1.0));
+  runCache.AddOutput (filename);
 
   sprintf (filename, "%s/smart-grid-tcp-drop-trace-1-1-%03d-102400.txt", results, clients);
   NS_LOG_INFO ("Printing L2 Drop Tracer");
   L2RateTracer::InstallAll (filename, Seconds (0.5));
+  runCache.AddOutput (filename);
   
   Simulator::Stop (Seconds (20.0));
+  ProgressReporter reporter;
+  reporter.SetInterval (progress);
+  reporter.SetOutput (progressFile);
+  reporter.Start (Seconds (20.0));
+  memory.Mark ("tracers");
+  timer.Start ("run");
   Simulator::Run ();
+  CountingScheduler::Finish ();
+  reporter.Stop ();
+  memory.Mark ("run");
+  timer.Start ("teardown");
   Simulator::Destroy ();
+  timer.Stop ();
+  memory.Mark ("teardown");
+  sprintf (filename, "%s/smart-grid-tcp-memory-1-1-%03d-102400.txt", results, clients);
+  memory.Write (filename);
+  memory.Print (std::cout);
+  runCache.AddOutput (filename);
+  // Flush or close the trace files before their sizes go to the manifest
+  rateTracers.get<0> ()->flush ();
+  L2RateTracer::Destroy ();
+  runCache.Commit ();
+  std::cout << "Run cached as " << runCache.GetKeyString () << std::endl;
+  if (!timings.empty ())
+    timer.Write (timings);
+  timer.Print (std::cout);
 	
   return 0;
 }
@@ -0,0 +1,213 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * CCN over a topology read from a file
+ *
+ * Reads an ndnSIM annotated topology or an edge list (see
+ * extensions/topology-file-reader.h) instead of building the NMS campus
+ * ring, so new topologies can be tried without recompiling.  One producer
+ * serves the content prefix, a set of consumers requests it.
+ */
+
+// for timing functions
+#include <cstdlib>
+#include <sys/time.h>
+#include <fstream>
+
+#include <ns3-dev/ns3/core-module.h>
+#include <ns3-dev/ns3/network-module.h>
+#include <ns3-dev/ns3/point-to-point-module.h>
+#include <ns3-dev/ns3/ndnSIM-module.h>
+
+#include "counting-scheduler.h"
+#include "memory-accounting.h"
+#include "memory-usage.h"
+#include "phase-timer.h"
+#include "topology-file-reader.h"
+#include "progress-reporter.h"
+#include "run-cache.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TopologyFileCcn");
+
+int main (int argc, char *argv[])
+{
+	PhaseTimer timer ("topology-file-ccn", argc, argv);
+	MemoryAccounting memory;
+	std::cout << " ==== CCN OVER A TOPOLOGY FILE ====" << std::endl;
+
+	std::string topologyFile = "";
+	std::string format = "auto";
+	std::string producer = "";
+	std::string consumer = "";
+	uint32_t consumers = 1;
+	double stopTime = 20.0;
+
+	std::string eventScheduler = "map";
+	double progress = 10;
+	std::string progressFile = "";
+	std::string timings = "results/timings.jsonl";
+	bool cache = true;
+	CommandLine cmd;
+	cmd.AddValue ("topology", "Topology file to read", topologyFile);
+	cmd.AddValue ("format", "Topology file format: auto|annotated|edges [auto]", format);
+	cmd.AddValue ("producer", "Name of the producer node [first node of the file]", producer);
+	cmd.AddValue ("consumer", "Name of the first consumer node [last node of the file]", consumer);
+	cmd.AddValue ("consumers", "Number of consumers, taken backwards from the first one [1]", consumers);
+	cmd.AddValue ("stopTime", "Simulated seconds [20]", stopTime);
+	cmd.AddValue ("scheduler", "Event scheduler: map|list|heap|calendar|ladder [map]", eventScheduler);
+	cmd.AddValue ("progress", "Wall-clock seconds between progress reports, 0 to disable [10]", progress);
+	cmd.AddValue ("progressFile", "Progress time series file [none]", progressFile);
+	cmd.AddValue ("timings", "File the phase timings of the run are appended to, empty for none [results/timings.jsonl]", timings);
+	cmd.AddValue ("cache", "Skip the run if results/run-cache.txt has its results [true]", cache);
+	cmd.Parse (argc,argv);
+
+	TopologyFileReader reader;
+	if (format == "annotated")
+		reader.SetFormat (TopologyFileReader::FORMAT_ANNOTATED);
+	else if (format == "edges")
+		reader.SetFormat (TopologyFileReader::FORMAT_EDGE_LIST);
+	else if (format != "auto")
+	{
+		std::cout << "Unknown topology format " << format << std::endl;
+		return 1;
+	}
+
+	// Count events for the runtime stats
+	ObjectFactory scheduler;
+	scheduler.SetTypeId ("ns3::CountingScheduler");
+	TypeId schedulerType;
+	if (!CountingScheduler::LookupScheduler (eventScheduler, &schedulerType))
+	{
+		std::cout << "Unknown scheduler: " << eventScheduler << std::endl;
+		return 1;
+	}
+	scheduler.Set ("Scheduler", TypeIdValue (schedulerType));
+	Simulator::SetScheduler (scheduler);
+
+	// Runs with the same configuration and binary give the same results
+	RunCache runCache ("topology-file-ccn", argc, argv);
+	const char *ignored[] = { "progress", "progressFile", "timings", "scheduler", "cache" };
+	for (uint32_t i = 0; i < sizeof (ignored) / sizeof (ignored[0]); i++)
+		runCache.Ignore (ignored[i]);
+	if (!topologyFile.empty ())
+		runCache.AddInput (topologyFile);
+	if (cache && runCache.Lookup ())
+	{
+		runCache.PrintHit (std::cout);
+		return 0;
+	}
+
+	timer.Start ("topology");
+	if (topologyFile.empty () || !reader.Read (topologyFile))
+	{
+		std::cout << "Cannot read topology file \"" << topologyFile << "\"" << std::endl;
+		return 1;
+	}
+
+	const NodeContainer &nodes = reader.GetNodes ();
+	uint32_t producerIndex = producer.empty () ? 0 : reader.FindNode (producer);
+	uint32_t consumerIndex = consumer.empty () ? nodes.GetN () - 1 : reader.FindNode (consumer);
+	if (producerIndex >= nodes.GetN () || consumerIndex >= nodes.GetN () || consumers > consumerIndex + 1)
+	{
+		std::cout << "Producer or consumers are not in the topology" << std::endl;
+		return 1;
+	}
+
+	memory.Mark ("topology");
+	timer.Start ("ndn-stack");
+	ndn::StackHelper ndnHelper;
+	ndnHelper.SetForwardingStrategy ("ns3::ndn::fw::BestRoute");
+	ndnHelper.Install (nodes);
+	// Faces take the metric column of annotated files, as with AnnotatedTopologyReader
+	reader.ApplyMetrics ();
+
+	memory.Mark ("ndn-stack");
+	timer.Start ("routing");
+	ndn::GlobalRoutingHelper ndnGlobalRoutingHelper;
+	ndnGlobalRoutingHelper.Install (nodes);
+	ndnGlobalRoutingHelper.AddOrigins ("/Dinfo/topology/server", nodes.Get (producerIndex));
+
+	ndn::GlobalRoutingHelper::CalculateRoutes ();
+	timer.Stop ();
+	memory.Mark ("routing");
+	std::cout << "Routes calculation took " << timer.GetWall ("routing") << " s" << std::endl;
+
+	// Consumer
+	timer.Start ("apps");
+	ndn::AppHelper consumerHelper ("ns3::ndn::ConsumerCbr");
+	consumerHelper.SetPrefix ("/Dinfo/topology/server");
+	consumerHelper.SetAttribute ("Frequency", StringValue ("100"));
+	for (uint32_t i = 0; i < consumers; i++)
+		consumerHelper.Install (nodes.Get (consumerIndex - i));
+
+	// Producer
+	ndn::AppHelper producerHelper ("ns3::ndn::Producer");
+	producerHelper.SetPrefix ("/Dinfo/topology/server");
+	producerHelper.SetAttribute ("PayloadSize", StringValue("1024"));
+	producerHelper.Install (nodes.Get (producerIndex));
+
+	memory.Mark ("apps");
+	// Obtain metrics
+	timer.Start ("tracers");
+	ndn::L3RateTracer::InstallAll ("results/topology-file-ccn-rate-trace.txt", Seconds (1.0));
+	ndn::AppDelayTracer::InstallAll ("results/topology-file-ccn-app-delays-trace.txt");
+	runCache.AddOutput ("results/topology-file-ccn-rate-trace.txt");
+	runCache.AddOutput ("results/topology-file-ccn-app-delays-trace.txt");
+
+	double d1 = timer.GetElapsed ();
+	memory.Mark ("tracers");
+	timer.Start ("run");
+	Simulator::Stop (Seconds (stopTime));
+	ProgressReporter reporter;
+	reporter.SetInterval (progress);
+	reporter.SetOutput (progressFile);
+	reporter.Start (Seconds (stopTime));
+	Simulator::Run ();
+	CountingScheduler::Finish ();
+	reporter.Stop ();
+	memory.Mark ("run");
+	// The tables are gone once the simulator is destroyed
+	memory.EstimateTables (NodeContainer::GetGlobal ());
+	timer.Start ("teardown");
+	Simulator::Destroy ();
+	timer.Stop ();
+	memory.Mark ("teardown");
+	memory.Write ("results/topology-file-ccn-memory.txt");
+	memory.Print (std::cout);
+	runCache.AddOutput ("results/topology-file-ccn-memory.txt");
+	// The tracers close their files only when destroyed, before the sizes
+	// of the files go to the manifest
+	ndn::L3RateTracer::Destroy ();
+	ndn::AppDelayTracer::Destroy ();
+	runCache.Commit ();
+	std::cout << "Run cached as " << runCache.GetKeyString () << std::endl;
+	if (!timings.empty ())
+		timer.Write (timings);
+	timer.Print (std::cout);
+
+	double d2 = timer.GetWall ("run");
+	uint64_t events = CountingScheduler::GetNExecuted ();
+	std::cout << "-----" << std::endl << "Runtime Stats:" << std::endl;
+	std::cout << "Topology parse time: " << reader.GetParseTime () << std::endl;
+	std::cout << "Topology build time: " << reader.GetBuildTime () << std::endl;
+	std::cout << "Simulator init time: " << d1 << std::endl;
+	std::cout << "Simulator run time: " << d2 << std::endl;
+	std::cout << "Events: " << events << std::endl;
+	std::cout << "Events per second: " << (d2 > 0 ? events / d2 : 0) << std::endl;
+	std::cout << "Peak RSS (MB): " << MemoryUsage::GetPeakRss () / 1048576.0 << std::endl;
+	return 0;
+}